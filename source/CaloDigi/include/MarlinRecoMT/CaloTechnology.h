@@ -0,0 +1,148 @@
+#ifndef MARLINRECOMT_CALOTECHNOLOGY_H
+#define MARLINRECOMT_CALOTECHNOLOGY_H 1
+
+// -- lcio headers
+#include <Exceptions.h>
+
+// -- std headers
+#include <cmath>
+#include <random>
+
+namespace marlinreco_mt {
+
+  /**
+   *  @brief  CaloEnergyScale enumerator
+   */
+  enum class CaloEnergyScale : unsigned int {
+    MIP,        /// Energy deposit in MIP
+    GEVDEP,     /// Energy deposit in Gev
+    NPE         /// Number of photo-electrons
+  };
+
+  using CaloRandomGenerator = std::mt19937 ;
+
+  /** Calorimeter technology policies used by RealisticCaloDigi and RealisticCaloReco.
+   *  A digitisation policy provides:
+   *  - convertEnergy( energy, inUnit ): conversion to the technology unit
+   *  - digitiseDetectorEnergy( generator, energy ): from deposited GeV to the technology unit
+   *  A reconstruction policy provides:
+   *  - reconstructEnergy( energy ): from the technology unit to the MIP scale
+   *  The policies are plain structures filled from the processor parameters in init().
+   *  The processing loops are instantiated per policy so that these calls are inlined.
+   */
+  struct SiliconDigiTechnology {
+    /// energy required to create e-h pair in silicon (in eV)
+    float        _ehEnergy {3.6f} ;
+    /// average G4 deposited energy by MIP
+    float        _calibMip {1.e-4f} ;
+
+    /// Convert the energy to MIP scale. Throws on unsupported unit
+    float convertEnergy( float energy, CaloEnergyScale inUnit ) const {
+      if( inUnit == CaloEnergyScale::MIP ) {
+        return energy ;
+      }
+      else if ( inUnit == CaloEnergyScale::GEVDEP ) {
+        return energy / _calibMip ;
+      }
+      throw EVENT::Exception( "SiliconDigiTechnology::convertEnergy: Unknown conversion unit!" ) ;
+    }
+
+    /// Digitise the deposited energy (GeV), output in MIP scale
+    float digitiseDetectorEnergy( CaloRandomGenerator &gen, float energy ) const {
+      float smeared_energy(energy) ;
+      if ( _ehEnergy > 0 ) {
+        // calculate #e-h pairs
+        float nehpairs = 1e9*energy / _ehEnergy; // check units of energy! _ehEnergy is in eV, energy in GeV
+        // fluctuate it by Poisson (actually an overestimate: Fano factor actually makes it smaller, however even this overstimated effect is tiny for our purposes)
+        std::poisson_distribution<int> poiss( nehpairs ) ;
+        smeared_energy *= poiss( gen ) ;
+      }
+      // convert to MIP units
+      return smeared_energy / _calibMip ;
+    }
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  struct ScinPpdDigiTechnology {
+    /// # Photo-electrons per MIP
+    float        _pePerMip {10.f} ;
+    /// total number of MPPC/SiPM pixels
+    int          _nPixels {10000} ;
+    /// variation of PPD pixel signal (as a fraction)
+    float        _pixSpread {0.05f} ;
+    /// average G4 deposited energy by MIP
+    float        _calibMip {1.e-4f} ;
+
+    /// Convert the energy to number of photo-electrons
+    float convertEnergy( float energy, CaloEnergyScale inUnit ) const {
+      if ( inUnit == CaloEnergyScale::NPE ) {
+        return energy ;
+      }
+      else if ( inUnit == CaloEnergyScale::MIP ) {
+        return _pePerMip * energy ;
+      }
+      else {
+        return _pePerMip * energy / _calibMip ;
+      }
+    }
+
+    /// Digitise the deposited energy (GeV), output in number of photo-electrons
+    float digitiseDetectorEnergy( CaloRandomGenerator &gen, float energy ) const {
+      float npe = energy*_pePerMip / _calibMip; // convert to pe scale
+      if ( _nPixels > 0 ) {
+        // apply average sipm saturation behaviour
+        npe = _nPixels*(1.0 - std::exp( -npe/_nPixels ) ) ;
+        //apply binomial smearing
+        float p = npe / _nPixels ; // fraction of hit pixels on SiPM
+        std::binomial_distribution<int> binom( _nPixels, p ) ;
+        npe = binom( gen ) ; //npe now quantised to integer pixels
+        if ( _pixSpread > 0) {
+          // variations in pixel capacitance
+          std::normal_distribution<float> norm( 1., _pixSpread / std::sqrt(npe) ) ;
+          npe *= norm( gen ) ;
+        }
+      }
+      return npe ;
+    }
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  struct SiliconRecoTechnology {
+    /// The input energy is already in MIPs
+    float reconstructEnergy( float energy ) const {
+      return energy ;
+    }
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  struct ScinPpdRecoTechnology {
+    /// # Photo-electrons per MIP
+    float        _pePerMip {10.f} ;
+    /// total number of MPPC/SiPM pixels
+    int          _nPixels {10000} ;
+
+    /// From number of photo-electrons to MIPs, de-saturating the PPD response
+    float reconstructEnergy( float energy ) const {
+      // this is the fraction of SiPM pixels fired above which a linear continuation of the saturation-reconstruction function is used.
+      // 0.95 of nPixel corresponds to a energy correction of factor ~3.
+      const float r = 0.95 ;
+      if (energy < r*_nPixels) { //current hit below linearisation threshold, reconstruct energy normally:
+        energy = -_nPixels * std::log ( 1. - ( energy / _nPixels ) ) ;
+      }
+      else { //current hit is aove linearisation threshold, reconstruct using linear continuation function:
+        energy = 1 / ( 1 - r ) * ( energy - r*_nPixels ) - _nPixels * std::log( 1 - r ) ;
+      }
+      // then go back to MIP scale
+      return energy / _pePerMip ;
+    }
+  };
+
+}
+
+#endif
@@ -10,11 +10,14 @@
 #include <EVENT/LCEvent.h>
 #include <EVENT/LCIO.h>
 
+// -- marlinrecomt headers
+#include <MarlinRecoMT/CaloTechnology.h>
+
 // -- std headers
 #include <string>
 #include <vector>
 #include <random>
-#include <map> // for pair
+#include <array>
 
 namespace marlinreco_mt {
 
@@ -22,15 +25,23 @@ namespace marlinreco_mt {
       Digitisation of calorimeter hits
       e.g. timing, dead cells, miscalibrations
       this is virtual class, technology-blind
-      technology-specific classes can inherit from this one.
+      technology-specific classes can inherit from this one and call
+      digitise() with their technology policy (see CaloTechnology.h).
+      The hit loop is instantiated per technology and per combination of
+      enabled random effects, so that disabled effects cost nothing.
+      Several input collections can be digitised into a single output collection
+      (e.g even/odd sim hit collections) using inputHitCollectionGroups. They must have
+      the same cellID encoding.
       D. Jeans 02/2016, rewrite of parts of ILDCaloDigi, DDCaloDigi
       R. Ete 05/2019, rewrite for MT use
    */
   class RealisticCaloDigi : public marlin::Processor {
   public:
-    using RandomGenerator = std::mt19937 ;
+    using RandomGenerator = CaloRandomGenerator ;
+    using EnergyScale = CaloEnergyScale ;
     static constexpr const char *RELATIONFROMTYPESTR = "FromType" ;
     static constexpr const char *RELATIONTOTYPESTR = "ToType" ;
+    static constexpr unsigned int MAXTIMESLICES = 4 ;
     
   public:
     virtual ~RealisticCaloDigi() = default ;
@@ -48,26 +59,21 @@ namespace marlinreco_mt {
      *  @brief  Initialize base parameters
      */
     virtual void init() ;
-    
-    /**
-     *  @brief  Process an event
-     * 
-     *  @param  evt the event to process
-     */
-    void processEvent( EVENT::LCEvent *evt ) ; 
 
    protected:
     /**
-     *  @brief  EnergyScale enumerator
+     *  @brief  Optional per-hit effects. The hit loop is compiled for each combination
      */
-    enum class EnergyScale : unsigned int {
-      MIP,        /// Energy deposit in MIP
-      GEVDEP,     /// Energy deposit in Gev
-      NPE         /// Number of photo-electrons
+    enum DigiEffect : unsigned int {
+      TimingEffect    = 1 << 0,   /// timing cuts
+      MiscalibEffect  = 1 << 1,   /// uncorrelated miscalibration
+      NoiseEffect     = 1 << 2,   /// electronics noise
+      DeadCellEffect  = 1 << 3,   /// random dead cells
+      AllEffects      = ( 1 << 4 ) - 1
     };
-    
+
     /**
-     * 
+     *  @brief  Per event data
      */
     struct EventData {
       RandomGenerator          _generator {} ;
@@ -75,35 +81,74 @@ namespace marlinreco_mt {
     };
 
     /**
-     *  @brief  From inout energy, returns the digitized energy with correction factors applied
-     *
-     *  @param  evtdata the additional event data 
-     *  @param  energy the input sim hit energy
+     *  @brief  TimedEnergy struct
+     *          Energy deposited in a time slice and the time assigned to it
      */
-    float energyDigi( EventData &evtdata, float energy ) const ;
-    
+    struct TimedEnergy {
+      float                    _time {0.f} ;
+      float                    _energy {0.f} ;
+    };
+
     /**
-     *  @brief  Apply timing cuts on the sim hit
+     *  @brief  TimeSlices class
+     *          Fixed capacity list of timed energies (one per time slice) produced for a sim hit.
+     *          Never allocates
+     */
+    class TimeSlices {
+    public:
+      /// Add a timed energy. The capacity is checked in init() through the number of time slices
+      void push_back( float time, float energy ) { _slices[_size++] = TimedEnergy { time, energy } ; }
+      /// The number of timed energies
+      unsigned int size() const { return _size ; }
+      /// Iteration
+      const TimedEnergy *begin() const { return _slices.data() ; }
+      const TimedEnergy *end() const { return _slices.data() + _size ; }
+
+    private:
+      std::array<TimedEnergy, MAXTIMESLICES>  _slices {} ;
+      unsigned int                            _size {0} ;
+    };
+
+    /**
+     *  @brief  Digitise an event with the technology policy
      * 
-     *  @param  hit the input sim hit
+     *  @param  evt the event to process
+     *  @param  technology the technology policy
      */
-    std::vector < std::pair < float , float > > applyTimingCuts( const EVENT::SimCalorimeterHit * hit ) const ;
+    template <typename Technology>
+    void digitise( EVENT::LCEvent *evt, const Technology &technology ) ;
 
     /**
-     *  @brief  Get the energy unit
+     *  @brief  Digitise an event, hit loop specialised for the enabled effects
+     * 
+     *  @param  evt the event to process
+     *  @param  technology the technology policy
      */
-    virtual EnergyScale getMyUnit() const = 0 ;
-    
+    template <typename Technology, unsigned int Effects>
+    void digitiseEvent( EVENT::LCEvent *evt, const Technology &technology ) ;
+
     /**
-     *  @brief  Digitize the detector energy
+     *  @brief  From inout energy, returns the digitized energy with correction factors applied
      *
-     *  @param  gen the random number generator to use
-     *  @param  energy the input energy
+     *  @param  evtdata the additional event data 
+     *  @param  technology the technology policy
+     *  @param  energy the input sim hit energy
      */
-    virtual float digitiseDetectorEnergy( RandomGenerator &gen, float energy ) const = 0 ;
+    template <typename Technology, unsigned int Effects>
+    float energyDigi( EventData &evtdata, const Technology &technology, float energy ) const ;
     
     /**
-     *  @brief  Convert the input energy with the specified scale
+     *  @brief  Apply timing cuts on the sim hit. The time window is split in timingNSlices
+     *          equal slices, each slice with contributions gives a timed energy: the energy sum
+     *          and the earliest contribution time
+     * 
+     *  @param  hit the input sim hit
+     */
+    TimeSlices applyTimingCuts( const EVENT::SimCalorimeterHit * hit ) const ;
+
+    /**
+     *  @brief  Convert the input energy with the specified scale to the technology unit.
+     *          Only used in init()
      *  
      *  @param  energy the input energy
      *  @param  inScale the energy scale
@@ -115,6 +160,9 @@ namespace marlinreco_mt {
     marlin::InputCollectionsProperty _inputCollections {this, EVENT::LCIO::SIMCALORIMETERHIT, "inputHitCollections" ,
                             "Input simcalhit Collection Names" , {"SimCalorimeterHits"} } ;
 
+    marlin::Property<std::vector<int>> _inputCollectionGroups {this, "inputHitCollectionGroups",
+                            "Number of consecutive input collections digitised into each output collection. Empty: one output collection per input collection" } ;
+
     marlin::Property<EVENT::StringVec> _outputCollections {this, "outputHitCollections",
   			                    "Output calorimeterhit Collection Names" } ;
 
@@ -139,6 +187,9 @@ namespace marlinreco_mt {
     marlin::Property<float> _time_windowMax {this, "timingWindowMax",
                             "Time Window maximum time in ns", 100. } ;
 
+    marlin::Property<int> _time_nSlices {this, "timingNSlices",
+                            "Number of equal time slices in the time window, one output hit per slice with energy (max 4)", 1 } ;
+
     marlin::Property<float> _calib_mip {this, "calibration_mip",
                             "average G4 deposited energy by MIP for calibration", 1.e-4 } ;
                             
@@ -161,7 +212,10 @@ namespace marlinreco_mt {
                             "name of the part of the cellID that holds the layer", "K-1" } ;
     
     // internal variables (const by usage in processEvent)
+    std::vector<EVENT::StringVec> _inputGroups {} ;
     EnergyScale _threshold_iunit {} ;
+    float _oneMipInMyUnits {1.f} ;
+    unsigned int _effects {0} ;
     IMPL::LCFlagImpl _flag {} ;
     IMPL::LCFlagImpl _flag_rel {} ;
   };
@@ -7,7 +7,9 @@
 // -- lcio headers
 #include <EVENT/CalorimeterHit.h>
 #include <EVENT/LCEvent.h>
-#include <UTIL/CellIDDecoder.h>
+
+// -- marlinrecomt headers
+#include <MarlinRecoMT/CaloTechnology.h>
 
 #include <string>
 #include <vector>
@@ -17,7 +19,8 @@ namespace marlinreco_mt {
   /** === RealisticCaloReco Processor === <br>
       realistic reconstruction of calorimeter hits
       e.g. apply sampling fraction correction
-      virtual class, technology indenpendent
+      virtual class, technology indenpendent. Technology-specific classes
+      call reconstruct() with their technology policy (see CaloTechnology.h)
       D.Jeans 02/2016.
 
       24 March 2016: removed gap corrections - to be put into separate processor
@@ -36,12 +39,12 @@ namespace marlinreco_mt {
 
     // from marlin::Processor
     virtual void init() ;
-    virtual void processEvent( EVENT::LCEvent * evt ) ;
 
    protected:
     float getLayerCalib( int ilayer ) const ;
-    // to be overloaded, technology-specific
-    virtual float reconstructEnergy( UTIL::CellIDDecoder<EVENT::CalorimeterHit> &decoder, const EVENT::CalorimeterHit *hit ) const = 0 ;
+    // reconstruct an event with the technology policy. The hit loop is instantiated per technology
+    template <typename Technology>
+    void reconstruct( EVENT::LCEvent * evt, const Technology &technology ) ;
 
 
   protected:
@@ -65,6 +68,9 @@ namespace marlinreco_mt {
 
     marlin::Property<std::string> _cellIDLayerString {this, "CellIDLayerString" ,
                                "name of the part of the cellID that holds the layer", "K-1" } ;
+
+    // calibration coefficient per layer, built in init() (const by usage in processEvent)
+    std::vector<float> _layerCalibrations {} ;
   };
   
 }
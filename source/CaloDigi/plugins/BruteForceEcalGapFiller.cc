@@ -12,17 +12,16 @@ using namespace marlin::loglevel ;
 #include <IMPL/CalorimeterHitImpl.h>
 #include <EVENT/LCCollection.h>
 #include <EVENT/CalorimeterHit.h>
-#include <UTIL/CellIDDecoder.h>
 
 // -- dd4hep headers
-#include "DD4hep/DetectorSelector.h"
 #include "DD4hep/DetType.h"
-#include "DD4hep/Detector.h"
 #include "DD4hep/DD4hepUnits.h"
-#include "DDRec/DetectorData.h"
 
 // -- marlinreco mt headers
 #include "MarlinRecoMT/CalorimeterHitType.h"
+#include "MarlinRecoMT/CellIDFields.h"
+#include "MarlinRecoMT/GeometrySnapshot.h"
+#include "MarlinRecoMT/EventArena.h"
 
 namespace marlinreco_mt {
   
@@ -47,10 +46,10 @@ namespace marlinreco_mt {
     void processEvent( EVENT::LCEvent * evt ) ;
     
   private:
-    dd4hep::rec::LayeredCalorimeterData *getGeometryData( const int ihitType ) const ;
+    const CalorimeterGeometry *getGeometryData( const int ihitType ) const ;
     void fillHitMap( EVENT::LCCollection *collection, HitMapping &hitMap ) const ;
-    void addIntraModuleGapHits( EVENT::LCCollection* newcol, const HitMapping &hitMap, dd4hep::rec::LayeredCalorimeterData *calodata ) const ;
-    void addInterModuleGapHits( EVENT::LCCollection* newcol, const HitMapping &hitMap, dd4hep::rec::LayeredCalorimeterData *calodata ) const ;
+    void addIntraModuleGapHits( EVENT::LCCollection* newcol, EventArena<IMPL::CalorimeterHitImpl> &hitArena, const HitMapping &hitMap, const CalorimeterGeometry *calodata ) const ;
+    void addInterModuleGapHits( EVENT::LCCollection* newcol, EventArena<IMPL::CalorimeterHitImpl> &hitArena, const HitMapping &hitMap, const CalorimeterGeometry *calodata ) const ;
     
   private:
     marlin::InputCollectionProperty _inputHitCollection {this, EVENT::LCIO::CALORIMETERHIT, "inputHitCollection" ,
@@ -84,8 +83,9 @@ namespace marlinreco_mt {
              "factor applied to calculated energy of intra-module gap hits", 1.0 } ;
 
   private:
-    dd4hep::rec::LayeredCalorimeterData    *_barrelGeometry {nullptr} ;
-    dd4hep::rec::LayeredCalorimeterData    *_endcapGeometry {nullptr} ;
+    std::shared_ptr<const GeometrySnapshot> _geometry {nullptr} ;
+    const CalorimeterGeometry              *_barrelGeometry {nullptr} ;
+    const CalorimeterGeometry              *_endcapGeometry {nullptr} ;
   };
   
   //--------------------------------------------------------------------------
@@ -102,21 +102,21 @@ namespace marlinreco_mt {
     printParameters();
 
     // find detector data
-    dd4hep::Detector &detector = dd4hep::Detector::getInstance() ;
+    _geometry = GeometrySnapshot::instance() ;
     
-    const std::vector< dd4hep::DetElement>& barrelDetectors = dd4hep::DetectorSelector(detector).detectors( 
+    const auto barrelDetectors = _geometry->calorimeters( 
       ( dd4hep::DetType::CALORIMETER | dd4hep::DetType::ELECTROMAGNETIC | dd4hep::DetType::BARREL), 
       ( dd4hep::DetType::AUXILIARY | dd4hep::DetType::FORWARD ) ) ;
       
-    const std::vector< dd4hep::DetElement>& endcapDetectors = dd4hep::DetectorSelector(detector).detectors( 
+    const auto endcapDetectors = _geometry->calorimeters( 
       ( dd4hep::DetType::CALORIMETER | dd4hep::DetType::ELECTROMAGNETIC | dd4hep::DetType::ENDCAP), 
       ( dd4hep::DetType::AUXILIARY | dd4hep::DetType::FORWARD ) ) ;
 
     if( (barrelDetectors.size() == 1) ) {
-      _barrelGeometry = barrelDetectors.at(0).extension<dd4hep::rec::LayeredCalorimeterData>() ;
+      _barrelGeometry = barrelDetectors.at(0) ;
     }
     if( ( endcapDetectors.size() == 1 ) ) {
-      _endcapGeometry = endcapDetectors.at(0).extension<dd4hep::rec::LayeredCalorimeterData>();  
+      _endcapGeometry = endcapDetectors.at(0) ;  
     }
     if( (nullptr == _barrelGeometry) and (nullptr == _endcapGeometry) ) {
       marlin::ProcessorApi::abort( this, "Couldn't find any of the ecal calorimeters (endcap and barrel) !" ) ;
@@ -142,7 +142,7 @@ namespace marlinreco_mt {
       }
       // get the correct geometry data 
       auto hittype = static_cast<EVENT::CalorimeterHit*>( col->getElementAt( 0 ) )->getType() ;
-      dd4hep::rec::LayeredCalorimeterData *caloData = getGeometryData( hittype ) ;
+      const CalorimeterGeometry *caloData = getGeometryData( hittype ) ;
       
       // fill the hit map
       HitMapping hitMap ;
@@ -157,9 +157,10 @@ namespace marlinreco_mt {
       newcol->parameters().setValue( EVENT::LCIO::CellIDEncoding, encodingString ) ;
       newcol->setFlag( flag.getFlag() ) ;
 
-      // now make the gap hits
-      addIntraModuleGapHits( newcol.get(), hitMap, caloData ) ; // gaps within a module
-      addInterModuleGapHits( newcol.get(), hitMap, caloData ) ; // gaps between modules
+      // now make the gap hits. They are much fewer than the input hits, the arena grows if needed
+      EventArena<IMPL::CalorimeterHitImpl> hitArena( numElements / 16 ) ;
+      addIntraModuleGapHits( newcol.get(), hitArena, hitMap, caloData ) ; // gaps within a module
+      addInterModuleGapHits( newcol.get(), hitArena, hitMap, caloData ) ; // gaps between modules
 
       evt->addCollection( newcol.release(), _outputHitCollection ) ;
     } 
@@ -170,11 +171,11 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
 
-  dd4hep::rec::LayeredCalorimeterData *BruteForceEcalGapFiller::getGeometryData( const int ihitType ) const {
+  const CalorimeterGeometry *BruteForceEcalGapFiller::getGeometryData( const int ihitType ) const {
     // get information about geometry
     // calorimeter hit type used to decide if it's in barrel or endcap
     CHT calHitType( ihitType ) ;
-    dd4hep::rec::LayeredCalorimeterData *caloData {nullptr} ;
+    const CalorimeterGeometry *caloData {nullptr} ;
     if ( calHitType.is( CHT::barrel ) ) {
       caloData = _barrelGeometry ;
     }
@@ -195,14 +196,17 @@ namespace marlinreco_mt {
   //--------------------------------------------------------------------------
   
   void BruteForceEcalGapFiller::fillHitMap( EVENT::LCCollection *collection, HitMapping &hitMap ) const {
-    UTIL::CellIDDecoder<EVENT::CalorimeterHit> idDecoder( collection ) ;
+    auto cellIDFields = CellIDFields::get( collection ) ;
+    const CellIDField layerField  = cellIDFields->field( _cellIDLayerString ) ;
+    const CellIDField staveField  = cellIDFields->field( _cellIDStaveString ) ;
+    const CellIDField moduleField = cellIDFields->field( _cellIDModuleString ) ;
     auto numElements = collection->getNumberOfElements() ;
     // loop over input hits
     for (int j(0) ; j < numElements ; ++j ) {
       auto hit = static_cast<EVENT::CalorimeterHit*>( collection->getElementAt( j ) ) ;
-      unsigned int layer  = idDecoder( hit )[ _cellIDLayerString ] ;
-      unsigned int stave  = idDecoder( hit )[ _cellIDStaveString ] ;
-      unsigned int module = idDecoder( hit )[ _cellIDModuleString ] ;
+      unsigned int layer  = layerField( hit ) ;
+      unsigned int stave  = staveField( hit ) ;
+      unsigned int module = moduleField( hit ) ;
       if( (layer >= MAXLAYER) or (stave >= MAXSTAVE) or (module >= MAXMODULE) ) {
         marlin::ProcessorApi::abort( this, "Hit with incorrect layer, module or stave number!" ) ;
       }
@@ -212,14 +216,14 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
 
-  void BruteForceEcalGapFiller::addIntraModuleGapHits( EVENT::LCCollection* newcol, const HitMapping &hitMap, dd4hep::rec::LayeredCalorimeterData *calodata ) const {
+  void BruteForceEcalGapFiller::addIntraModuleGapHits( EVENT::LCCollection* newcol, EventArena<IMPL::CalorimeterHitImpl> &hitArena, const HitMapping &hitMap, const CalorimeterGeometry *calodata ) const {
     // look for gaps within modules
     // i.e. between wafers, between towers
     log<DEBUG3>() << " starting addIntraModuleGapHits" << std::endl ;
     for (unsigned int il=0; il<MAXLAYER; il++) {
       // we have to get the cell sizes here
-      const float cellsizeA = calodata->layers[il].cellSize0 / dd4hep::mm ;
-      const float cellsizeB = calodata->layers[il].cellSize1 / dd4hep::mm ;
+      const float cellsizeA = calodata->_layers[il]._cellSize0 / dd4hep::mm ;
+      const float cellsizeB = calodata->_layers[il]._cellSize1 / dd4hep::mm ;
       log<DEBUG0>() << "cell sizes in layer " << il << " = " << cellsizeA << " " << cellsizeB << " mm" << std::endl ;
       for (unsigned int is=0; is<MAXSTAVE; is++) {
         for (unsigned int im=0; im<MAXMODULE; im++) {
@@ -273,7 +277,7 @@ namespace marlinreco_mt {
               		CHT::CaloType cht_type = CHT::em;
               		CHT::CaloID   cht_id   = CHT::ecal;
               		CHT::Layout   cht_lay  = (calodata == _barrelGeometry) ? CHT::barrel : CHT::endcap ;
-              		auto newGapHit = new IMPL::CalorimeterHitImpl() ;
+              		auto newGapHit = hitArena.create() ;
               		newGapHit->setEnergy( _intraModuleFactor* std::log ( 1 + _intraModuleNonlinearFactor*extraEnergy )/_intraModuleNonlinearFactor );
               		newGapHit->setPosition( position );
               		newGapHit->setTime( mintime );
@@ -291,14 +295,14 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
 
-  void BruteForceEcalGapFiller::addInterModuleGapHits( EVENT::LCCollection* newcol, const HitMapping &hitMap, dd4hep::rec::LayeredCalorimeterData *calodata ) const {
+  void BruteForceEcalGapFiller::addInterModuleGapHits( EVENT::LCCollection* newcol, EventArena<IMPL::CalorimeterHitImpl> &hitArena, const HitMapping &hitMap, const CalorimeterGeometry *calodata ) const {
     // look for gaps between modules
     //  compare hits in same stave, same layer
     log<DEBUG3>() << " starting addInterModuleGapHits" << std::endl ;
     for (unsigned int il=0; il<MAXLAYER; il++) {
       // we have to get the cell sizes here
-      const float cellsizeA = calodata->layers[il].cellSize0 / dd4hep::mm ;
-      const float cellsizeB = calodata->layers[il].cellSize1 / dd4hep::mm ;      
+      const float cellsizeA = calodata->_layers[il]._cellSize0 / dd4hep::mm ;
+      const float cellsizeB = calodata->_layers[il]._cellSize1 / dd4hep::mm ;      
       for (unsigned int is=0; is<MAXSTAVE; is++) {
         for (unsigned int im=0; im<MAXMODULE; im++) {
         	auto &theseHits = hitMap [ il ][ is ][ im ] ;
@@ -351,7 +355,7 @@ namespace marlinreco_mt {
               		CHT::CaloType cht_type = CHT::em;
               		CHT::CaloID   cht_id   = CHT::ecal;
               		CHT::Layout   cht_lay  = (calodata == _barrelGeometry) ? CHT::barrel : CHT::endcap ;
-              		auto newGapHit = new IMPL::CalorimeterHitImpl();
+              		auto newGapHit = hitArena.create() ;
               		newGapHit->setEnergy( _interModuleFactor* std::log ( 1 + _interModuleNonlinearFactor*extraEnergy )/_interModuleNonlinearFactor );
               		newGapHit->setPosition( position );
               		newGapHit->setTime( mintime );
@@ -11,18 +11,19 @@
 
 // -- std headers
 #include <string>
-#include <algorithm>
 
 namespace marlinreco_mt {
 
   class RealisticCaloDigiScinPpd : public RealisticCaloDigi {
    public:
     RealisticCaloDigiScinPpd() ;
+    
+    // from marlin::Processor
+    void init() ;
+    void processEvent( EVENT::LCEvent *evt ) ;
 
    protected:
      // from RealisticCaloDigi
-    RealisticCaloDigi::EnergyScale getMyUnit() const ;
-    float digitiseDetectorEnergy( RandomGenerator &gen, float energy ) const ;
     float convertEnergy( float energy, RealisticCaloDigi::EnergyScale inputUnit ) const ;
 
   private:
@@ -37,6 +38,9 @@ namespace marlinreco_mt {
 
     marlin::Property<float> _pixSpread {this, "ppd_pix_spread",
                                "variation of PPD pixel signal (as a fraction: 0.01=1%)", 0.05 } ;
+
+    /// The technology policy, filled in init()
+    ScinPpdDigiTechnology _technology {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -49,51 +53,24 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
   
-  RealisticCaloDigi::EnergyScale RealisticCaloDigiScinPpd::getMyUnit() const {
-    return RealisticCaloDigi::EnergyScale::NPE;
+  void RealisticCaloDigiScinPpd::init() {
+    _technology._pePerMip = _PPD_pe_per_mip ;
+    _technology._nPixels = _PPD_n_pixels ;
+    _technology._pixSpread = _pixSpread ;
+    _technology._calibMip = _calib_mip ;
+    RealisticCaloDigi::init() ;
   }
 
   //--------------------------------------------------------------------------
-
-  float RealisticCaloDigiScinPpd::convertEnergy( float energy, RealisticCaloDigi::EnergyScale inUnit ) const {
-    if ( inUnit == RealisticCaloDigi::EnergyScale::NPE ) {
-      return energy;
-    }
-    else if ( inUnit == RealisticCaloDigi::EnergyScale::MIP ) {
-      return _PPD_pe_per_mip * energy ;
-    }
-    else if ( inUnit == RealisticCaloDigi::EnergyScale::GEVDEP ) {
-      return _PPD_pe_per_mip * energy / _calib_mip ;
-    }
-    else {
-      marlin::ProcessorApi::abort( this, "convertEnergy: Unknown conversion unit!" ) ;
-    }
-    // just to make the compiler happy ...
-    return 0.f ;
-  }
   
+  void RealisticCaloDigiScinPpd::processEvent( EVENT::LCEvent *evt ) {
+    digitise( evt, _technology ) ;
+  }
+
   //--------------------------------------------------------------------------
 
-  float RealisticCaloDigiScinPpd::digitiseDetectorEnergy( RandomGenerator &gen, float energy ) const {
-    // input energy in deposited GeV
-    // output in npe
-    float npe = energy*_PPD_pe_per_mip / _calib_mip; // convert to pe scale
-
-    if ( _PPD_n_pixels > 0 ) {
-      // apply average sipm saturation behaviour
-      npe = _PPD_n_pixels*(1.0 - exp( -npe/_PPD_n_pixels ) ) ;
-      //apply binomial smearing
-      float p = npe / _PPD_n_pixels ; // fraction of hit pixels on SiPM
-      std::binomial_distribution<int> binom( _PPD_n_pixels, p ) ;
-      npe = binom( gen ) ; //npe now quantised to integer pixels
-
-      if ( _pixSpread > 0) {
-        // variations in pixel capacitance
-        std::normal_distribution<float> norm( 1., _pixSpread / std::sqrt(npe) ) ;
-        npe *= norm( gen ) ;
-      }
-    }
-    return npe;
+  float RealisticCaloDigiScinPpd::convertEnergy( float energy, RealisticCaloDigi::EnergyScale inUnit ) const {
+    return _technology.convertEnergy( energy, inUnit ) ;
   }
 
   // processor declaration
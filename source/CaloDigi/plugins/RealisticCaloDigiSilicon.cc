@@ -10,24 +10,27 @@
 // -- std headers
 #include <iostream>
 #include <string>
-#include <algorithm>
-#include <assert.h>
 
 namespace marlinreco_mt {
 
   class RealisticCaloDigiSilicon : public RealisticCaloDigi {
   public:
     RealisticCaloDigiSilicon() ;
+    
+    // from marlin::Processor
+    void init() ;
+    void processEvent( EVENT::LCEvent *evt ) ;
 
   protected:
      // from RealisticCaloDigi
-    RealisticCaloDigi::EnergyScale getMyUnit() const ;
-    float digitiseDetectorEnergy( RandomGenerator &gen, float energy ) const ;
     float convertEnergy( float energy, RealisticCaloDigi::EnergyScale inputUnit ) const ;
     
   private:
     marlin::Property<float> _ehEnergy {this, "silicon_pairEnergy",
                                "energy required to create e-h pair in silicon (in eV)", 3.6 } ;
+
+    /// The technology policy, filled in init()
+    SiliconDigiTechnology _technology {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -40,43 +43,23 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
   
-  RealisticCaloDigi::EnergyScale RealisticCaloDigiSilicon::getMyUnit() const {
-    return RealisticCaloDigi::EnergyScale::MIP;
+  void RealisticCaloDigiSilicon::init() {
+    _technology._ehEnergy = _ehEnergy ;
+    _technology._calibMip = _calib_mip ;
+    RealisticCaloDigi::init() ;
   }
-  
-  //--------------------------------------------------------------------------
 
-  float RealisticCaloDigiSilicon::convertEnergy( float energy, RealisticCaloDigi::EnergyScale inUnit ) const {
-    // converts input energy to MIP scale
-    if( inUnit == RealisticCaloDigi::EnergyScale::MIP ) {
-      return energy ;
-    }
-    else if ( inUnit == RealisticCaloDigi::EnergyScale::GEVDEP ) {
-      return energy / _calib_mip;
-    }
-    else {
-      marlin::ProcessorApi::abort( this, "convertEnergy: Unknown conversion unit!" ) ;
-    }
-    // just to make the compiler happy ...
-    return 0.f ;
+  //--------------------------------------------------------------------------
+  
+  void RealisticCaloDigiSilicon::processEvent( EVENT::LCEvent *evt ) {
+    digitise( evt, _technology ) ;
   }
 
   //--------------------------------------------------------------------------
 
-  float RealisticCaloDigiSilicon::digitiseDetectorEnergy( RandomGenerator &gen, float energy ) const {
-    // applies extra digitisation to silicon hits
-    //  input energy in deposited GeV
-    //  output is MIP scale
-    float smeared_energy(energy) ;
-    if ( _ehEnergy > 0 ) {
-      // calculate #e-h pairs
-      float nehpairs = 1e9*energy / _ehEnergy; // check units of energy! _ehEnergy is in eV, energy in GeV
-      // fluctuate it by Poisson (actually an overestimate: Fano factor actually makes it smaller, however even this overstimated effect is tiny for our purposes)
-      std::poisson_distribution<int> poiss( nehpairs ) ;
-      smeared_energy *= poiss( gen ) ;
-    }
-     // convert to MIP units
-    return smeared_energy / _calib_mip;
+  float RealisticCaloDigiSilicon::convertEnergy( float energy, RealisticCaloDigi::EnergyScale inUnit ) const {
+    // converts input energy to MIP scale
+    return _technology.convertEnergy( energy, inUnit ) ;
   }
 
   // processor declaration
@@ -12,8 +12,9 @@ namespace marlinreco_mt {
   public:
     RealisticCaloRecoScinPpd() ;
 
-  private:
-    float reconstructEnergy( UTIL::CellIDDecoder<EVENT::CalorimeterHit> &decoder, const EVENT::CalorimeterHit *hit ) const override ;
+    // from marlin::Processor
+    void init() ;
+    void processEvent( EVENT::LCEvent *evt ) ;
 
   private:
     marlin::Property<float> _photoelectronsPerMIP {this, "ppd_mipPe",
@@ -21,6 +22,9 @@ namespace marlinreco_mt {
                             
     marlin::Property<int> _nPixels {this, "ppd_npix",
                             "total number of MPPC/SiPM pixels for implementation of saturation effect", 10000 } ;
+
+    /// The technology policy, filled in init()
+    ScinPpdRecoTechnology _technology {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -33,27 +37,17 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
   
-  float RealisticCaloRecoScinPpd::reconstructEnergy( UTIL::CellIDDecoder<EVENT::CalorimeterHit> &decoder, const EVENT::CalorimeterHit *hit ) const {
-    // here the input energy should be in NPE
-    float energy = hit->getEnergy() ;
-    // first de-saturate PPD response
-    // this is the fraction of SiPM pixels fired above which a linear continuation of the saturation-reconstruction function is used. 
-    // 0.95 of nPixel corresponds to a energy correction of factor ~3.
-    const float r = 0.95 ;
-    if (energy < r*_nPixels) { //current hit below linearisation threshold, reconstruct energy normally:
-      energy = -_nPixels * std::log ( 1. - ( energy / _nPixels ) ) ;
-    } 
-    else { //current hit is aove linearisation threshold, reconstruct using linear continuation function:
-      energy = 1 / ( 1 - r ) * ( energy - r*_nPixels ) - _nPixels * std::log( 1 - r ) ;
-    }
-    // then go back to MIP scale
-    energy /= _photoelectronsPerMIP ;
-    // what layer is this hit in?
-    int layer   = decoder(hit)[_cellIDLayerString];
-    // now correct for sampling fraction (calibration from MIP -> shower GeV)
-    energy *= this->getLayerCalib( layer ) ;
-
-    return energy ;
+  void RealisticCaloRecoScinPpd::init() {
+    _technology._pePerMip = _photoelectronsPerMIP ;
+    _technology._nPixels = _nPixels ;
+    RealisticCaloReco::init() ;
+  }
+
+  //--------------------------------------------------------------------------
+  
+  void RealisticCaloRecoScinPpd::processEvent( EVENT::LCEvent *evt ) {
+    // input energy in NPE: de-saturate the PPD response, then back to MIP scale
+    reconstruct( evt, _technology ) ;
   }
 
   // processor declaration
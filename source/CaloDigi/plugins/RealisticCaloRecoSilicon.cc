@@ -13,8 +13,12 @@ namespace marlinreco_mt {
   public:
     RealisticCaloRecoSilicon() ;
 
+    // from marlin::Processor
+    void processEvent( EVENT::LCEvent *evt ) ;
+
   private:
-    float reconstructEnergy( UTIL::CellIDDecoder<EVENT::CalorimeterHit> &decoder, const EVENT::CalorimeterHit *hit ) const override ;
+    /// The technology policy: the input energy is already in MIPs
+    SiliconRecoTechnology _technology {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -27,14 +31,8 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
   
-  float RealisticCaloRecoSilicon::reconstructEnergy( UTIL::CellIDDecoder<EVENT::CalorimeterHit> &decoder, const EVENT::CalorimeterHit *hit ) const {
-    // here the input energy should be in MIPs
-    float energy = hit->getEnergy() ;
-    // what layer is this hit in?
-    int layer   = decoder( hit ) [ _cellIDLayerString ] ;
-    // now correct for sampling fraction
-    energy *= this->getLayerCalib( layer ) ;
-    return energy ;
+  void RealisticCaloRecoSilicon::processEvent( EVENT::LCEvent *evt ) {
+    reconstruct( evt, _technology ) ;
   }
 
   // processor declaration
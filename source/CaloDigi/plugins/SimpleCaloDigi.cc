@@ -8,6 +8,9 @@ using namespace marlin::loglevel ;
 
 // -- marlinreco mt headers
 #include <MarlinRecoMT/CalorimeterHitType.h>
+#include <MarlinRecoMT/CellIDFields.h>
+#include <MarlinRecoMT/GeometrySnapshot.h>
+#include <MarlinRecoMT/EventArena.h>
 
 // -- lcio headers
 #include <EVENT/LCCollection.h>
@@ -17,17 +20,15 @@ using namespace marlin::loglevel ;
 #include <IMPL/LCFlagImpl.h>
 #include <IMPL/LCRelationImpl.h>
 #include <EVENT/LCParameters.h>
-#include <UTIL/CellIDDecoder.h>
 
 // #include <algorithm>
 // #include <string>
 #include <cctype> 
+#include <cstdint>
 #include <cstdlib>  // abs
-
-// -- dd4hep headers
-#include "DD4hep/Detector.h"
-#include "DD4hep/DD4hepUnits.h"
-#include "DDRec/DetectorData.h"
+#include <memory>
+#include <utility>
+#include <vector>
 
 namespace marlinreco_mt {
   
@@ -35,7 +36,11 @@ namespace marlinreco_mt {
    *  Simple calorimeter digitizer for calorimeter detectors.
    *  Converts SimCalorimeterHit collection to a 
    *  CalorimeterHit collection applying a threshold and an calibration constant... 
-   *  Works for muon chambers, standard calorimeters and FCal calorimeters as well
+   *  Works for muon chambers, standard calorimeters and FCal calorimeters as well.
+   *  All the input collections are digitised into the same output collection
+   *  and must have the same cellID encoding.
+   *  Each collection is processed in two passes: a scan selecting the hits above
+   *  threshold in the kept layers, then the creation of exactly that many output hits.
    *  @version $Id$
    */
   class SimpleCaloDigi : public marlin::Processor {
@@ -88,7 +93,12 @@ namespace marlinreco_mt {
     marlin::Property<std::string> _caloLayout {this, "CaloLayout" ,
             "subdetector layout: barrel, endcap, plug, ring" } ;
             
-    std::vector<bool>            _useLayers {} ;    
+    /// One bit per layer of the detector, set if the layer is kept. Empty to keep all the layers
+    std::vector<std::uint64_t>   _keptLayerMask {} ;
+    unsigned int                 _nMaskedLayers {0} ;
+    CHT::CaloType                _chtType {} ;
+    CHT::CaloID                  _chtID {} ;
+    CHT::Layout                  _chtLayout {} ;
   };
   
   //--------------------------------------------------------------------------
@@ -104,29 +114,34 @@ namespace marlinreco_mt {
   void SimpleCaloDigi::init() {
     printParameters() ;
     // Get the number of Layers in detector
-    unsigned int nLayers = 0 ;
+    std::shared_ptr<const GeometrySnapshot> geometry ;
     try {
-      dd4hep::Detector & mainDetector = dd4hep::Detector::getInstance() ;
-      dd4hep::DetElement theDetector = mainDetector.detector( _detectorName ) ;
-      auto calorimeterParameters  = theDetector.extension<dd4hep::rec::LayeredCalorimeterData>() ;
-      nLayers =  calorimeterParameters->layers.size() ;
+      geometry = GeometrySnapshot::instance() ;
     }
     catch( std::exception& e ) {
       marlin::ProcessorApi::abort( this, "No detector available: " + std::string(e.what()) ) ;
     }
+    auto calorimeter = geometry->calorimeter( _detectorName ) ;
+    if( nullptr == calorimeter ) {
+      marlin::ProcessorApi::abort( this, "No calorimeter data for detector " + _detectorName.get() ) ;
+    }
+    const unsigned int nLayers = calorimeter->_layers.size() ;
     // If the vectors are empty, we are keeping everything 
     if(_layersToKeep.get().size() > 0) {
-      // Layers start at 0
-      for(unsigned int i = 0; i < nLayers; ++i) {
-        _useLayers.push_back(false) ;
-        for(auto iter = _layersToKeep.get().begin(); iter < _layersToKeep.get().end(); ++iter) {
-        	if (i == *iter-1) {
-        	  _useLayers[i] = true ; 
-            break;
-        	}
+      // Layers start at 0, the layers beyond the detector ones are kept
+      _nMaskedLayers = nLayers ;
+      _keptLayerMask.assign( ( nLayers + 63 ) / 64, 0 ) ;
+      for( const auto layerToKeep : _layersToKeep.get() ) {
+        const unsigned int layer = layerToKeep - 1 ;
+        if( layer < nLayers ) {
+          _keptLayerMask[ layer / 64 ] |= std::uint64_t(1) << ( layer % 64 ) ;
         }
       }
     }
+    // layout information
+    _chtLayout = layoutFromString( _caloLayout ) ; 
+    _chtID = caloIDFromString( _caloID ) ; 
+    _chtType = caloTypeFromString( _caloType ) ;
   }
   
   //--------------------------------------------------------------------------
@@ -141,52 +156,64 @@ namespace marlinreco_mt {
     flag.setBit( EVENT::LCIO::CHBIT_ID1 ) ;
     outputCollection->setFlag( flag.getFlag() ) ;
     std::string initString ;
-    // layout information
-    auto caloLayout = layoutFromString( _caloLayout ) ; 
-    auto caloID = caloIDFromString( _caloID ) ; 
-    auto caloType = caloTypeFromString( _caloType ) ;
+    // the hits surviving the selection and their layer
+    std::vector<std::pair<EVENT::SimCalorimeterHit*, unsigned int>> selectedHits ;
     // loop over input collections
     for (unsigned int i(0); i < _inputCollections.get().size(); ++i) {
       std::string colName =  _inputCollections.get()[i] ;
       try {
         auto collection = evt->getCollection( colName ) ;
-        initString = collection->getParameters().getStringVal( EVENT::LCIO::CellIDEncoding ) ;
+        const std::string &encoding = collection->getParameters().getStringVal( EVENT::LCIO::CellIDEncoding ) ;
+        // all the input collections end up in the same output collection
+        if( initString.empty() ) {
+          initString = encoding ;
+        }
+        else if( encoding != initString ) {
+          marlin::ProcessorApi::abort( this, "Input collection " + colName + " has a cellID encoding different from the other input collections" ) ;
+        }
         int numElements = collection->getNumberOfElements() ;
-        UTIL::CellIDDecoder<EVENT::SimCalorimeterHit> idDecoder( collection ) ;
+        const CellIDField layerField = CellIDFields::get( initString )->field( _cellIDLayerString ) ;
         log<DEBUG3>() << "Number of hits: " << numElements << std::endl ;
-        // Loop over hits in the current collection
+        // phase 1: select the hits, cheap energy threshold test first
+        selectedHits.clear() ;
+        selectedHits.reserve( numElements ) ;
         for (int j(0); j < numElements; ++j) {
         	auto hit = static_cast<EVENT::SimCalorimeterHit*>( collection->getElementAt( j ) ) ;
-          if( nullptr == hit ) {
+          if( nullptr == hit || not ( hit->getEnergy() > _energyThreshold ) ) {
             continue ;
           }
-        	float energy = hit->getEnergy() ;
-        	int cellid = hit->getCellID0() ;
-        	int cellid1 = hit->getCellID1() ;
-        	unsigned int layer = std::abs( idDecoder(hit)[ _cellIDLayerString ] ) ;
+        	unsigned int layer = std::abs( layerField( hit ) ) ;
         	//Check if we want to use this layer, else go to the next hit
         	if( not useLayer( layer ) ) {
             log<DEBUG3>() << "  Skipping hit '" << hit->id() << "' in layer " << layer << std::endl ;
             continue ;
           }
-        	float calibratedEnergy = _calibrationCoefficient * energy ;
+          selectedHits.emplace_back( hit, layer ) ;
+        }
+        // phase 2: create exactly the selected number of output hits and relations
+        const std::size_t nSelected = selectedHits.size() ;
+        outputCollection->reserve( outputCollection->size() + nSelected ) ;
+        relationCollection->reserve( relationCollection->size() + nSelected ) ;
+        EventArena<IMPL::CalorimeterHitImpl> hitArena( nSelected ) ;
+        EventArena<IMPL::LCRelationImpl> relationArena( nSelected ) ;
+        for( const auto &selected : selectedHits ) {
+          auto hit = selected.first ;
+        	float calibratedEnergy = _calibrationCoefficient * hit->getEnergy() ;
         	if( calibratedEnergy > _maxHitEnergy ) {
             calibratedEnergy = _maxHitEnergy ;
           }
-        	if ( energy > _energyThreshold ) {
-            log<DEBUG3>() << "  Accepting hit " << hit->id() << std::endl ;
-        	  auto calhit = new IMPL::CalorimeterHitImpl();
-        	  calhit->setCellID0( cellid ) ;
-        	  calhit->setCellID1( cellid1 ) ;
-        	  calhit->setEnergy( calibratedEnergy ) ;
-        	  calhit->setPosition( hit->getPosition() ) ;
-        	  calhit->setType( CHT( caloType, caloID, caloLayout, layer ) );
-        	  calhit->setRawHit( hit ) ;
-        	  outputCollection->addElement( calhit ) ;
-            // create a calo hit <-> sim calo hit relation
-        	  auto rel = new IMPL::LCRelationImpl( calhit, hit, 1. ) ;
-        	  relationCollection->addElement( rel ) ;
-        	}
+          log<DEBUG3>() << "  Accepting hit " << hit->id() << std::endl ;
+          auto calhit = hitArena.create() ;
+          calhit->setCellID0( hit->getCellID0() ) ;
+          calhit->setCellID1( hit->getCellID1() ) ;
+          calhit->setEnergy( calibratedEnergy ) ;
+          calhit->setPosition( hit->getPosition() ) ;
+          calhit->setType( CHT( _chtType, _chtID, _chtLayout, selected.second ) );
+          calhit->setRawHit( hit ) ;
+          outputCollection->addElement( calhit ) ;
+          // create a calo hit <-> sim calo hit relation
+          auto rel = relationArena.create( calhit, hit, 1. ) ;
+          relationCollection->addElement( rel ) ;
         }
       }
       catch(EVENT::DataNotAvailableException &e) {
@@ -201,10 +228,10 @@ namespace marlinreco_mt {
   //--------------------------------------------------------------------------
 
   bool SimpleCaloDigi::useLayer( unsigned int layer ) const {
-    if( layer > _useLayers.size() || _useLayers.size() == 0 ) {
+    if( layer >= _nMaskedLayers ) {
       return true ;
     }
-    return _useLayers[layer] ;
+    return ( _keptLayerMask[ layer / 64 ] >> ( layer % 64 ) ) & 1 ;
   }
   
   // processor declaration
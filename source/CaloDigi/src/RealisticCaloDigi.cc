@@ -10,16 +10,19 @@
 #include <IMPL/CalorimeterHitImpl.h>
 #include <IMPL/LCRelationImpl.h>
 #include <EVENT/LCParameters.h>
-#include <UTIL/CellIDDecoder.h>
 
 // -- marlinrecomt headers
 #include <MarlinRecoMT/CalorimeterHitType.h>
+#include <MarlinRecoMT/CellIDFields.h>
+#include <MarlinRecoMT/EventArena.h>
 
 // -- std headers
 #include <iostream>
 #include <string>
 #include <assert.h>
+#include <algorithm>
 #include <cmath>
+#include <limits>
 
 namespace marlinreco_mt {
 
@@ -33,13 +36,36 @@ namespace marlinreco_mt {
   void RealisticCaloDigi::init() {
     // usually a good idea to
     printParameters() ;
-    // check that number of input and output collections names are the same
-    if( _outputCollections.get().size() != _inputCollections.get().size() ) {
+    // group the input collections, one group per output collection
+    const auto &inputCollections = _inputCollections.get() ;
+    if( _inputCollectionGroups.get().empty() ) {
+      for( const auto &colName : inputCollections ) {
+        _inputGroups.push_back( { colName } ) ;
+      }
+    }
+    else {
+      std::size_t first(0) ;
+      for( const auto groupSize : _inputCollectionGroups.get() ) {
+        if( groupSize <= 0 || first + groupSize > inputCollections.size() ) {
+          marlin::ProcessorApi::abort( this, "Invalid input collection group sizes" ) ;
+        }
+        _inputGroups.push_back( EVENT::StringVec( inputCollections.begin() + first, inputCollections.begin() + first + groupSize ) ) ;
+        first += groupSize ;
+      }
+      if( first != inputCollections.size() ) {
+        marlin::ProcessorApi::abort( this, "Input collection groups don't cover all the input collections" ) ;
+      }
+    }
+    // check that number of input groups and output collections names are the same
+    if( _outputCollections.get().size() != _inputGroups.size() ) {
       marlin::ProcessorApi::abort( this, "Input/output collection list sizes are different" ) ;
     }
-    if( _outputRelCollections.get().size() != _inputCollections.get().size() ) {
+    if( _outputRelCollections.get().size() != _inputGroups.size() ) {
       marlin::ProcessorApi::abort( this, "Input/output collection list sizes are different" ) ;
     }
+    if( _time_nSlices < 1 || _time_nSlices > int(MAXTIMESLICES) ) {
+      marlin::ProcessorApi::abort( this, "Invalid number of time slices, must be between 1 and " + std::to_string( MAXTIMESLICES ) ) ;
+    }
     // unit in which threshold is specified
     if (_threshold_unit.get().compare("MIP") == 0) {
       _threshold_iunit = EnergyScale::MIP ;
@@ -54,7 +80,27 @@ namespace marlinreco_mt {
       marlin::ProcessorApi::abort( this, "Could not identify threshold unit. Please use \"GeV\", \"MIP\" or \"px\"!" ) ;
     }
     // convert the threshold to the approriate units (i.e. MIP for silicon, NPE for scint)
-    _threshold_value = convertEnergy( _threshold_value, _threshold_iunit ) ;
+    try {
+      _threshold_value = convertEnergy( _threshold_value, _threshold_iunit ) ;
+      _oneMipInMyUnits = convertEnergy( 1.0, EnergyScale::MIP ) ;
+    }
+    catch( EVENT::Exception &e ) {
+      marlin::ProcessorApi::abort( this, e.what() ) ;
+    }
+    // the per-hit effects to compile in the hit loop
+    _effects = 0 ;
+    if( _time_apply ) {
+      _effects |= TimingEffect ;
+    }
+    if( _misCalib_uncorrel > 0 ) {
+      _effects |= MiscalibEffect ;
+    }
+    if( _elec_noiseMip > 0 ) {
+      _effects |= NoiseEffect ;
+    }
+    if( _deadCell_fraction > 0 ) {
+      _effects |= DeadCellEffect ;
+    }
     // setup output collection flags
     _flag.setBit( EVENT::LCIO::CHBIT_LONG ) ;
     _flag.setBit( EVENT::LCIO::RCHBIT_TIME ) ; //store timing on output hits.
@@ -65,99 +111,149 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
 
-  void RealisticCaloDigi::processEvent( EVENT::LCEvent * evt ) {
+  template <typename Technology>
+  void RealisticCaloDigi::digitise( EVENT::LCEvent * evt, const Technology &technology ) {
+    switch( _effects ) {
+      case 0:  digitiseEvent<Technology, 0>( evt, technology ) ; break ;
+      case 1:  digitiseEvent<Technology, 1>( evt, technology ) ; break ;
+      case 2:  digitiseEvent<Technology, 2>( evt, technology ) ; break ;
+      case 3:  digitiseEvent<Technology, 3>( evt, technology ) ; break ;
+      case 4:  digitiseEvent<Technology, 4>( evt, technology ) ; break ;
+      case 5:  digitiseEvent<Technology, 5>( evt, technology ) ; break ;
+      case 6:  digitiseEvent<Technology, 6>( evt, technology ) ; break ;
+      case 7:  digitiseEvent<Technology, 7>( evt, technology ) ; break ;
+      case 8:  digitiseEvent<Technology, 8>( evt, technology ) ; break ;
+      case 9:  digitiseEvent<Technology, 9>( evt, technology ) ; break ;
+      case 10: digitiseEvent<Technology, 10>( evt, technology ) ; break ;
+      case 11: digitiseEvent<Technology, 11>( evt, technology ) ; break ;
+      case 12: digitiseEvent<Technology, 12>( evt, technology ) ; break ;
+      case 13: digitiseEvent<Technology, 13>( evt, technology ) ; break ;
+      case 14: digitiseEvent<Technology, 14>( evt, technology ) ; break ;
+      case 15: digitiseEvent<Technology, 15>( evt, technology ) ; break ;
+      default: break ;
+    }
+    static_assert( AllEffects == 15, "RealisticCaloDigi::digitise: effect dispatch is out of date" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename Technology, unsigned int Effects>
+  void RealisticCaloDigi::digitiseEvent( EVENT::LCEvent * evt, const Technology &technology ) {
     // deal with random numbers there
     auto randomSeed = marlin::ProcessorApi::getRandomSeed( this, evt ) ;
     EventData eventData ;
     eventData._generator.seed( randomSeed ) ;
     std::normal_distribution<float> miscalDistCorel( 1.0, _misCalib_correl );
     // decide on this event's correlated miscalibration
+    eventData._eventCorrelMiscalib = 1.f ;
     if ( _misCalib_correl > 0 ) {
       eventData._eventCorrelMiscalib = miscalDistCorel( eventData._generator ) ;
     }
-    // loop over simulated hit collections
-    for ( unsigned int i=0 ; i<_inputCollections.get().size() ; ++i ) {
-      auto colName = _inputCollections.get().at( i ) ;
-      log<marlin::DEBUG1>() << "Looking for collection: " << colName << std::endl ;
-      try {
-        EVENT::LCCollection * col = evt->getCollection( colName.c_str() ) ;
-        std::string initString = col->getParameters().getStringVal( EVENT::LCIO::CellIDEncoding ) ;
-        CHT::CaloType cht_type = caloTypeFromString( colName ) ;
-        CHT::CaloID   cht_id   = caloIDFromString( colName ) ;
-        CHT::Layout   cht_lay  = layoutFromString( colName ) ;
-        UTIL::CellIDDecoder<EVENT::SimCalorimeterHit> idDecoder( col );
-        const auto numElements = col->getNumberOfElements();
-        log<marlin::DEBUG1>() << colName << " number of elements = " << numElements << std::endl ;
-        // don't go further if no hits
-        if ( numElements==0 ) {
-          continue ;
+    // loop over groups of simulated hit collections, one output collection per group
+    for ( unsigned int i=0 ; i<_inputGroups.size() ; ++i ) {
+      std::vector<std::pair<std::string, EVENT::LCCollection*>> collections ;
+      std::string initString ;
+      int numElements(0) ;
+      for ( const auto &colName : _inputGroups[i] ) {
+        log<marlin::DEBUG1>() << "Looking for collection: " << colName << std::endl ;
+        try {
+          EVENT::LCCollection * col = evt->getCollection( colName ) ;
+          const std::string &encoding = col->getParameters().getStringVal( EVENT::LCIO::CellIDEncoding ) ;
+          if( collections.empty() ) {
+            initString = encoding ;
+          }
+          else if( encoding != initString ) {
+            marlin::ProcessorApi::abort( this, "Input collection " + colName + " has a cellID encoding different from the other collections of its group" ) ;
+          }
+          log<marlin::DEBUG1>() << colName << " number of elements = " << col->getNumberOfElements() << std::endl ;
+          numElements += col->getNumberOfElements() ;
+          collections.push_back( { colName, col } ) ;
         }
-        // create new collection: hits
-        IMPL::LCCollectionVec *newcol = new IMPL::LCCollectionVec( EVENT::LCIO::CALORIMETERHIT );
-        newcol->setFlag(_flag.getFlag()) ;
-        // hit relations to simhits [calo -> sim]
-        IMPL::LCCollectionVec *relcol  = new IMPL::LCCollectionVec( EVENT::LCIO::LCRELATION );
-        relcol->setFlag(_flag_rel.getFlag());
-        relcol->parameters().setValue( RELATIONFROMTYPESTR , EVENT::LCIO::CALORIMETERHIT ) ;
-        relcol->parameters().setValue( RELATIONTOTYPESTR   , EVENT::LCIO::SIMCALORIMETERHIT ) ;
+        catch(EVENT::DataNotAvailableException &e) {
+          log<marlin::DEBUG1>() << "Could not find input collection " << colName << std::endl;
+        }
+      }
+      // don't go further if no hits
+      if ( numElements==0 ) {
+        continue ;
+      }
+      const CellIDField layerField = CellIDFields::get( initString )->field( _cellIDLayerString ) ;
+      // create new collection: hits
+      IMPL::LCCollectionVec *newcol = new IMPL::LCCollectionVec( EVENT::LCIO::CALORIMETERHIT );
+      newcol->setFlag(_flag.getFlag()) ;
+      // hit relations to simhits [calo -> sim]
+      IMPL::LCCollectionVec *relcol  = new IMPL::LCCollectionVec( EVENT::LCIO::LCRELATION );
+      relcol->setFlag(_flag_rel.getFlag());
+      relcol->parameters().setValue( RELATIONFROMTYPESTR , EVENT::LCIO::CALORIMETERHIT ) ;
+      relcol->parameters().setValue( RELATIONTOTYPESTR   , EVENT::LCIO::SIMCALORIMETERHIT ) ;
+      // at most one output hit per input hit and time slice
+      const int maxOutputHits = numElements * ( ( Effects & TimingEffect ) ? _time_nSlices : 1 ) ;
+      newcol->reserve( maxOutputHits ) ;
+      relcol->reserve( maxOutputHits ) ;
+      EventArena<IMPL::CalorimeterHitImpl> hitArena( numElements ) ;
+      EventArena<IMPL::LCRelationImpl> relationArena( numElements ) ;
+      for ( const auto &collection : collections ) {
+        EVENT::LCCollection * col = collection.second ;
+        CHT::CaloType cht_type = caloTypeFromString( collection.first ) ;
+        CHT::CaloID   cht_id   = caloIDFromString( collection.first ) ;
+        CHT::Layout   cht_lay  = layoutFromString( collection.first ) ;
+        const int colElements = col->getNumberOfElements() ;
         // loop over input hits
-        for ( int j=0 ; j<numElements ; ++j ) {
+        for ( int j=0 ; j<colElements ; ++j ) {
           EVENT::SimCalorimeterHit * simhit = dynamic_cast<EVENT::SimCalorimeterHit*>( col->getElementAt( j ) ) ;
           // deal with timing aspects
-          std::vector<std::pair<float,float>> timeClusteredHits ; // vector of (time, energy)
-          if( _time_apply ) {
+          TimeSlices timeClusteredHits ; // (time, energy) per time slice
+          if( Effects & TimingEffect ) {
             timeClusteredHits = applyTimingCuts( simhit ) ;
           } 
           else { // just take full energy, assign to time 0
-            timeClusteredHits.push_back( std::pair<float,float>( 0, simhit->getEnergy() ) );
+            timeClusteredHits.push_back( 0.f, simhit->getEnergy() ) ;
           }
           // loop over all hits
-          for ( std::size_t jj=0 ; jj<timeClusteredHits.size() ; jj++ ) {
-            float hittime   = timeClusteredHits[jj].first ;
-            float energyDep = timeClusteredHits[jj].second ;
+          unsigned int jj = 0 ;
+          for ( const auto &timedEnergy : timeClusteredHits ) {
+            float hittime   = timedEnergy._time ;
+            float energyDep = timedEnergy._energy ;
             // apply extra energy digitisation onto the energy
-            float energyDig = energyDigi( eventData, energyDep ) ;
+            float energyDig = energyDigi<Technology, Effects>( eventData, technology, energyDep ) ;
 
   	        log<marlin::DEBUG0>() << " hit " << jj << " time: " << hittime << " eDep: " << energyDep << " eDigi: " << energyDig << " " << _threshold_value << std::endl ;
 
             if ( energyDig > _threshold_value ) { // write out this hit
-              IMPL::CalorimeterHitImpl* newhit = new IMPL::CalorimeterHitImpl() ;
+              IMPL::CalorimeterHitImpl* newhit = hitArena.create() ;
               newhit->setCellID0( simhit->getCellID0() ) ;
               newhit->setCellID1( simhit->getCellID1() ) ;
               newhit->setTime( hittime ) ;
               newhit->setPosition( simhit->getPosition() ) ;
   	          newhit->setEnergy( energyDig ) ;
-  	          int layer = idDecoder( simhit )[ _cellIDLayerString ] ;
+  	          int layer = layerField( simhit ) ;
   	          newhit->setType( CHT( cht_type, cht_id, cht_lay, layer ) ) ;
               newhit->setRawHit( simhit ) ;
               newcol->addElement( newhit ) ; // add hit to output collection
   	          log<marlin::DEBUG1>() << "orig/new hit energy: " << simhit->getEnergy() << " " << newhit->getEnergy() << std::endl ;
               // add a relation reco <-> sim
-              IMPL::LCRelationImpl *rel = new IMPL::LCRelationImpl( newhit, simhit, 1.0 ) ;
+              IMPL::LCRelationImpl *rel = relationArena.create( newhit, simhit, 1.0 ) ;
               relcol->addElement( rel ) ;
             } // threshold
+            ++jj ;
           } // time sliced hits
         } // input hits
-        // add collection to event
-        newcol->parameters().setValue( EVENT::LCIO::CellIDEncoding, initString );
-        evt->addCollection( newcol, _outputCollections.get()[i] );
-        // add relation collection to event
-        evt->addCollection( relcol, _outputRelCollections.get()[i] );
-      } 
-      catch(EVENT::DataNotAvailableException &e) {
-        log<marlin::DEBUG1>() << "Could not find input collection " << colName << std::endl;
-      }
+      } // input collections
+      // add collection to event
+      newcol->parameters().setValue( EVENT::LCIO::CellIDEncoding, initString );
+      evt->addCollection( newcol, _outputCollections.get()[i] );
+      // add relation collection to event
+      evt->addCollection( relcol, _outputRelCollections.get()[i] );
     }
     log<marlin::MESSAGE>() << "End of event " << evt->getEventNumber() << std::endl ;
   }
 
   //--------------------------------------------------------------------------
 
-  std::vector<std::pair<float,float>> RealisticCaloDigi::applyTimingCuts( const EVENT::SimCalorimeterHit * hit ) const {
+  RealisticCaloDigi::TimeSlices RealisticCaloDigi::applyTimingCuts( const EVENT::SimCalorimeterHit * hit ) const {
     // apply timing cuts on simhit contributions
-    //  outputs a vector of (time,energy) pairs
-    //  for now, only get one output hit per input hit, however we keep the possibility to have more
-    std::vector<std::pair<float,float>> timedhits ;
+    //  outputs one (time,energy) pair per time slice with contributions
+    TimeSlices timedhits ;
     float timeCorrection(0);
     if ( _time_correctForPropagation ) { // time of flight from IP to this point
       float r(0);
@@ -169,60 +265,79 @@ namespace marlinreco_mt {
     // this is Oskar's simple (and probably the most correct) method for treatment of timing
     //  - collect energy in some predefined time window around collision time (possibly corrected for TOF)
     //  - assign time of earliest contribution to hit
-    float energySum = 0.f ;
-    float earliestTime = std::numeric_limits<float>::max() ;
-    for(int i = 0; i<hit->getNMCContributions(); i++){ // loop over all contributions
-      float timei   = hit->getTimeCont(i) ; //absolute hit timing of current subhit
-      float energyi = hit->getEnergyCont(i) ; //energy of current subhit
-      float relativetime = timei - timeCorrection; // wrt time of flight
-      if (relativetime > _time_windowMin && relativetime < _time_windowMax ) {
-        energySum += energyi ;
-        if (relativetime < earliestTime){
-  	      earliestTime = relativetime; //use earliest hit time for simpletimingcut
+    // The window can be split in several slices, each of them treated the same way.
+    // The contributions are read by blocks in local arrays so that the slice
+    // accumulation loops are branch free
+    constexpr int blockSize = 64 ;
+    const unsigned int nSlices = _time_nSlices ;
+    const float windowMin = _time_windowMin ;
+    const float windowMax = _time_windowMax ;
+    const float sliceWidth = ( windowMax - windowMin ) / nSlices ;
+    std::array<float, MAXTIMESLICES> energySum {} ;
+    std::array<float, MAXTIMESLICES> earliestTime ;
+    earliestTime.fill( std::numeric_limits<float>::max() ) ;
+    float times[blockSize] ;
+    float energies[blockSize] ;
+    const int nContributions = hit->getNMCContributions() ;
+    for( int first = 0 ; first < nContributions ; first += blockSize ) {
+      const int n = std::min( blockSize, nContributions - first ) ;
+      for( int i=0 ; i<n ; i++ ) {
+        times[i]    = hit->getTimeCont( first+i ) - timeCorrection ; // wrt time of flight
+        energies[i] = hit->getEnergyCont( first+i ) ;
+      }
+      for( unsigned int s=0 ; s<nSlices ; s++ ) {
+        const float sliceMin = ( 0 == s ) ? windowMin : windowMin + s * sliceWidth ;
+        const float sliceMax = ( nSlices-1 == s ) ? windowMax : windowMin + (s+1) * sliceWidth ;
+        float sliceEnergy = energySum[s] ;
+        float sliceTime = earliestTime[s] ;
+        for( int i=0 ; i<n ; i++ ) {
+          // slice boundaries: first slice open at the window minimum, the others closed at their minimum
+          const bool inSlice = ( ( 0 == s ) ? ( times[i] > sliceMin ) : ( times[i] >= sliceMin ) ) && times[i] < sliceMax ;
+          sliceEnergy += inSlice ? energies[i] : 0.f ;
+          sliceTime = std::min( sliceTime, inSlice ? times[i] : std::numeric_limits<float>::max() ) ;
         }
+        energySum[s] = sliceEnergy ;
+        earliestTime[s] = sliceTime ;
+      }
+    }
+    //accept the slices with contributions
+    for( unsigned int s=0 ; s<nSlices ; s++ ) {
+      if( earliestTime[s] > windowMin && earliestTime[s] < windowMax ) {
+        timedhits.push_back( earliestTime[s], energySum[s] ) ;
       }
-    }      
-    //accept this hit ?
-    if( earliestTime > _time_windowMin && earliestTime < _time_windowMax ) { 
-      timedhits.push_back( std::pair<float,float> ( earliestTime, energySum ) ) ;
     }
     return timedhits ;
   }
 
   //--------------------------------------------------------------------------
 
-  float RealisticCaloDigi::energyDigi( EventData &evtdata, float energy ) const {
-    // some extra digi effects
-    // controlled by _applyDigi = 0 (none), 1 (apply)
+  template <typename Technology, unsigned int Effects>
+  float RealisticCaloDigi::energyDigi( EventData &evtdata, const Technology &technology, float energy ) const {
+    // some extra digi effects, the random ones compiled in only if enabled (see Effects)
     // input parameters: hit energy ( in any unit: effects are all relative )
-    //                   id0,1 - cell IDs (used to memorise miscalibrations/dead cells between events if requested)
-    // returns energy ( in units determined by the overloaded digitiseDetectorEnergy )
+    // returns energy ( in units determined by the technology digitiseDetectorEnergy )
 
-    // this is an overloaded method, provides energy in technology-dependent units
-    float e_out = digitiseDetectorEnergy( evtdata._generator, energy ) ;
+    // technology dependent units
+    float e_out = technology.digitiseDetectorEnergy( evtdata._generator, energy ) ;
     // the following make only relative changes to the energy
-    std::normal_distribution<float> miscalDistUncorrel( 1.0, _misCalib_uncorrel );
     // random miscalib, uncorrelated in cells
-    if ( _misCalib_uncorrel > 0 ) {
+    if ( Effects & MiscalibEffect ) {
+      std::normal_distribution<float> miscalDistUncorrel( 1.0, _misCalib_uncorrel );
       e_out *= miscalDistUncorrel( evtdata._generator ) ;
     }
-    // random miscalib, correlated across cells in one event
-    if ( _misCalib_correl > 0 ) {
-      e_out *= evtdata._eventCorrelMiscalib ;
-    }
-    // get MIP scale in local unit
-    float oneMipInMyUnits = convertEnergy( 1.0, EnergyScale::MIP ) ;
+    // random miscalib, correlated across cells in one event (1 if disabled)
+    e_out *= evtdata._eventCorrelMiscalib ;
     // limited electronics dynamic range
     if ( _elec_rangeMip > 0 ) {
-      e_out = std::min ( e_out, _elec_rangeMip * oneMipInMyUnits ) ;
+      e_out = std::min ( e_out, _elec_rangeMip * _oneMipInMyUnits ) ;
     }
     // add electronics noise
-    if ( _elec_noiseMip > 0 ) {
-      std::normal_distribution<float> gauss( 0., _elec_noiseMip * oneMipInMyUnits ) ;
+    if ( Effects & NoiseEffect ) {
+      std::normal_distribution<float> gauss( 0., _elec_noiseMip * _oneMipInMyUnits ) ;
       e_out += gauss( evtdata._generator ) ;
     }
     // random cell kill
-    if ( _deadCell_fraction > 0 ) {
+    if ( Effects & DeadCellEffect ) {
       std::uniform_real_distribution<float> flat(0., 1.) ;
       if ( flat( evtdata._generator ) < _deadCell_fraction ) { 
         e_out = 0 ;
@@ -231,6 +346,12 @@ namespace marlinreco_mt {
     return e_out;
   }
 
+  //--------------------------------------------------------------------------
+
+  // the technologies implemented in this package
+  template void RealisticCaloDigi::digitise<SiliconDigiTechnology>( EVENT::LCEvent *, const SiliconDigiTechnology & ) ;
+  template void RealisticCaloDigi::digitise<ScinPpdDigiTechnology>( EVENT::LCEvent *, const ScinPpdDigiTechnology & ) ;
+
 }
 
 
@@ -14,11 +14,12 @@ using namespace marlin::loglevel ;
 #include <IMPL/CalorimeterHitImpl.h>
 #include <IMPL/LCRelationImpl.h>
 #include <IMPL/LCFlagImpl.h>
-#include <UTIL/CellIDDecoder.h>
 #include <UTIL/LCRelationNavigator.h>
 
 // -- marlinrecomt headers
 #include <MarlinRecoMT/CalorimeterHitType.h>
+#include <MarlinRecoMT/CellIDFields.h>
+#include <MarlinRecoMT/EventArena.h>
 
 // -- std headers
 #include <iostream>
@@ -44,11 +45,21 @@ namespace marlinreco_mt {
      || _calibrationCoefficients.get().size() != _calibrationLayers.get().size() ) {
       marlin::ProcessorApi::abort( this, "Invalid parameters from steering file. Please check your inputs!" ) ;
     }
+    // calibration coefficient lookup table
+    int nLayers(0) ;
+    for( auto layers : _calibrationLayers.get() ) {
+      nLayers += int( layers ) ;
+    }
+    _layerCalibrations.clear() ;
+    for( int layer=0 ; layer<nLayers ; ++layer ) {
+      _layerCalibrations.push_back( getLayerCalib( layer ) ) ;
+    }
   }
   
   //--------------------------------------------------------------------------
 
-  void RealisticCaloReco::processEvent( EVENT::LCEvent *evt ) {
+  template <typename Technology>
+  void RealisticCaloReco::reconstruct( EVENT::LCEvent *evt, const Technology &technology ) {
     // common collection flags for all output collections
     IMPL::LCFlagImpl collectionFlag {} ;
     collectionFlag.setBit( EVENT::LCIO::CHBIT_LONG);
@@ -65,7 +76,7 @@ namespace marlinreco_mt {
         auto relationCollection = evt->getCollection( relName ) ;
         auto cellIDString = collection->getParameters().getStringVal( EVENT::LCIO::CellIDEncoding ) ;
         UTIL::LCRelationNavigator navigator( relationCollection ) ;
-        UTIL::CellIDDecoder<EVENT::CalorimeterHit> cellIDDecoder ( collection ) ;
+        const CellIDField layerField = CellIDFields::get( cellIDString )->field( _cellIDLayerString ) ;
         // create new collection
         auto outputCollection = std::make_unique<IMPL::LCCollectionVec>( EVENT::LCIO::CALORIMETERHIT ) ;
         outputCollection->setFlag( collectionFlag.getFlag() ) ;
@@ -77,14 +88,22 @@ namespace marlinreco_mt {
 
         int numElements = collection->getNumberOfElements();
         log<DEBUG>() << colName << " number of elements = " << numElements << std::endl ;
+        // one output hit and relation per input hit
+        outputCollection->reserve( numElements ) ;
+        relationOutputCollection->reserve( numElements ) ;
+        EventArena<IMPL::CalorimeterHitImpl> hitArena( numElements ) ;
+        EventArena<IMPL::LCRelationImpl> relationArena( numElements ) ;
 
         for ( int j=0 ; j<numElements ; ++j ) {
           auto hit = static_cast<EVENT::CalorimeterHit*>( collection->getElementAt( j ) ) ;
           // make new hit
-        	auto newhit = new IMPL::CalorimeterHitImpl(); 
+        	auto newhit = hitArena.create() ;
         	newhit->setCellID0( hit->getCellID0() ) ;
         	newhit->setCellID1( hit->getCellID1() ) ;
-        	newhit->setEnergy( this->reconstructEnergy( cellIDDecoder, hit ) ) ; // overloaded method, technology dependent
+          // technology dependent energy to MIP, then correct for sampling fraction (calibration from MIP -> shower GeV)
+          const int layer = layerField( hit ) ;
+          const float layerCalibration = ( layer >= 0 && layer < int(_layerCalibrations.size()) ) ? _layerCalibrations[layer] : 0.f ;
+        	newhit->setEnergy( technology.reconstructEnergy( hit->getEnergy() ) * layerCalibration ) ;
         	newhit->setRawHit( hit->getRawHit() ) ;
         	newhit->setTime( hit->getTime() ) ;
         	newhit->setPosition( hit->getPosition() ) ;
@@ -95,7 +114,7 @@ namespace marlinreco_mt {
         	if ( not relatedObjects.empty() ) {
         	  auto simhit = static_cast<EVENT::SimCalorimeterHit*>( relatedObjects[0] ); // assume the first one (should be only one)
         	  // make a relation, add to collection - keep relations from reco to sim hits
-        	  relationOutputCollection->addElement( new IMPL::LCRelationImpl( newhit , simhit , 1.0 ) ) ;
+        	  relationOutputCollection->addElement( relationArena.create( newhit , simhit , 1.0 ) ) ;
         	} 
           else {
         	  log<WARNING>() << "could not find relation to sim calo hit!" << std::endl ;
@@ -132,5 +151,11 @@ namespace marlinreco_mt {
     return calibrationCoefficient ;
   }
   
+  //--------------------------------------------------------------------------
+
+  // the technologies implemented in this package
+  template void RealisticCaloReco::reconstruct<SiliconRecoTechnology>( EVENT::LCEvent *, const SiliconRecoTechnology & ) ;
+  template void RealisticCaloReco::reconstruct<ScinPpdRecoTechnology>( EVENT::LCEvent *, const ScinPpdRecoTechnology & ) ;
+
 }
 
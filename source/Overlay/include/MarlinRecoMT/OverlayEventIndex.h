@@ -0,0 +1,96 @@
+#ifndef MARLINRECOMT_OVERLAYEVENTINDEX_H
+#define MARLINRECOMT_OVERLAYEVENTINDEX_H 1
+
+// -- std headers
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace marlinreco_mt {
+
+  /**
+   *  @brief  OverlayEventIndex class
+   *          Persistent (run, event) index of an LCIO file, stored in a sidecar file
+   *          next to the LCIO file (see indexFileName()). The sidecar file is validated
+   *          against the LCIO file size, modification time (with nanoseconds) and inode
+   *          and memory mapped read-only,
+   *          so that the index pages are shared by all the threads and processes using it.
+   *
+   *          Sidecar file layout (native endianness):
+   *          - header: magic "MRMTEIDX", version (uint32), reserved (uint32),
+   *            LCIO file size (uint64), LCIO file mtime seconds (int64) and nanoseconds (int64),
+   *            LCIO file inode (uint64), number of events (uint64)
+   *          - entries: number of events x (run number (int32), event number (int32))
+   */
+  class OverlayEventIndex {
+  public:
+    /// The sidecar file format version
+    static constexpr std::uint32_t Version = 2 ;
+
+  public:
+    OverlayEventIndex( const OverlayEventIndex& ) = delete ;
+    OverlayEventIndex& operator=( const OverlayEventIndex& ) = delete ;
+    ~OverlayEventIndex() ;
+
+    /**
+     *  @brief  Get the sidecar index file name of an LCIO file
+     *
+     *  @param  fileName the LCIO file name
+     */
+    static std::string indexFileName( const std::string &fileName ) ;
+
+    /**
+     *  @brief  Map the sidecar index file of an LCIO file.
+     *          Returns nullptr if the index file doesn't exist or is not valid for the LCIO file
+     *
+     *  @param  fileName the LCIO file name
+     */
+    static std::shared_ptr<const OverlayEventIndex> load( const std::string &fileName ) ;
+
+    /**
+     *  @brief  Write the sidecar index file of an LCIO file. The file is first written
+     *          in a temporary file and then renamed, so that concurrent readers never see a
+     *          partial index. Returns false if the index file could not be written
+     *
+     *  @param  fileName the LCIO file name
+     *  @param  eventMap the run and event numbers as returned by LCReader::getEvents()
+     */
+    static bool write( const std::string &fileName, const std::vector<int> &eventMap ) ;
+
+    /**
+     *  @brief  Get the number of events in the index
+     */
+    std::size_t size() const ;
+
+    /**
+     *  @brief  Get the run number at the specified index
+     *
+     *  @param  index the nth event
+     */
+    int runNumber( std::size_t index ) const ;
+
+    /**
+     *  @brief  Get the event number at the specified index
+     *
+     *  @param  index the nth event
+     */
+    int eventNumber( std::size_t index ) const ;
+
+  private:
+    OverlayEventIndex() = default ;
+
+  private:
+    /// The mapped memory region
+    void                       *_mapping {nullptr} ;
+    /// The size of the mapped memory region
+    std::size_t                 _mappingSize {0} ;
+    /// The (run, event) entries in the mapped region
+    const std::int32_t         *_entries {nullptr} ;
+    /// The number of events in the index
+    std::size_t                 _nEvents {0} ;
+  };
+
+}
+
+#endif
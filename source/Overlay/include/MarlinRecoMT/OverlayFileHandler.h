@@ -10,10 +10,17 @@
 #include <EVENT/LCEvent.h>
 #include <MT/LCReader.h>
 
+// -- marlinrecomt headers
+#include <MarlinRecoMT/OverlayEventIndex.h>
+
 namespace marlinreco_mt {
 
   /**
    *  @brief  OverlayFileHandler class
+   *          The run and event numbers of the file are read from the sidecar
+   *          event index file if available (see OverlayEventIndex), so that the
+   *          LCIO file is only opened on the first event read. If not available,
+   *          the index file is created on first use.
    */
   class OverlayFileHandler {
     using FileReader = MT::LCReader ;
@@ -30,6 +37,13 @@ namespace marlinreco_mt {
      *  @param  fname the name of the LCIO file
      */
     void setFileName(const std::string& fname) ;
+
+    /**
+     *  @brief  Whether to use (and create if needed) the sidecar event index file. Default true
+     *
+     *  @param  use whether to use the event index file
+     */
+    void setUseEventIndex(bool use) ;
     
     /**
      *  @brief  Get the number of events available in the file
@@ -64,11 +78,22 @@ namespace marlinreco_mt {
      */
     void openFile() ;
 
+    /**
+     *  @brief  Proxy method to load the event index, from the sidecar file or from the LCIO file
+     */
+    void openIndex() ;
+
   private:
     /// The LCIO file reader
     std::shared_ptr<FileReader>                    _lcReader {nullptr} ;   
-    /// The run and event number map
+    /// The run and event number map, if no event index file is used
     std::vector<int>                               _eventMap {} ; 
+    /// The mapped event index file
+    std::shared_ptr<const OverlayEventIndex>       _eventIndex {nullptr} ;
+    /// Whether to use the event index file
+    bool                                           _useEventIndex {true} ;
+    /// Whether the event index was loaded or the file scanned
+    bool                                           _indexed {false} ;
     /// The LCIO file name
     std::string                                    _fileName {} ;
   };
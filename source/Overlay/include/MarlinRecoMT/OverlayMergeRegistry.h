@@ -0,0 +1,69 @@
+#ifndef MARLINRECOMT_OVERLAYMERGEREGISTRY_H
+#define MARLINRECOMT_OVERLAYMERGEREGISTRY_H 1
+
+// -- std headers
+#include <string>
+#include <unordered_map>
+#include <functional>
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+
+// -- marlinrecomt headers
+#include <MarlinRecoMT/OverlayMerging.h>
+
+namespace marlinreco_mt {
+
+  /**
+   *  @brief  OverlayMergeRegistry class
+   *          Registry of collection merge functions used by Overlay processors.
+   *          The merge functions are registered per collection type at construction:
+   *          - MCParticle: see OverlayMerging::mergeMCParticleCollections()
+   *          - SimCalorimeterHit: see OverlayMerging::mergeSimCalorimeterHitCollections()
+   *          - CalorimeterHit: see OverlayMerging::mergeCalorimeterHitCollections()
+   *          - SimTrackerHit and any other type: see OverlayMerging::spliceCollections()
+   *          The merge functions of the (source, destination) collection pairs are resolved
+   *          once in a merge plan, see OverlayMerging::createMergePlan().
+   */
+  class OverlayMergeRegistry {
+  public:
+    using MergeFunction = OverlayMerging::MergeFunction ;
+
+  public:
+    OverlayMergeRegistry( const OverlayMergeRegistry& ) = delete ;
+    OverlayMergeRegistry& operator=( const OverlayMergeRegistry& ) = delete ;
+
+    /**
+     *  @brief  Constructor
+     *
+     *  @param  contributionTimeWindow the SimCalorimeterHit contribution time window
+     *          (see OverlayMerging::mergeCollections()). Negative to disable
+     */
+    OverlayMergeRegistry( float contributionTimeWindow = -1.f ) ;
+
+    /**
+     *  @brief  Register (or replace) the merge function for a collection type
+     *
+     *  @param  type the collection type
+     *  @param  function the merge function
+     */
+    void registerFunction( const std::string &type, MergeFunction function ) ;
+
+    /**
+     *  @brief  Get the merge function of a collection type.
+     *          Returns the generic splice function if the type is not registered
+     *
+     *  @param  type the collection type
+     */
+    const MergeFunction &function( const std::string &type ) const ;
+
+  private:
+    /// The merge functions per collection type
+    std::unordered_map<std::string, MergeFunction>                               _typeFunctions {} ;
+    /// The merge function used for unregistered types
+    MergeFunction                                                                _defaultFunction {} ;
+  };
+
+}
+
+#endif
@@ -4,6 +4,9 @@
 // -- std headers
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <vector>
+#include <functional>
 
 // -- lcio headers
 #include <EVENT/LCEvent.h>
@@ -11,6 +14,8 @@
 
 namespace marlinreco_mt {
 
+  class OverlayMergeRegistry ;
+
   /**
    *  @brief  OverlayMerging class
    *          Helper class to merge collections for Overlay processors
@@ -20,48 +25,112 @@ namespace marlinreco_mt {
     OverlayMerging() = delete ;
   public:
     using CollectionMap = std::map<std::string, std::string> ;
+    using MergeFunction = std::function<void( EVENT::LCCollection*, EVENT::LCCollection* )> ;
+
+    /**
+     *  @brief  MergeEntry struct
+     *          A resolved collection merge: source and destination collection names and merge function
+     */
+    struct MergeEntry {
+      std::string           _srcName {} ;
+      std::string           _dstName {} ;
+      const MergeFunction  *_function {nullptr} ;
+    };
+
+    /**
+     *  @brief  MergePlan struct
+     *          The merge entries in merging order, indexed by source collection name
+     *          (the collection map has one entry per source collection)
+     */
+    struct MergePlan {
+      std::vector<MergeEntry>                          _entries {} ;
+      std::unordered_map<std::string, std::size_t>     _index {} ;
+    };
 
   public:
     /**
-     *  @brief  Merge two events. Only collections appearing in both events are merged
-     *  
+     *  @brief  Resolve a merge plan from a sample source event. Only the collections of the
+     *          map appearing in the sample event are kept. If the map is empty, all the
+     *          collections of the sample event are merged in a collection with the same name.
+     *          Collections from the exclude list are removed from the plan
+     *
+     *  @param  sample the sample source event
+     *  @param  mergeMap the map of collection to merge
+     *  @param  excludeCollections the list of source collections to exclude
+     *  @param  registry the merge function registry
+     */
+    static MergePlan createMergePlan( const EVENT::LCEvent *sample, const CollectionMap &mergeMap, const std::vector<std::string> &excludeCollections, const OverlayMergeRegistry &registry ) ;
+
+    /**
+     *  @brief  Add to a merge plan the collections of the sample event that are not planned yet,
+     *          with the same rules as createMergePlan(). Returns the number of added entries.
+     *          Use it for every source event: a collection missing in the first sample event
+     *          of a file may appear in later events
+     *
+     *  @param  plan the merge plan to extend
+     *  @param  sample the sample source event
+     *  @param  mergeMap the map of collection to merge
+     *  @param  excludeCollections the list of source collections to exclude
+     *  @param  registry the merge function registry
+     */
+    static unsigned int extendMergePlan( MergePlan &plan, const EVENT::LCEvent *sample, const CollectionMap &mergeMap, const std::vector<std::string> &excludeCollections, const OverlayMergeRegistry &registry ) ;
+
+    /**
+     *  @brief  Merge two events using a resolved merge plan (see createMergePlan()).
+     *          Collections of the plan missing in the source event are skipped.
+     *          If the collection doesn't exists in the destination event, a new collection
+     *          is added
+     *
      *  @param  src the source event
      *  @param  dst the destination event
+     *  @param  plan the resolved merge plan
      */
-    static void mergeEvents( const EVENT::LCEvent *src, EVENT::LCEvent *dst ) ;
+    static void mergeEvents( const EVENT::LCEvent *src, EVENT::LCEvent *dst, const MergePlan &plan ) ;
 
     /**
-     *  @brief  Merge two events. Only the collections appearing in the provided map
-     *          are merged, if of course they appear at least in the source event.
-     *          If the collection doesn't exists in the destination event, a new collection 
-     *          is added 
-     *  
+     *  @brief  Merge two events. Only collections appearing in both events are merged
+     *
      *  @param  src the source event
      *  @param  dst the destination event
-     *  @param  mergeMap the map of collection to merge
      */
-    static void mergeEvents( const EVENT::LCEvent *src, EVENT::LCEvent *dst, const CollectionMap &mergeMap ) ;
+    static void mergeEvents( const EVENT::LCEvent *src, EVENT::LCEvent *dst ) ;
 
     /**
-     *  @brief  Merge two collections. The merging strategy differs depending 
+     *  @brief  Merge two collections. The merging strategy differs depending
      *          on the collection type:
      *          - CalorimeterHit: hit energies are added
      *          - SimCalorimeterHit: MCContributions are added
-     *          - MCParticle: mc particles are added to the destination colelction and flagged as 'overlay' 
-     *          For any other collection types, the element are moved from one 
+     *          - MCParticle: mc particles are added to the destination colelction and flagged as 'overlay'
+     *          For any other collection types, the element are moved from one
      *          collection to the other.
-     * 
+     *          SimCalorimeterHit MC contributions are moved (not copied) to the destination hit.
+     *          If contributionTimeWindow is positive, the contributions of each source hit coming
+     *          from the same MCParticle with the same PDG within this time window (ns) are collapsed
+     *          into a single contribution: the energies are summed, the earliest time is kept, and the
+     *          step position and length are the ones of the first contribution. Only use it if the
+     *          downstream digitizer uses energy sums in time windows (see RealisticCaloDigi::applyTimingCuts()).
+     *
      *  @param  src the source collection
      *  @param  dst the destination collection
+     *  @param  contributionTimeWindow the SimCalorimeterHit contribution time window. Zero or negative to disable
      */
-    static void mergeCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) ;
+    static void mergeCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst, float contributionTimeWindow = -1.f ) ;
 
-  private:
     // Collection merging for different collection types
     static void mergeMCParticleCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) ;
-    static void mergeSimCalorimeterHitCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) ;  
+    static void mergeSimCalorimeterHitCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst, float contributionTimeWindow ) ;
     static void mergeCalorimeterHitCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) ;
     static void mergeAnyCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) ;
+
+    /**
+     *  @brief  Move all the elements of the source collection at the end of the destination
+     *          collection in one go, in reverse order as mergeAnyCollections(). Falls back on
+     *          mergeAnyCollections() if the collections are not LCCollectionVec
+     *
+     *  @param  src the source collection
+     *  @param  dst the destination collection
+     */
+    static void spliceCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) ;
   };
 
 }
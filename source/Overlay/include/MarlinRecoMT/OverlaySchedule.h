@@ -0,0 +1,88 @@
+#ifndef MARLINRECOMT_OVERLAYSCHEDULE_H
+#define MARLINRECOMT_OVERLAYSCHEDULE_H 1
+
+// -- std headers
+#include <string>
+#include <vector>
+
+namespace marlinreco_mt {
+
+  /**
+   *  @brief  OverlaySchedule class
+   *          Pre-drawn list of background event indices to overlay on physics events.
+   *          The schedule holds a fixed number of entries. The entry of a physics event
+   *          is keyed on its (run, event) numbers, independently of the order in which the
+   *          events are processed: within a run, consecutive event numbers use consecutive
+   *          entries, starting at an offset drawn from the run number, so that runs or files
+   *          which all start their event numbering at 0 don't reuse the same background
+   *          events. Only events with the same (run, event) numbers always share an entry.
+   *          The background indices of each entry
+   *          are sorted so that the events are read in file order.
+   *          A schedule can be exported to a text file and read back to replay exactly
+   *          the same overlay (one line per entry: the background event indices).
+   */
+  class OverlaySchedule {
+  public:
+    using Entry = std::vector<unsigned int> ;
+
+  public:
+    /**
+     *  @brief  Draw a new schedule. Throws if there is no background event available
+     *
+     *  @param  nEntries the number of entries to draw
+     *  @param  seed the random seed
+     *  @param  nFixed the fixed number of background events per entry
+     *  @param  expBG the expectation value of the additional poisson distributed number of events. Negative to disable
+     *  @param  nAvailableEvents the total number of available background events
+     */
+    void generate( unsigned int nEntries, unsigned int seed, unsigned int nFixed, double expBG, unsigned int nAvailableEvents ) ;
+
+    /**
+     *  @brief  Read the schedule from a text file. Throws on failure, or if
+     *          a background event index is not below nAvailableEvents
+     *
+     *  @param  fileName the schedule file name
+     *  @param  nAvailableEvents the total number of available background events
+     */
+    void read( const std::string &fileName, unsigned int nAvailableEvents ) ;
+
+    /**
+     *  @brief  Write the schedule to a text file. Throws on failure
+     *
+     *  @param  fileName the schedule file name
+     */
+    void write( const std::string &fileName ) const ;
+
+    /**
+     *  @brief  Whether the schedule has no entry
+     */
+    bool empty() const ;
+
+    /**
+     *  @brief  Get the number of entries
+     */
+    unsigned int size() const ;
+
+    /**
+     *  @brief  Get the schedule entry of a physics event
+     *
+     *  @param  runNumber the physics event run number
+     *  @param  eventNumber the physics event number
+     */
+    const Entry &entry( int runNumber, int eventNumber ) const ;
+
+    /**
+     *  @brief  Get the number of times each background event is used in the schedule
+     *
+     *  @param  nAvailableEvents the total number of available background events
+     */
+    std::vector<unsigned int> usageCounts( unsigned int nAvailableEvents ) const ;
+
+  private:
+    /// The schedule entries
+    std::vector<Entry>          _entries {} ;
+  };
+
+}
+
+#endif
@@ -1,6 +1,8 @@
 // -- marlin reco headers
 #include <MarlinRecoMT/OverlayFileHandler.h>
 #include <MarlinRecoMT/OverlayMerging.h>
+#include <MarlinRecoMT/OverlayMergeRegistry.h>
+#include <MarlinRecoMT/OverlaySchedule.h>
 
 // -- marlin headers
 #include <marlin/Processor.h>
@@ -11,6 +13,8 @@ using namespace marlin::loglevel ;
 
 // -- std headers
 #include <random>
+#include <memory>
+#include <algorithm>
 
 namespace marlinreco_mt {
 
@@ -21,6 +25,9 @@ namespace marlinreco_mt {
    *  with a number drawn from a poissonian distribution with a given mean 'expBG' (NumberOverlayEvents=0).
    *
    *  See Merger.cc for the collection types that can be merged.
+   *  The collections to merge and their merge functions are resolved once per input file
+   *  and collection, the plan of a file is extended when a background event contains mapped
+   *  collections not seen before in this file (see OverlayMerging::extendMergePlan()).
    * 
    * @author N. Chiapolini, DESY
    * @author F. Gaede, DESY
@@ -42,6 +49,19 @@ namespace marlinreco_mt {
    * @param ExcludeCollectionMap (StringVec) List of collection to exclude for merging. This is particularly useful when you just want to exclude a few collections.
    *                                   One doesn't have to specify all collections to overlay in the CollectionMap parameter minus the collection to avoid, 
    *                                   but just the ones to exclude. Priority is given to this list over the CollectionMap.                             
+   * @param UseEventIndex (bool)     Whether to read the run and event numbers of the input files from sidecar index files 
+   *                                   (<file>.evtidx, see OverlayEventIndex), created on first use. The input files are then only 
+   *                                   opened on the first event read instead of at initialization. (default true)
+   * @param SimCaloHitContributionTimeWindow (float) If positive, the SimCalorimeterHit MC contributions of the background events coming from the 
+   *                                   same MCParticle with the same PDG within this time window (ns) are collapsed into a single contribution 
+   *                                   before merging: the energies are summed, the earliest time is kept, the step position and length of the 
+   *                                   other contributions are lost. Only use it if the calorimeter digitizer only uses energy sums in a time window.
+   * @param ScheduleSize (int)         If positive, the background events to overlay are not drawn per event but pre-drawn at initialization 
+   *                                   in a schedule of this size, using ScheduleSeed, NumberOverlayEvents and expBG (see OverlaySchedule). 
+   *                                   The schedule entry of a physics event is keyed on its run and event numbers (see OverlaySchedule). (default 0)
+   * @param ScheduleSeed (int)         The random seed used to draw the schedule. (default 0)
+   * @param ScheduleInputFile (string) If set, the schedule is read from this file instead of being drawn.
+   * @param ScheduleOutputFile (string) If set, the schedule is written to this file at initialization, e.g. to replay the same overlay.
    */
   class OverlayProcessor : public marlin::Processor {
     using RandomGenerator = std::mt19937 ;
@@ -61,8 +81,16 @@ namespace marlinreco_mt {
     void processEvent( EVENT::LCEvent * evt ) override ;
 
   private:
-    /// Randomly read the next event from the available file
-    std::shared_ptr<EVENT::LCEvent> readNextEvent( RandomGenerator &generator ) ;
+    /// Randomly read the next event from the available file. Set the index of the file the event was read from
+    std::shared_ptr<EVENT::LCEvent> readNextEvent( RandomGenerator &generator, unsigned int &fileIndex ) ;
+    /// Read the event at the given index among all files. Set the index of the file the event was read from
+    std::shared_ptr<EVENT::LCEvent> readEvent( unsigned int eventIndex, unsigned int &fileIndex ) ;
+    /// Prepare the background event schedule
+    void initSchedule() ;
+    /// Merge the background event in the physics event and record its ids
+    void overlayEvent( const std::shared_ptr<EVENT::LCEvent> &overlayEvent, unsigned int fileIndex, EVENT::LCEvent *evt, EVENT::FloatVec &eventIDs, EVENT::FloatVec &runIDs ) ;
+    /// Get the merge plan of a file. Resolved with the first event read from the file
+    const OverlayMerging::MergePlan &getMergePlan( unsigned int fileIndex, const EVENT::LCEvent *sample ) ;
     /// Get the number of available events in all files
     unsigned int getNAvailableEvents() ;
 
@@ -82,12 +110,36 @@ namespace marlinreco_mt {
         
     marlin::Property<std::vector<std::string>> _excludeCollections {this, "ExcludeCollections" , 
         "List of collections to exclude for merging" } ;
+
+    marlin::Property<bool> _useEventIndex {this, "UseEventIndex" , 
+        "Whether to read the run/event numbers of the input files from sidecar index files (<file>.evtidx), created on first use" , true } ;
+
+    marlin::Property<float> _contributionTimeWindow {this, "SimCaloHitContributionTimeWindow" , 
+        "Time window (ns) in which the SimCalorimeterHit contributions from the same MCParticle and PDG are collapsed (energy summed, earliest time kept, step positions of the collapsed contributions dropped). Zero or negative to disable" , -1.f } ;
+
+    marlin::Property<int> _scheduleSize {this, "ScheduleSize" , 
+        "Size of the pre-drawn background event schedule. 0 to draw the background events per event" , 0 } ;
+
+    marlin::Property<int> _scheduleSeed {this, "ScheduleSeed" , 
+        "Random seed used to draw the background event schedule" , 0 } ;
+
+    marlin::Property<std::string> _scheduleInputFile {this, "ScheduleInputFile" , 
+        "Read the background event schedule from this file instead of drawing it" , "" } ;
+
+    marlin::Property<std::string> _scheduleOutputFile {this, "ScheduleOutputFile" , 
+        "Write the background event schedule to this file" , "" } ;
     
     // internal members
     /// The total number of available overlay events from input files
     unsigned int                          _nAvailableEvents {0} ;     
-    /// The map of collections to overlay, built from _overlayCollections
+    /// The map of collections to overlay, built from _overlayCollections. Empty to overlay all collections
     std::map<std::string, std::string>    _overlayCollectionMap {} ;  
+    /// The resolved merge plans, one per input file
+    std::vector<std::unique_ptr<OverlayMerging::MergePlan>> _mergePlans {} ;
+    /// The event parameter names, built once from the processor name
+    std::string                           _nEventsParameter {} ;
+    std::string                           _eventIDsParameter {} ;
+    std::string                           _runIDsParameter {} ;
     /// The total number of processed runs
     int                                   _nRun {0} ;                 
     /// The total number of processed events
@@ -96,6 +148,10 @@ namespace marlinreco_mt {
     int                                   _nTotalOverlayEvents {0} ;  
     /// The list of file handler to manage overlay input files (see LCFileHandler class)
     OverlayFileHandlerList                _fileHandlerList {} ;     
+    /// The collection merge function registry
+    std::unique_ptr<OverlayMergeRegistry> _mergeRegistry {nullptr} ;
+    /// The pre-drawn background event schedule. Empty if not used
+    OverlaySchedule                       _schedule {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -121,6 +177,7 @@ namespace marlinreco_mt {
     
     for ( unsigned int i=0 ; i<_fileNames.get().size() ; i++ ) {
       _fileHandlerList.at( i ).setFileName( _fileNames.get().at( i ) ) ;
+      _fileHandlerList.at( i ).setUseEventIndex( _useEventIndex ) ;
     }
   
     // initalisation of random number generator
@@ -137,83 +194,124 @@ namespace marlinreco_mt {
       ++iter ;
       _overlayCollectionMap[key] = *iter ;
     }
+    // no collection map means all collections
+    if ( not parameterSet("CollectionMap") ) {
+      _overlayCollectionMap.clear() ;
+    }
+    _mergePlans.resize( _fileHandlerList.size() ) ;
+    
+    // event parameter names
+    _nEventsParameter = "Overlay." + this->name() + ".nEvents" ;
+    _eventIDsParameter = "Overlay." + this->name() + ".eventIDs" ;
+    _runIDsParameter = "Overlay." + this->name() + ".runIDs" ;
+    
+    // register the collection merge functions
+    _mergeRegistry = std::make_unique<OverlayMergeRegistry>( _contributionTimeWindow ) ;
     
     _nAvailableEvents = getNAvailableEvents() ;
     log<MESSAGE>() << "Overlay::modifyEvent: total number of available events to overlay: " << _nAvailableEvents << std::endl ;
+    
+    initSchedule() ;
+  }
+  
+  //--------------------------------------------------------------------------
+  
+  void OverlayProcessor::initSchedule() {
+    try {
+      if ( not _scheduleInputFile.get().empty() ) {
+        _schedule.read( _scheduleInputFile.get(), _nAvailableEvents ) ;
+        log<MESSAGE>() << "Overlay schedule read from " << _scheduleInputFile.get() << ", " << _schedule.size() << " entries" << std::endl ;
+      }
+      else if ( _scheduleSize > 0 ) {
+        const double expBG = parameterSet("expBG") ? _expBG.get() : -1. ;
+        _schedule.generate( _scheduleSize, _scheduleSeed, _numOverlay, expBG, _nAvailableEvents ) ;
+        log<MESSAGE>() << "Overlay schedule drawn with seed " << _scheduleSeed.get() << ", " << _schedule.size() << " entries" << std::endl ;
+      }
+      if ( not _scheduleOutputFile.get().empty() ) {
+        _schedule.write( _scheduleOutputFile.get() ) ;
+      }
+    }
+    catch ( std::exception &e ) {
+      marlin::ProcessorApi::abort( this, e.what() ) ;
+    }
+    if ( _schedule.empty() ) {
+      // an empty schedule would silently fall back on drawing the background events per event
+      if ( not _scheduleInputFile.get().empty() or _scheduleSize > 0 ) {
+        marlin::ProcessorApi::abort( this, "The overlay schedule is empty" ) ;
+      }
+      return ;
+    }
+    // background event usage over the schedule
+    const auto counts = _schedule.usageCounts( _nAvailableEvents ) ;
+    const auto nUsed = std::count_if( counts.begin(), counts.end(), []( unsigned int c ){ return c > 0 ; } ) ;
+    const auto maxUsage = counts.empty() ? 0 : *std::max_element( counts.begin(), counts.end() ) ;
+    log<MESSAGE>() << "Overlay schedule: " << nUsed << " / " << _nAvailableEvents 
+                   << " background events used, max usage of one event: " << maxUsage << std::endl ;
   }
 
   //--------------------------------------------------------------------------
 
   void OverlayProcessor::processEvent( EVENT::LCEvent * evt ) {
-    // initalisation of random number generator
-    auto eventSeed = marlin::ProcessorApi::getRandomSeed( this, evt ) ;
-    // local random number generator
-    RandomGenerator generator {} ;
-    generator.seed( eventSeed ) ;
-    std::poisson_distribution<int> poissonDistribution { _expBG } ;
-    // number of bkg events to overlay
-    unsigned int nEventsToOverlay = _numOverlay ;
-    if ( parameterSet("expBG") ) {
-      nEventsToOverlay += poissonDistribution( generator ) ;
-    }
-    log<DEBUG6>() << "** Processing event nr " << evt->getEventNumber() << " run " <<  evt->getRunNumber() 
-     			    << "\n**  overlaying " << nEventsToOverlay << " background events. \n " 
-			    << " ( seeded CLHEP::HepRandom with seed = " << eventSeed  << ") " 
-			    << std::endl ;
-  
     int nOverlaidEvents(0) ;
     EVENT::FloatVec overlaidEventIDs, overlaidRunIDs ;
     
-    for(unsigned int i=0 ; i < nEventsToOverlay ; i++ ) {
-
-      auto overlayEvent = readNextEvent( generator ) ;
-
-      if( nullptr == overlayEvent ) {
-	       log<ERROR>() << "loop: " << i << " ++++++++++ Nothing to overlay +++++++++++ \n " ;
-	       continue ;
-      } 
-      
-      overlaidEventIDs.push_back( overlayEvent->getEventNumber() );
-      overlaidRunIDs.push_back( overlayEvent->getRunNumber() );
-      
-      ++nOverlaidEvents ;
-
-      log<DEBUG6>() << "loop: " << i << " will overlay event " << overlayEvent->getEventNumber() << " - run " << overlayEvent->getRunNumber() << std::endl ;
-
-      std::map<std::string, std::string> collectionMap;
-      
-      if ( ( _overlayCollectionMap.empty() || ! parameterSet("CollectionMap") ) ) {
-        auto collectionNames = overlayEvent->getCollectionNames();
-        for ( auto collection : *collectionNames ) {
-          collectionMap[collection] = collection;
-          log<DEBUG6>() << "Collection map -> " << collection << std::endl;
+    if ( not _schedule.empty() ) {
+      // read the scheduled background events, in file order
+      const auto &entry = _schedule.entry( evt->getRunNumber(), evt->getEventNumber() ) ;
+      log<DEBUG6>() << "** Processing event nr " << evt->getEventNumber() << " run " <<  evt->getRunNumber() 
+                    << "\n**  overlaying " << entry.size() << " scheduled background events." << std::endl ;
+      for ( auto eventIndex : entry ) {
+        unsigned int fileIndex(0) ;
+        auto overlayEvent = readEvent( eventIndex, fileIndex ) ;
+        if( nullptr == overlayEvent ) {
+          log<ERROR>() << "index: " << eventIndex << " ++++++++++ Nothing to overlay +++++++++++ \n " ;
+          continue ;
         }
+        ++nOverlaidEvents ;
+        this->overlayEvent( overlayEvent, fileIndex, evt, overlaidEventIDs, overlaidRunIDs ) ;
       }
-      else {
-        collectionMap = _overlayCollectionMap ;
+    }
+    else {
+      // initalisation of random number generator
+      auto eventSeed = marlin::ProcessorApi::getRandomSeed( this, evt ) ;
+      // local random number generator
+      RandomGenerator generator {} ;
+      generator.seed( eventSeed ) ;
+      std::poisson_distribution<int> poissonDistribution { _expBG } ;
+      // number of bkg events to overlay
+      unsigned int nEventsToOverlay = _numOverlay ;
+      if ( parameterSet("expBG") ) {
+        nEventsToOverlay += poissonDistribution( generator ) ;
       }
+      log<DEBUG6>() << "** Processing event nr " << evt->getEventNumber() << " run " <<  evt->getRunNumber() 
+                    << "\n**  overlaying " << nEventsToOverlay << " background events. \n " 
+                    << " ( seeded CLHEP::HepRandom with seed = " << eventSeed  << ") " 
+                    << std::endl ;
       
-      // Remove collections to exclude from the collection map
-      if(not _excludeCollections.get().empty()) {
-        for ( auto excludeCol : _excludeCollections.get() ) {
-          auto findIter = collectionMap.find( excludeCol );
-          if( collectionMap.end() != findIter ) {
-            collectionMap.erase( findIter );
-          }
-        }
+      for(unsigned int i=0 ; i < nEventsToOverlay ; i++ ) {
+
+        unsigned int fileIndex(0) ;
+        auto overlayEvent = readNextEvent( generator, fileIndex ) ;
+
+        if( nullptr == overlayEvent ) {
+          log<ERROR>() << "loop: " << i << " ++++++++++ Nothing to overlay +++++++++++ \n " ;
+          continue ;
+        } 
+        
+        ++nOverlaidEvents ;
+
+        log<DEBUG6>() << "loop: " << i << " will overlay event " << overlayEvent->getEventNumber() << " - run " << overlayEvent->getRunNumber() << std::endl ;
+
+        this->overlayEvent( overlayEvent, fileIndex, evt, overlaidEventIDs, overlaidRunIDs ) ;
       }
-	     OverlayMerging::mergeEvents( overlayEvent.get(), evt, collectionMap );
     }
     
     _nTotalOverlayEvents += nOverlaidEvents ;
     
     // Write info to event parameters
-    std::string paramName = "Overlay." + this->name() + ".nEvents" ;
-    evt->parameters().setValue(paramName, nOverlaidEvents) ;
-    paramName = "Overlay." + this->name() + ".eventIDs" ;
-    evt->parameters().setValues(paramName, overlaidEventIDs) ;
-    paramName = "Overlay." + this->name() + ".runIDs" ;
-    evt->parameters().setValues(paramName, overlaidRunIDs) ;
+    evt->parameters().setValue(_nEventsParameter, nOverlaidEvents) ;
+    evt->parameters().setValues(_eventIDsParameter, overlaidEventIDs) ;
+    evt->parameters().setValues(_runIDsParameter, overlaidRunIDs) ;
     int totalOverlay = 0 ;
     try {
       // for now: returns 0 if the key doesn't exists.
@@ -227,13 +325,28 @@ namespace marlinreco_mt {
 
   //--------------------------------------------------------------------------
 
-  std::shared_ptr<EVENT::LCEvent> OverlayProcessor::readNextEvent( RandomGenerator &generator ) {
+  void OverlayProcessor::overlayEvent( const std::shared_ptr<EVENT::LCEvent> &overlayEvent, unsigned int fileIndex, EVENT::LCEvent *evt, EVENT::FloatVec &eventIDs, EVENT::FloatVec &runIDs ) {
+    eventIDs.push_back( overlayEvent->getEventNumber() ) ;
+    runIDs.push_back( overlayEvent->getRunNumber() ) ;
+    OverlayMerging::mergeEvents( overlayEvent.get(), evt, getMergePlan( fileIndex, overlayEvent.get() ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<EVENT::LCEvent> OverlayProcessor::readNextEvent( RandomGenerator &generator, unsigned int &fileIndex ) {
     // get the event index to random pick an event among the possible files
     std::uniform_int_distribution<int> flatDistribution( 0, _nAvailableEvents ) ;
     const unsigned int eventIndex = flatDistribution( generator ) ;
-    unsigned int currentEventIndex(0);    
     log<DEBUG>() << "Overlay::readNextEvent: index = " << eventIndex  << " over " << _nAvailableEvents << std::endl ;
-    for ( auto &handler : _fileHandlerList ) {
+    return readEvent( eventIndex, fileIndex ) ;
+  }
+  
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<EVENT::LCEvent> OverlayProcessor::readEvent( unsigned int eventIndex, unsigned int &fileIndex ) {
+    unsigned int currentEventIndex(0);    
+    for ( fileIndex = 0 ; fileIndex < _fileHandlerList.size() ; ++fileIndex ) {
+      auto &handler = _fileHandlerList[ fileIndex ] ;
       if ( currentEventIndex <= eventIndex && eventIndex < currentEventIndex + handler.getNumberOfEvents() ) {        
         const auto eventNumber = handler.getEventNumber( eventIndex-currentEventIndex ) ;
         const auto runNumber = handler.getRunNumber( eventIndex-currentEventIndex ) ;
@@ -246,6 +359,21 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
   
+  const OverlayMerging::MergePlan &OverlayProcessor::getMergePlan( unsigned int fileIndex, const EVENT::LCEvent *sample ) {
+    auto &plan = _mergePlans.at( fileIndex ) ;
+    if ( nullptr == plan ) {
+      plan = std::make_unique<OverlayMerging::MergePlan>( 
+        OverlayMerging::createMergePlan( sample, _overlayCollectionMap, _excludeCollections.get(), *_mergeRegistry ) ) ;
+      log<DEBUG6>() << "Resolved merge plan for file " << _fileNames.get().at( fileIndex ) << ": " << plan->_entries.size() << " collections" << std::endl ;
+    }
+    else if( 0 != OverlayMerging::extendMergePlan( *plan, sample, _overlayCollectionMap, _excludeCollections.get(), *_mergeRegistry ) ) {
+      log<DEBUG6>() << "Extended merge plan for file " << _fileNames.get().at( fileIndex ) << ": " << plan->_entries.size() << " collections" << std::endl ;
+    }
+    return *plan ;
+  }
+  
+  //--------------------------------------------------------------------------
+  
   unsigned int OverlayProcessor::getNAvailableEvents() {
     unsigned int totalNEvents {0} ;
     for ( auto &handler : _fileHandlerList ) {
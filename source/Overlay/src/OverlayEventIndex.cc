@@ -0,0 +1,193 @@
+#include <MarlinRecoMT/OverlayEventIndex.h>
+
+// -- marlin headers
+#include <marlin/Logging.h>
+using namespace marlin::loglevel ;
+
+// -- std headers
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+// -- posix headers
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+  /// The sidecar file header
+  struct IndexHeader {
+    char            _magic[8] ;
+    std::uint32_t   _version ;
+    std::uint32_t   _reserved ;
+    std::uint64_t   _fileSize ;
+    std::int64_t    _fileTime ;
+    std::int64_t    _fileTimeNsec ;
+    std::uint64_t   _fileInode ;
+    std::uint64_t   _nEvents ;
+  };
+
+  /// The identity of an lcio file, as stored in the sidecar file header
+  struct FileStatus {
+    std::uint64_t   _size {0} ;
+    std::int64_t    _time {0} ;
+    std::int64_t    _timeNsec {0} ;
+    std::uint64_t   _inode {0} ;
+  };
+
+  constexpr const char *IndexMagic = "MRMTEIDX" ;
+
+  /// Get the size, the modification time (with nanoseconds) and the inode of a file.
+  /// A file rewritten within the same second keeps its size but gets a new inode or time
+  bool fileStatus( const std::string &fileName, FileStatus &status ) {
+    struct stat st ;
+    if( 0 != ::stat( fileName.c_str(), &st ) ) {
+      return false ;
+    }
+    status._size = static_cast<std::uint64_t>( st.st_size ) ;
+    status._time = static_cast<std::int64_t>( st.st_mtim.tv_sec ) ;
+    status._timeNsec = static_cast<std::int64_t>( st.st_mtim.tv_nsec ) ;
+    status._inode = static_cast<std::uint64_t>( st.st_ino ) ;
+    return true ;
+  }
+
+}
+
+namespace marlinreco_mt {
+
+  OverlayEventIndex::~OverlayEventIndex() {
+    if( nullptr != _mapping ) {
+      ::munmap( _mapping, _mappingSize ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string OverlayEventIndex::indexFileName( const std::string &fileName ) {
+    return fileName + ".evtidx" ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<const OverlayEventIndex> OverlayEventIndex::load( const std::string &fileName ) {
+    FileStatus status ;
+    if( not fileStatus( fileName, status ) ) {
+      return nullptr ;
+    }
+    const auto idxName = indexFileName( fileName ) ;
+    int fd = ::open( idxName.c_str(), O_RDONLY ) ;
+    if( fd < 0 ) {
+      return nullptr ;
+    }
+    struct stat st ;
+    if( 0 != ::fstat( fd, &st ) || static_cast<std::size_t>( st.st_size ) < sizeof(IndexHeader) ) {
+      ::close( fd ) ;
+      return nullptr ;
+    }
+    const std::size_t mappingSize = st.st_size ;
+    void *mapping = ::mmap( nullptr, mappingSize, PROT_READ, MAP_SHARED, fd, 0 ) ;
+    ::close( fd ) ;
+    if( MAP_FAILED == mapping ) {
+      return nullptr ;
+    }
+    std::shared_ptr<OverlayEventIndex> index( new OverlayEventIndex() ) ;
+    index->_mapping = mapping ;
+    index->_mappingSize = mappingSize ;
+    const auto header = static_cast<const IndexHeader*>( mapping ) ;
+    // validate against the lcio file. The number of events is bounded before computing
+    // the expected size, so that a corrupted header can't overflow it
+    constexpr std::size_t entrySize = 2 * sizeof(std::int32_t) ;
+    if( 0 != std::memcmp( header->_magic, IndexMagic, sizeof(header->_magic) )
+      || Version != header->_version
+      || status._size != header->_fileSize
+      || status._time != header->_fileTime
+      || status._timeNsec != header->_fileTimeNsec
+      || status._inode != header->_fileInode
+      || header->_nEvents > ( mappingSize - sizeof(IndexHeader) ) / entrySize
+      || mappingSize != sizeof(IndexHeader) + header->_nEvents * entrySize ) {
+      streamlog_out( WARNING ) << "*** Overlay event index '" << idxName << "' is outdated or invalid, ignoring it" << std::endl ;
+      return nullptr ;
+    }
+    index->_entries = reinterpret_cast<const std::int32_t*>( static_cast<const char*>( mapping ) + sizeof(IndexHeader) ) ;
+    index->_nEvents = header->_nEvents ;
+    return index ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool OverlayEventIndex::write( const std::string &fileName, const std::vector<int> &eventMap ) {
+    IndexHeader header {} ;
+    std::memcpy( header._magic, IndexMagic, sizeof(header._magic) ) ;
+    header._version = Version ;
+    header._nEvents = eventMap.size() / 2 ;
+    FileStatus status ;
+    if( not fileStatus( fileName, status ) ) {
+      return false ;
+    }
+    header._fileSize = status._size ;
+    header._fileTime = status._time ;
+    header._fileTimeNsec = status._timeNsec ;
+    header._fileInode = status._inode ;
+    const auto idxName = indexFileName( fileName ) ;
+    // unique temporary file: processor clones are threads of the same process
+    // and may write the same index concurrently
+    std::string tmpName = idxName + ".XXXXXX" ;
+    const int fd = ::mkstemp( &tmpName[0] ) ;
+    if( fd < 0 ) {
+      return false ;
+    }
+    // mkstemp creates the file readable by the owner only
+    ::fchmod( fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH ) ;
+    ::close( fd ) ;
+    {
+      std::ofstream file( tmpName, std::ios::binary | std::ios::trunc ) ;
+      if( not file ) {
+        std::remove( tmpName.c_str() ) ;
+        return false ;
+      }
+      file.write( reinterpret_cast<const char*>( &header ), sizeof(header) ) ;
+      for( std::size_t i=0 ; i<header._nEvents*2 ; ++i ) {
+        const std::int32_t value = eventMap[i] ;
+        file.write( reinterpret_cast<const char*>( &value ), sizeof(value) ) ;
+      }
+      if( not file ) {
+        std::remove( tmpName.c_str() ) ;
+        return false ;
+      }
+    }
+    if( 0 != std::rename( tmpName.c_str(), idxName.c_str() ) ) {
+      std::remove( tmpName.c_str() ) ;
+      return false ;
+    }
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t OverlayEventIndex::size() const {
+    return _nEvents ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  int OverlayEventIndex::runNumber( std::size_t index ) const {
+    if( index >= _nEvents ) {
+      throw std::out_of_range( "OverlayEventIndex::runNumber: index out of range" ) ;
+    }
+    return _entries[ index * 2 ] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  int OverlayEventIndex::eventNumber( std::size_t index ) const {
+    if( index >= _nEvents ) {
+      throw std::out_of_range( "OverlayEventIndex::eventNumber: index out of range" ) ;
+    }
+    return _entries[ index * 2 + 1 ] ;
+  }
+
+}
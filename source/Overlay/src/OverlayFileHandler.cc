@@ -17,26 +17,33 @@ namespace marlinreco_mt {
 
   //--------------------------------------------------------------------------
 
+  /// Whether to use the sidecar event index file
+  void OverlayFileHandler::setUseEventIndex(bool use) {
+    _useEventIndex = use ;
+  }
+
+  //--------------------------------------------------------------------------
+
   /// Get the number of events available in the file
   unsigned int OverlayFileHandler::getNumberOfEvents() {
-    openFile() ;
-    return _lcReader->getNumberOfEvents() ;
+    openIndex() ;
+    return ( nullptr != _eventIndex ) ? _eventIndex->size() : _eventMap.size() / 2 ;
   }
 
   //--------------------------------------------------------------------------
 
   /// Get the event number at the specified index (look in the event map)
   unsigned int OverlayFileHandler::getEventNumber(unsigned int index) {
-    openFile() ;
-    return _eventMap.at( index * 2 + 1 ) ;
+    openIndex() ;
+    return ( nullptr != _eventIndex ) ? _eventIndex->eventNumber( index ) : _eventMap.at( index * 2 + 1 ) ;
   }
 
   //--------------------------------------------------------------------------
 
   /// Get the run number at the specified index (look in the event map)
   unsigned int OverlayFileHandler::getRunNumber(unsigned int index) {
-    openFile() ;
-    return _eventMap.at( index * 2 ) ;
+    openIndex() ;
+    return ( nullptr != _eventIndex ) ? _eventIndex->runNumber( index ) : _eventMap.at( index * 2 ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -57,9 +64,38 @@ namespace marlinreco_mt {
       _lcReader = std::make_shared<FileReader>( MT::LCReader::directAccess ) ;
       streamlog_out( MESSAGE ) << "*** Opening file for overlay, file name:" << _fileName << std::endl ;
       _lcReader->open( _fileName ) ;
-      _lcReader->getEvents( _eventMap ) ;
       streamlog_out( MESSAGE ) << "*** Opening file for overlay : number of available events: " << _lcReader->getNumberOfEvents() << std::endl ;
     }
   }
 
+  //--------------------------------------------------------------------------
+
+  /// Proxy method to load the event index
+  void OverlayFileHandler::openIndex() {
+    // a file without events leaves the event map empty: don't rescan it
+    if( _indexed ) {
+      return ;
+    }
+    if( _useEventIndex ) {
+      _eventIndex = OverlayEventIndex::load( _fileName ) ;
+      if( nullptr != _eventIndex ) {
+        streamlog_out( MESSAGE ) << "*** Overlay event index loaded from '" << OverlayEventIndex::indexFileName( _fileName ) 
+          << "', number of available events: " << _eventIndex->size() << std::endl ;
+        _indexed = true ;
+        return ;
+      }
+    }
+    openFile() ;
+    _lcReader->getEvents( _eventMap ) ;
+    _indexed = true ;
+    if( _useEventIndex ) {
+      if( OverlayEventIndex::write( _fileName, _eventMap ) ) {
+        streamlog_out( MESSAGE ) << "*** Overlay event index written to '" << OverlayEventIndex::indexFileName( _fileName ) << "'" << std::endl ;
+      }
+      else {
+        streamlog_out( WARNING ) << "*** Couldn't write overlay event index '" << OverlayEventIndex::indexFileName( _fileName ) << "'" << std::endl ;
+      }
+    }
+  }
+
 }
@@ -0,0 +1,32 @@
+#include <MarlinRecoMT/OverlayMergeRegistry.h>
+#include <MarlinRecoMT/OverlayMerging.h>
+
+// -- lcio headers
+#include <EVENT/LCIO.h>
+
+namespace marlinreco_mt {
+
+  OverlayMergeRegistry::OverlayMergeRegistry( float contributionTimeWindow ) {
+    registerFunction( EVENT::LCIO::MCPARTICLE, OverlayMerging::mergeMCParticleCollections ) ;
+    registerFunction( EVENT::LCIO::SIMCALORIMETERHIT, [contributionTimeWindow]( EVENT::LCCollection* src, EVENT::LCCollection* dst ) {
+      OverlayMerging::mergeSimCalorimeterHitCollections( src, dst, contributionTimeWindow ) ;
+    }) ;
+    registerFunction( EVENT::LCIO::CALORIMETERHIT, OverlayMerging::mergeCalorimeterHitCollections ) ;
+    registerFunction( EVENT::LCIO::SIMTRACKERHIT, OverlayMerging::spliceCollections ) ;
+    _defaultFunction = OverlayMerging::spliceCollections ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void OverlayMergeRegistry::registerFunction( const std::string &type, MergeFunction function ) {
+    _typeFunctions[ type ] = function ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const OverlayMergeRegistry::MergeFunction &OverlayMergeRegistry::function( const std::string &type ) const {
+    auto iter = _typeFunctions.find( type ) ;
+    return ( _typeFunctions.end() != iter ) ? iter->second : _defaultFunction ;
+  }
+
+}
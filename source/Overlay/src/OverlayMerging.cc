@@ -1,4 +1,5 @@
 #include <MarlinRecoMT/OverlayMerging.h>
+#include <MarlinRecoMT/OverlayMergeRegistry.h>
 #include <MarlinRecoMT/LCIOHelper.h>
 
 // -- marlin headers
@@ -7,8 +8,15 @@ using namespace marlin::loglevel ;
 
 // -- std headers
 #include <algorithm>
+#include <functional>
+#include <numeric>
 #include <string>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <string_view>
+#include <cmath>
+#include <vector>
 
 // -- lcio headers
 #include <EVENT/LCEvent.h>
@@ -20,12 +28,65 @@ using namespace marlin::loglevel ;
 #include <IMPL/CalorimeterHitImpl.h>
 #include <Exceptions.h>
 
+namespace {
+
+  /// Access to the (protected) MC contribution vector of SimCalorimeterHitImpl
+  struct SimCalorimeterHitContributions : public IMPL::SimCalorimeterHitImpl {
+    static IMPL::MCParticleContVec &get( IMPL::SimCalorimeterHitImpl *hit ) {
+      return hit->*( &SimCalorimeterHitContributions::_vec ) ;
+    }
+  };
+
+  /// Collapse in place the contributions from the same MCParticle and PDG within the time window.
+  /// The contribution indices are grouped by particle with a stable sort, so that each contribution
+  /// is only compared to the kept contributions of its own particle, in the original order.
+  /// The order of the kept contributions is unchanged. The index vector is reused between hits
+  void collapseContributions( IMPL::MCParticleContVec &contributions, float timeWindow, std::vector<std::size_t> &order ) {
+    const std::size_t nContributions = contributions.size() ;
+    if( nContributions < 2 ) {
+      return ;
+    }
+    order.resize( nContributions ) ;
+    std::iota( order.begin(), order.end(), 0 ) ;
+    std::stable_sort( order.begin(), order.end(), [&]( std::size_t lhs, std::size_t rhs ) {
+      return std::less<const EVENT::MCParticle*>()( contributions[lhs]->Particle, contributions[rhs]->Particle ) ;
+    }) ;
+    for( auto first = order.begin() ; first != order.end() ; ) {
+      const EVENT::MCParticle *particle = contributions[*first]->Particle ;
+      const auto last = std::find_if( first, order.end(), [&]( std::size_t index ) {
+        return ( contributions[index]->Particle != particle ) ;
+      }) ;
+      // the kept contributions of this particle are moved at the front of its group
+      auto kept = first ;
+      for( auto iter = first ; iter != last ; ++iter ) {
+        auto cont = contributions[*iter] ;
+        auto match = std::find_if( first, kept, [&]( std::size_t index ) {
+          return ( contributions[index]->PDG == cont->PDG ) && ( std::fabs( contributions[index]->Time - cont->Time ) <= timeWindow ) ;
+        }) ;
+        if( kept != match ) {
+          auto target = contributions[*match] ;
+          target->Energy += cont->Energy ;
+          target->Time = std::min( target->Time, cont->Time ) ;
+          delete cont ;
+          contributions[*iter] = nullptr ;
+        }
+        else {
+          *kept++ = *iter ;
+        }
+      }
+      first = last ;
+    }
+    contributions.erase( std::remove( contributions.begin(), contributions.end(), nullptr ), contributions.end() ) ;
+  }
+
+}
+
 namespace marlinreco_mt {
 
   void OverlayMerging::mergeEvents( const EVENT::LCEvent *src, EVENT::LCEvent *dst ) {
-    std::vector<std::string> srcColNames = *src->getCollectionNames() ;
-    std::vector<std::string> dstColNames = *dst->getCollectionNames() ;
-    for ( auto colname : srcColNames ) {
+    const auto &srcColNames = *src->getCollectionNames() ;
+    const auto &dstColNames = *dst->getCollectionNames() ;
+    for ( const auto &colname : srcColNames ) {
       if ( dstColNames.end() != std::find(dstColNames.begin(), dstColNames.end(), colname) ) {
         OverlayMerging::mergeCollections( src->getCollection( colname ), dst->getCollection( colname ) ) ;
       }
@@ -34,36 +95,88 @@ namespace marlinreco_mt {
   
   //--------------------------------------------------------------------------
 
-  void OverlayMerging::mergeEvents( const EVENT::LCEvent *src, EVENT::LCEvent *dst, const CollectionMap &mergeMap ) {
-    for( auto iter : mergeMap ) {
+  OverlayMerging::MergePlan OverlayMerging::createMergePlan( const EVENT::LCEvent *sample, const CollectionMap &mergeMap, const std::vector<std::string> &excludeCollections, const OverlayMergeRegistry &registry ) {
+    MergePlan plan {} ;
+    OverlayMerging::extendMergePlan( plan, sample, mergeMap, excludeCollections, registry ) ;
+    return plan ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned int OverlayMerging::extendMergePlan( MergePlan &plan, const EVENT::LCEvent *sample, const CollectionMap &mergeMap, const std::vector<std::string> &excludeCollections, const OverlayMergeRegistry &registry ) {
+    unsigned int nAdded {0} ;
+    const auto &sampleColNames = *sample->getCollectionNames() ;
+    // the sample collection names, only hashed if a collection of the map is not planned yet
+    std::unordered_set<std::string_view> sampleNames {} ;
+    auto addEntry = [&]( const std::string &srcName, const std::string &dstName, bool inSample ) {
+      if( plan._index.end() != plan._index.find( srcName ) ) {
+        return ;
+      }
+      if( excludeCollections.end() != std::find( excludeCollections.begin(), excludeCollections.end(), srcName ) ) {
+        return ;
+      }
+      if( not inSample ) {
+        if( sampleNames.empty() ) {
+          sampleNames.insert( sampleColNames.begin(), sampleColNames.end() ) ;
+        }
+        if( sampleNames.end() == sampleNames.find( srcName ) ) {
+          return ;
+        }
+      }
+      streamlog_out( DEBUG6 ) << "Merge plan -> " << srcName << " into " << dstName << std::endl ;
+      plan._index.emplace( srcName, plan._entries.size() ) ;
+      plan._entries.push_back( { srcName, dstName, &registry.function( sample->getCollection( srcName )->getTypeName() ) } ) ;
+      ++nAdded ;
+    } ;
+    if( mergeMap.empty() ) {
+      for( const auto &colName : sampleColNames ) {
+        addEntry( colName, colName, true ) ;
+      }
+    }
+    else {
+      for( const auto &iter : mergeMap ) {
+        addEntry( iter.first, iter.second, false ) ;
+      }
+    }
+    return nAdded ;
+  }
+  
+  //--------------------------------------------------------------------------
+
+  void OverlayMerging::mergeEvents( const EVENT::LCEvent *src, EVENT::LCEvent *dst, const MergePlan &plan ) {
+    for( const auto &entry : plan._entries ) {
       EVENT::LCCollection *srcCollection = nullptr ;
       EVENT::LCCollection *dstCollection = nullptr ;
       // get the source collection
       try {
-        srcCollection = src->getCollection( iter.first ) ;
+        srcCollection = src->getCollection( entry._srcName ) ;
       } 
       catch ( EVENT::DataNotAvailableException&) {
         continue ;
       }
       // get or create the destination collection
       try {
-        dstCollection = dst->getCollection( iter.second ) ;
+        dstCollection = dst->getCollection( entry._dstName ) ;
+        // check if collections have the same type
+        if ( dstCollection->getTypeName() != srcCollection->getTypeName() ) {
+          throw EVENT::Exception( "OverlayMerging::mergeEvents: collection types are different" ) ;
+        }
       } 
       catch ( EVENT::DataNotAvailableException&) {
-        streamlog_out( DEBUG ) << "destination collection " << iter.second  << " was created." << std::endl ; 
+        streamlog_out( DEBUG ) << "destination collection " << entry._dstName  << " was created." << std::endl ; 
         dstCollection = new IMPL::LCCollectionVec( srcCollection->getTypeName() ) ;
         // merge collection parameters
         LCIOHelper::mergeLCParameters( srcCollection->getParameters(), dstCollection->parameters() ) ;
-        dst->addCollection( dstCollection, iter.second ) ;
+        dst->addCollection( dstCollection, entry._dstName ) ;
       }
       dstCollection->setFlag( srcCollection->getFlag() ) ;
-      OverlayMerging::mergeCollections( srcCollection, dstCollection ) ;
+      (*entry._function)( srcCollection, dstCollection ) ;
     }
   }
 
   //--------------------------------------------------------------------------
 
-  void OverlayMerging::mergeCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) {
+  void OverlayMerging::mergeCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst, float contributionTimeWindow ) {
     auto dstType = dst->getTypeName() ;
     // check if collections have the same type
     if ( dstType != src->getTypeName() ) {
@@ -73,13 +186,13 @@ namespace marlinreco_mt {
       OverlayMerging::mergeMCParticleCollections( src, dst ) ;
     }
     else if( dstType == EVENT::LCIO::SIMCALORIMETERHIT ) {
-      OverlayMerging::mergeSimCalorimeterHitCollections( src, dst ) ;
+      OverlayMerging::mergeSimCalorimeterHitCollections( src, dst, contributionTimeWindow ) ;
     }
     else if( dstType == EVENT::LCIO::CALORIMETERHIT ) {
       OverlayMerging::mergeCalorimeterHitCollections( src, dst ) ;
     }
     else {
-      OverlayMerging::mergeAnyCollections( src, dst ) ;
+      OverlayMerging::spliceCollections( src, dst ) ;
     }
   }
 
@@ -90,21 +203,23 @@ namespace marlinreco_mt {
       throw EVENT::Exception( "OverlayMerging::mergeMCParticleCollections: not MCParticle collections" ) ;
     }
     int nelts = src->getNumberOfElements();
-    for( int i=nelts-1 ; i>=0 ; i-- ) {
+    for( int i=0 ; i<nelts ; i++ ) {
       IMPL::MCParticleImpl* p =  dynamic_cast<IMPL::MCParticleImpl*>( src->getElementAt(i) ) ;
       p->setOverlay( true ) ;
-      dst->addElement( p ) ;
-      src->removeElementAt( i ) ;
     }
+    OverlayMerging::spliceCollections( src, dst ) ;
   }
 
   //--------------------------------------------------------------------------
 
-  void OverlayMerging::mergeSimCalorimeterHitCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) {
+  void OverlayMerging::mergeSimCalorimeterHitCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst, float contributionTimeWindow ) {
     int neltsSrc = src->getNumberOfElements();
     int neltsDst = dst->getNumberOfElements();
+    const bool collapse = ( contributionTimeWindow > 0.f ) ;
+    std::vector<std::size_t> contributionOrder {} ;
     // create a map of dest Collection
-    std::map<long long, IMPL::SimCalorimeterHitImpl*> dstMap {} ;
+    std::unordered_map<long long, IMPL::SimCalorimeterHitImpl*> dstMap {} ;
+    dstMap.reserve( neltsDst ) ;
     for ( int i=0 ; i<neltsDst ; i++ ) {
       auto dstHit = dynamic_cast<IMPL::SimCalorimeterHitImpl*> ( dst->getElementAt(i) );
       dstMap.insert( std::pair<long long, IMPL::SimCalorimeterHitImpl*>(
@@ -115,15 +230,27 @@ namespace marlinreco_mt {
     // process the src collection and merge with dest
     for ( int i=neltsSrc-1 ; i>=0 ; i-- ) {
       auto srcHit = dynamic_cast<IMPL::SimCalorimeterHitImpl*> ( src->getElementAt(i) ) ;
+      auto &srcContributions = SimCalorimeterHitContributions::get( srcHit ) ;
+      if ( collapse ) {
+        collapseContributions( srcContributions, contributionTimeWindow, contributionOrder ) ;
+      }
       auto findIter = dstMap.find( LCIOHelper::cellIDToLong( srcHit->getCellID0(), srcHit->getCellID1() ) ) ;
       if ( findIter == dstMap.end() ) {
         dst->addElement( srcHit ) ;
       }
       else {
-        int numMC = srcHit->getNMCContributions() ;
-        for( int j=0 ; j<numMC ; j++ ) {
-          findIter->second->addMCParticleContribution( srcHit->getParticleCont(j), srcHit->getEnergyCont(j), srcHit->getTimeCont(j), srcHit->getPDGCont(j));
+        // move the contributions to the destination hit: the contribution 
+        // objects are not copied and the vector is reallocated at most once
+        auto dstHit = findIter->second ;
+        auto &dstContributions = SimCalorimeterHitContributions::get( dstHit ) ;
+        float energySum = 0.f ;
+        dstContributions.reserve( dstContributions.size() + srcContributions.size() ) ;
+        for( auto cont : srcContributions ) {
+          energySum += cont->Energy ;
+          dstContributions.push_back( cont ) ;
         }
+        srcContributions.clear() ;
+        dstHit->setEnergy( dstHit->getEnergy() + energySum ) ;
         delete srcHit;
       }
       src->removeElementAt( i ) ;
@@ -169,4 +296,18 @@ namespace marlinreco_mt {
     }
   }
 
+  //--------------------------------------------------------------------------
+
+  void OverlayMerging::spliceCollections( EVENT::LCCollection* src, EVENT::LCCollection* dst ) {
+    auto srcVec = dynamic_cast<IMPL::LCCollectionVec*>( src ) ;
+    auto dstVec = dynamic_cast<IMPL::LCCollectionVec*>( dst ) ;
+    if( nullptr == srcVec or nullptr == dstVec ) {
+      OverlayMerging::mergeAnyCollections( src, dst ) ;
+      return ;
+    }
+    // reverse order, as the element by element merging
+    dstVec->insert( dstVec->end(), srcVec->rbegin(), srcVec->rend() ) ;
+    srcVec->clear() ;
+  }
+
 }
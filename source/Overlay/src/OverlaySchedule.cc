@@ -0,0 +1,130 @@
+#include <MarlinRecoMT/OverlaySchedule.h>
+
+// -- std headers
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace marlinreco_mt {
+
+  void OverlaySchedule::generate( unsigned int nEntries, unsigned int seed, unsigned int nFixed, double expBG, unsigned int nAvailableEvents ) {
+    _entries.clear() ;
+    if( 0 == nAvailableEvents ) {
+      throw std::runtime_error( "OverlaySchedule::generate: no background event available" ) ;
+    }
+    std::mt19937 generator( seed ) ;
+    std::uniform_int_distribution<unsigned int> flatDistribution( 0, nAvailableEvents-1 ) ;
+    _entries.resize( nEntries ) ;
+    for( auto &entry : _entries ) {
+      unsigned int nEvents = nFixed ;
+      if( expBG >= 0. ) {
+        std::poisson_distribution<int> poissonDistribution( expBG ) ;
+        nEvents += poissonDistribution( generator ) ;
+      }
+      entry.resize( nEvents ) ;
+      for( auto &index : entry ) {
+        index = flatDistribution( generator ) ;
+      }
+      std::sort( entry.begin(), entry.end() ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void OverlaySchedule::read( const std::string &fileName, unsigned int nAvailableEvents ) {
+    std::ifstream file( fileName ) ;
+    if( not file ) {
+      throw std::runtime_error( "OverlaySchedule::read: couldn't open file " + fileName ) ;
+    }
+    _entries.clear() ;
+    std::string line ;
+    while( std::getline( file, line ) ) {
+      std::istringstream lineStream( line ) ;
+      Entry entry ;
+      unsigned int index(0) ;
+      while( lineStream >> index ) {
+        if( index >= nAvailableEvents ) {
+          throw std::runtime_error( "OverlaySchedule::read: background event index " + std::to_string( index ) + 
+                                    " out of range (" + std::to_string( nAvailableEvents ) + " available events) in file " + fileName ) ;
+        }
+        entry.push_back( index ) ;
+      }
+      if( not lineStream.eof() ) {
+        throw std::runtime_error( "OverlaySchedule::read: invalid line in file " + fileName ) ;
+      }
+      _entries.push_back( std::move( entry ) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void OverlaySchedule::write( const std::string &fileName ) const {
+    // unique temporary file, several processor instances may write the same schedule
+    const auto tmpName = fileName + "." + std::to_string( reinterpret_cast<std::uintptr_t>( this ) ) + ".tmp" ;
+    {
+      std::ofstream file( tmpName, std::ios::trunc ) ;
+      if( not file ) {
+        throw std::runtime_error( "OverlaySchedule::write: couldn't open file " + tmpName ) ;
+      }
+      for( const auto &entry : _entries ) {
+        for( std::size_t i=0 ; i<entry.size() ; ++i ) {
+          file << ( i ? " " : "" ) << entry[i] ;
+        }
+        file << "\n" ;
+      }
+      if( not file ) {
+        throw std::runtime_error( "OverlaySchedule::write: couldn't write file " + tmpName ) ;
+      }
+    }
+    if( 0 != std::rename( tmpName.c_str(), fileName.c_str() ) ) {
+      throw std::runtime_error( "OverlaySchedule::write: couldn't rename file " + tmpName ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool OverlaySchedule::empty() const {
+    return _entries.empty() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned int OverlaySchedule::size() const {
+    return _entries.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const OverlaySchedule::Entry &OverlaySchedule::entry( int runNumber, int eventNumber ) const {
+    if( _entries.empty() ) {
+      throw std::out_of_range( "OverlaySchedule::entry: empty schedule" ) ;
+    }
+    // run offset: splitmix64 finalizer of the run number
+    std::uint64_t runHash = static_cast<std::uint32_t>( runNumber ) + 0x9E3779B97F4A7C15ULL ;
+    runHash = ( runHash ^ ( runHash >> 30 ) ) * 0xBF58476D1CE4E5B9ULL ;
+    runHash = ( runHash ^ ( runHash >> 27 ) ) * 0x94D049BB133111EBULL ;
+    runHash ^= ( runHash >> 31 ) ;
+    const std::uint64_t nEntries = _entries.size() ;
+    const std::uint64_t index = ( runHash % nEntries + static_cast<std::uint32_t>( eventNumber ) % nEntries ) % nEntries ;
+    return _entries[ index ] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::vector<unsigned int> OverlaySchedule::usageCounts( unsigned int nAvailableEvents ) const {
+    std::vector<unsigned int> counts( nAvailableEvents, 0 ) ;
+    for( const auto &entry : _entries ) {
+      for( auto index : entry ) {
+        if( index < nAvailableEvents ) {
+          ++counts[ index ] ;
+        }
+      }
+    }
+    return counts ;
+  }
+
+}
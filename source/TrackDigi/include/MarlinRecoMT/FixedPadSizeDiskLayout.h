@@ -7,6 +7,8 @@
 #include "DDRec/DetectorData.h"
 #include "DDRec/Vector2D.h"
 
+#include <MarlinRecoMT/Span.h>
+
 namespace marlinreco_mt {
 
   /** Implementation of PadRowLayout2D for a disk with fixed sized keystone pads.
@@ -15,6 +17,8 @@ namespace marlinreco_mt {
    *  in the first quadrant (x>0,y>0 ) and symmetyrical to the last pad right below the the x-axis.
    *  The pad width is the width alog the ring's circumference at the middle of the row
    *  (through the pad center).
+   *  All the tables are built in the constructor: the layout is immutable and can be
+   *  shared between threads without locking.
    *
    * @author F. Gaede, DESY
    */
@@ -42,20 +46,19 @@ namespace marlinreco_mt {
     int _nPad {};
     std::vector<Row> _rows {};
     std::vector<double> _extent {};
-    mutable std::vector< std::vector<int>* > _padIndices {};
-      
-    /** function to copy all internal variables, incl. the objects
-     *  pointed to and owned by the FixedPadSizeDiskLayout.
-     *  Used by constructor and assigment operator to avoid code duplication
-     */
-    void copy_and_assign(const  FixedPadSizeDiskLayout & );
+    /// The pad indices of row i are _padIndices[ _rowOffsets[i] ] to _padIndices[ _rowOffsets[i+1] - 1 ]
+    std::vector<int> _rowOffsets {};
+    /// The pad indices of all the rows, contiguous
+    std::vector<int> _padIndices {};
+    /// PhiPad of each row, contiguous
+    std::vector<double> _phiPad {};
+    /// NPad - 1 of each row
+    std::vector<int> _maxPadNumber {};
 
-    /** function to delete all the objects
-     *  pointed to and owned by the FixedPadSizeDiskLayout.
-     *  Used by desctructor and assigment operator to avoid code duplication
+    /** The index of the pad nearest to (r,phi) for 0 <= phi <= _phiMax.
+     *  Shared by getNearestPad() and getNearestPads()
      */
-    void cleanup();
-
+    inline int nearestPadInRange(double r, double phi) const ;
 
   public:
       
@@ -67,17 +70,6 @@ namespace marlinreco_mt {
 
     FixedPadSizeDiskLayout( const dd4hep::rec::FixedPadSizeTPCData* tpc ) ;
 
-        
-    /** The copy constructor.
-     *	Needed because _padIndices allocates memory dynamically
-     */
-    FixedPadSizeDiskLayout( const FixedPadSizeDiskLayout &);
-
-    /// The assignment operator
-    FixedPadSizeDiskLayout & operator = ( const FixedPadSizeDiskLayout &);
-
-    /// Destructor.
-    ~FixedPadSizeDiskLayout() ;
 
     /** The gap width in mm that was given in the C'tor. */
     double getPadGap() const { return _padGap ; }
@@ -117,9 +109,9 @@ namespace marlinreco_mt {
 
 
     /** Indices of all pads in row rowNumber (row indices start from 0 at the
-     * bottom (CARTESIAN) or at the center (POLAR)).
+     * bottom (CARTESIAN) or at the center (POLAR)). Empty if the row doesn't exist.
      */
-    const std::vector<int>& getPadsInRow(int rowNumber) const ;
+    Span<const int> getPadsInRow(int rowNumber) const ;
 
     /** Extent of the sensitive plane - [xmin,xmax,ymin,ymax] CARTESIAN or
      *	[rmin,rmax,phimin,phimax] POLAR.
@@ -143,6 +135,14 @@ namespace marlinreco_mt {
      */
     int getNearestPad(double c0, double c1)  const;
 
+    /** The indices of the pads nearest to the given points in (r,phi), same results as
+     *  getNearestPad() point by point. The loop over the points is branch free so that
+     *  it can be vectorised, points with r close to 0 (getNearestPad() throws) or far
+     *  outside [0,2pi] in phi are then passed to getNearestPad().
+     *  Throws std::invalid_argument if the spans don't have the same size.
+     */
+    void getNearestPads(Span<const double> r, Span<const double> phi, Span<int> padIndices) const;
+
     /** The index of the right neighbour pad.
      */
     int getRightNeighbour(int padIndex)  const;
@@ -4,12 +4,15 @@
 #include <DDRec/DetectorData.h>
 #include <DDRec/Vector3D.h>
 
+#include <MarlinRecoMT/Span.h>
+
 #include <vector>
 
 namespace marlinreco_mt {
   
   /** Helper class for defining a modular TPC endplate with regular modules.
    *  Computes the distance from a module boundary for hits.
+   *  The distance computations are const and can be shared by threads once initialized.
    * 
    * @author F.Gaede, DESY
    * @date June, 2017 
@@ -26,6 +29,7 @@ namespace marlinreco_mt {
       double rMin ;
       double rMax ;
       double deltaPhi ;
+      double invDeltaPhi ;
     } ;
 
 
@@ -45,11 +49,19 @@ namespace marlinreco_mt {
 
     
     /// inititalize with the modules added so far - after this no more modules can be added.
+    /// Throws marlin::Exception if no ring was added or if a ring has no module.
     void initialize() ;
 
 
     /// compute the distance in the rphi-plane from a module boundary in mm. 
-    double computeDistanceRPhi( const dd4hep::rec::Vector3D& hit) ;
+    double computeDistanceRPhi( const dd4hep::rec::Vector3D& hit) const ;
+
+    /** compute the distances in the rphi-plane from a module boundary in mm for hits given
+     *  in (rho,phi) in mm. Same results as computeDistanceRPhi(), the loop is branch free
+     *  so that it can be vectorised. Hits outside the readout radii get 1e6.
+     *  Throws std::invalid_argument if the spans don't have the same size.
+     */
+    void computeDistancesRPhi( Span<const double> rho, Span<const double> phi, Span<double> distances ) const ;
     
     
   protected:
@@ -58,6 +70,12 @@ namespace marlinreco_mt {
 
     const dd4hep::rec::FixedPadSizeTPCData* _tpc{} ;
 
+    /// the readout inner radius in mm
+    double _rMinReadout{} ;
+
+    /// number of rings / radial readout extent in mm
+    double _invDeltaR{} ;
+
     bool isInitialized{ false } ;
 
 
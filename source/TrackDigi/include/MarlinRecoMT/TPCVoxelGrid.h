@@ -0,0 +1,117 @@
+#ifndef MARLINRECOMT_TPCVOXELGRID_h
+#define MARLINRECOMT_TPCVOXELGRID_h 1
+
+// -- marlinreco mt headers
+#include <MarlinRecoMT/Span.h>
+
+// -- std headers
+#include <cstddef>
+#include <vector>
+
+namespace marlinreco_mt {
+
+  /** The TPC voxels of an event and their clusters on the pad rows.
+   *  The voxels are stored as structure of arrays, in the order they are added.
+   *  buildClusters() bins each row in phi, with bins at least as wide as the r-phi double
+   *  hit resolution, and sorts a (row, phi bin, z) index of the voxels. A voxel is only
+   *  compared with the voxels of its own and of the adjacent phi bins inside the z window,
+   *  and the connected components are labelled with an iterative union-find. No adjacency
+   *  list is stored and no recursion is involved, whatever the cluster size.
+   *  Example usage: <br>
+   *  <pre>
+   *     TPCVoxelGrid grid ;
+   *     for( ... ) {
+   *       grid.addVoxel( row, radius, phi, z, edep, rPhiRes, zRes ) ;
+   *     }
+   *     grid.buildClusters( 2.0, 5.0 ) ;
+   *     for( std::size_t c=0 ; c<grid.numberOfClusters() ; ++c ) {
+   *       for( unsigned int voxel : grid.cluster( c ) ) { ... }
+   *     }
+   *  </pre>
+   */
+  class TPCVoxelGrid {
+  public:
+    /** Reserve space for n voxels
+     */
+    void reserve( std::size_t n ) ;
+
+    /** Remove all the voxels and clusters, keep the allocated memory
+     */
+    void clear() ;
+
+    /** Add a voxel. Returns its index, the number of voxels added before
+     *  @param row the pad row
+     *  @param radius the pad row radius (mm)
+     *  @param phi the azimuthal angle
+     *  @param z the z position (mm)
+     *  @param edep the deposited energy
+     *  @param rPhiRes the r-phi resolution (mm)
+     *  @param zRes the z resolution (mm)
+     */
+    unsigned int addVoxel( int row, double radius, double phi, double z, double edep, double rPhiRes, double zRes ) ;
+
+    /** Find the clusters of voxels: two voxels of the same row are linked if they are
+     *  closer than doubleHitResZ in z and closer than doubleHitResRPhi in r-phi.
+     *  The clusters are ordered by their first voxel in (row, z), the voxels of a cluster
+     *  are ordered in z
+     *  @param doubleHitResRPhi the double hit resolution in r-phi (mm)
+     *  @param doubleHitResZ the double hit resolution in z (mm)
+     */
+    void buildClusters( double doubleHitResRPhi, double doubleHitResZ ) ;
+
+    /** The number of voxels */
+    std::size_t numberOfVoxels() const { return _row.size() ; }
+
+    /** The number of clusters found by the last call to buildClusters() */
+    std::size_t numberOfClusters() const { return _clusterOffsets.empty() ? 0 : _clusterOffsets.size() - 1 ; }
+
+    /** The indices of the voxels of a cluster */
+    Span<const unsigned int> cluster( std::size_t index ) const {
+      return Span<const unsigned int>( _clusterVoxels.data() + _clusterOffsets[index], _clusterOffsets[index+1] - _clusterOffsets[index] ) ;
+    }
+
+    /** Voxel properties, see addVoxel() */
+    int row( unsigned int voxel ) const { return _row[voxel] ; }
+    double radius( unsigned int voxel ) const { return _radius[voxel] ; }
+    double phi( unsigned int voxel ) const { return _phi[voxel] ; }
+    double z( unsigned int voxel ) const { return _z[voxel] ; }
+    double edep( unsigned int voxel ) const { return _edep[voxel] ; }
+    double rPhiRes( unsigned int voxel ) const { return _rPhiRes[voxel] ; }
+    double zRes( unsigned int voxel ) const { return _zRes[voxel] ; }
+
+  private:
+    /// The maximum number of phi bins of a row
+    static constexpr unsigned int maxPhiBins = 1 << 16 ;
+
+    /// The root of the voxel set, halving the path on the way
+    unsigned int findRoot( unsigned int voxel ) ;
+
+  private:
+    // the voxels
+    std::vector<int>             _row {} ;
+    std::vector<double>          _radius {} ;
+    std::vector<double>          _phi {} ;
+    std::vector<double>          _z {} ;
+    std::vector<double>          _edep {} ;
+    std::vector<double>          _rPhiRes {} ;
+    std::vector<double>          _zRes {} ;
+    // the clustering
+    /// The voxel indices sorted in (row, z)
+    std::vector<unsigned int>    _sorted {} ;
+    /// The phi bin of the voxels and the number of phi bins of their row
+    std::vector<unsigned int>    _phiBin {} ;
+    std::vector<unsigned int>    _nPhiBins {} ;
+    /// The voxel indices sorted in (row, phi bin, z)
+    std::vector<unsigned int>    _binned {} ;
+    /// The union-find parents
+    std::vector<unsigned int>    _parent {} ;
+    /// The cluster index of the root voxels
+    std::vector<unsigned int>    _clusterIndex {} ;
+    /// The voxels of cluster i are _clusterVoxels[ _clusterOffsets[i] ] to _clusterVoxels[ _clusterOffsets[i+1] - 1 ]
+    std::vector<unsigned int>    _clusterOffsets {} ;
+    std::vector<unsigned int>    _clusterVoxels {} ;
+  };
+
+}
+
+#endif
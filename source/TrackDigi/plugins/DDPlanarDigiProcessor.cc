@@ -19,11 +19,14 @@
 using namespace marlin::loglevel ;
 
 // -- dd4hep headers
-#include "DDRec/Surface.h"
-#include "DDRec/SurfaceManager.h"
-#include "DD4hep/Detector.h"
+#include "DDRec/Vector2D.h"
+#include "DDRec/Vector3D.h"
 #include "DD4hep/DD4hepUnits.h"
 
+// -- marlinrecomt headers
+#include <MarlinRecoMT/CellIDFields.h>
+#include <MarlinRecoMT/GeometrySnapshot.h>
+
 // -- std headers
 #include <random>
 
@@ -42,6 +45,8 @@ namespace marlinreco_mt {
    * Processor produces collection of smeared TrackerHits<br>
    * @param SimTrackHitCollectionName The name of input collection of SimTrackerHits <br>
    * (default name VXDCollection) <br>
+   * @param SimTrackHitCollectionNames The names of several input collections of SimTrackerHits digitised into the same output, with the same cellID encoding <br>
+   * (overrides SimTrackHitCollectionName if set) <br>
    * @param TrackerHitCollectionName The name of output collection of smeared TrackerHits <br>
    * (default name VTXTrackerHits) <br>
    * @param ResolutionU resolution in direction of u (in mm) <br>
@@ -88,6 +93,9 @@ namespace marlinreco_mt {
     marlin::InputCollectionProperty _inputCollectionName{this, EVENT::LCIO::SIMTRACKERHIT, "SimTrackHitCollectionName" , 
                                 "Name of the Input SimTrackerHit collection", "VXDCollection" } ;
 
+    marlin::InputCollectionsProperty _inputCollectionNames {this, EVENT::LCIO::SIMTRACKERHIT, "SimTrackHitCollectionNames" ,
+                                "Names of the Input SimTrackerHit collections, all digitised into the output collection. Overrides SimTrackHitCollectionName if set" } ;
+
     marlin::OutputCollectionProperty _outputCollectionName {this, EVENT::LCIO::TRACKERHITPLANE, "TrackerHitCollectionName" , 
                                 "Name of the TrackerHit output collection" , "VTXTrackerHits" } ;
     
@@ -114,7 +122,10 @@ namespace marlinreco_mt {
                                 
     // to be replaced by std random stuff
     // gsl_rng* _rng ;
-    const dd4hep::rec::SurfaceMap* _surfaceMap {nullptr} ;
+    std::shared_ptr<const GeometrySnapshot> _geometry {nullptr} ;
+    const SurfaceTable* _surfaces {nullptr} ;
+    /// The input collection names (const by usage in processEvent)
+    EVENT::StringVec _inputCollections {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -134,6 +145,13 @@ namespace marlinreco_mt {
     
     // initalisation of random number generator
     marlin::ProcessorApi::registerForRandomSeeds( this ) ;
+
+    if( _inputCollectionNames.get().empty() ) {
+      _inputCollections.push_back( _inputCollectionName.get() ) ;
+    }
+    else {
+      _inputCollections = _inputCollectionNames.get() ;
+    }
     
     if( _resolutionU.get().size() != _resolutionV.get().size() ) {
       std::stringstream ss ;
@@ -142,18 +160,19 @@ namespace marlinreco_mt {
       marlin::ProcessorApi::abort( this, ss.str() ) ;
     }
     
-    //===========  get the surface map from the SurfaceManager ================
-    dd4hep::Detector& theDetector = dd4hep::Detector::getInstance();
-    dd4hep::rec::SurfaceManager& surfMan = *theDetector.extension<dd4hep::rec::SurfaceManager>() ;
-    dd4hep::DetElement det = theDetector.detector( _subDetectorName.get() ) ;
-    _surfaceMap = surfMan.map( det.name() ) ;
-    if( nullptr == _surfaceMap ) {   
+    //===========  get the surfaces from the geometry snapshot ================
+    _geometry = GeometrySnapshot::instance() ;
+    _surfaces = _geometry->surfaces( _subDetectorName.get() ) ;
+    if( nullptr == _surfaces ) {   
       std::stringstream err  ; 
       err << " Could not find surface map for detector: " << _subDetectorName.get() << " in SurfaceManager " ;
       marlin::ProcessorApi::abort( this, err.str() ) ;
     }
+    if( not _surfaces->hasBounds() ) {
+      marlin::ProcessorApi::abort( this, "The bounds of the " + _subDetectorName.get() + " surfaces are not in the geometry cache file, load the DD4hep geometry instead" ) ;
+    }
     
-    log<DEBUG3>() << " DDPlanarDigiProcessor::init(): found " << _surfaceMap->size() 
+    log<DEBUG3>() << " DDPlanarDigiProcessor::init(): found " << _surfaces->size() 
                             << " surfaces for detector:" <<  _subDetectorName.get() << std::endl ;
   }
 
@@ -166,15 +185,27 @@ namespace marlinreco_mt {
     RandomGenerator generator {} ;
     generator.seed( eventSeed ) ;
     std::normal_distribution<double> gaussian {} ;
-    // get the input collection
-    EVENT::LCCollection *inputCollection = nullptr ;
-    try {
-      inputCollection = evt->getCollection( _inputCollectionName.get() ) ;
+    // get the input collections
+    std::vector<EVENT::LCCollection*> inputCollections ;
+    for( const auto &colName : _inputCollections ) {
+      try {
+        inputCollections.push_back( evt->getCollection( colName ) ) ;
+      }
+      catch( EVENT::DataNotAvailableException &) {
+        log<DEBUG4>() << "Collection " << colName << " is unavailable in event " << evt->getEventNumber() << std::endl ;
+      }
     }
-    catch( EVENT::DataNotAvailableException &) {
-      log<DEBUG4>() << "Collection " << _inputCollectionName.get() << " is unavailable in event " << evt->getEventNumber() << std::endl ;
+    if( inputCollections.empty() ) {
       return ;
     }
+    // all the input collections are digitised in the same output collection
+    const auto cellIDFields = CellIDFields::get( inputCollections.front() ) ;
+    for( auto inputCollection : inputCollections ) {
+      if( CellIDFields::get( inputCollection ) != cellIDFields ) {
+        marlin::ProcessorApi::abort( this, "Input collections have different cellID encodings" ) ;
+      }
+    }
+    const CellIDField layerField = cellIDFields->field( "layer" ) ;
     // output collections
     auto outputCollection = std::make_unique<IMPL::LCCollectionVec>( EVENT::LCIO::TRACKERHITPLANE ) ;
     auto outputRelCollection = std::make_unique<IMPL::LCCollectionVec>( EVENT::LCIO::LCRELATION ) ;
@@ -184,153 +215,148 @@ namespace marlinreco_mt {
     outputRelCollection->setFlag( lcFlag.getFlag() ) ;
     // cellID utils
     UTIL::CellIDEncoder<IMPL::TrackerHitPlaneImpl> cellid_encoder( UTIL::LCTrackerCellID::encoding_string() , outputCollection.get() ) ;
-    UTIL::CellIDDecoder<EVENT::SimTrackerHit> cellid_decoder( inputCollection ) ;
-    
-    int nSimHits = inputCollection->getNumberOfElements() ;
-    log<DEBUG4>() << " processing collection " << _inputCollectionName.get()  << " with " <<  nSimHits  << " hits ... " << std::endl ;
     
     unsigned nCreatedHits = 0 ;
     unsigned nDismissedHits = 0 ;
     
-    for( int i=0 ; i<nSimHits ; ++i ) {
-      auto simTHit = dynamic_cast<EVENT::SimTrackerHit*>( inputCollection->getElementAt( i ) ) ;
+    for( std::size_t c=0 ; c<inputCollections.size() ; ++c ) {
+      auto inputCollection = inputCollections[c] ;
+      int nSimHits = inputCollection->getNumberOfElements() ;
+      log<DEBUG4>() << " processing collection " << c << " with " <<  nSimHits  << " hits ... " << std::endl ;
+    
+      for( int i=0 ; i<nSimHits ; ++i ) {
+        auto simTHit = dynamic_cast<EVENT::SimTrackerHit*>( inputCollection->getElementAt( i ) ) ;
 
-      if( simTHit->getEDep() < _minEnergy.get() ) {
-        log<DEBUG>() << "Hit with insufficient energy " << simTHit->getEDep()*1e6 << " keV" << std::endl ;
-        continue;
-      }
-      const int cellID0 = simTHit->getCellID0() ;
+        if( simTHit->getEDep() < _minEnergy.get() ) {
+          log<DEBUG>() << "Hit with insufficient energy " << simTHit->getEDep()*1e6 << " keV" << std::endl ;
+          continue;
+        }
+        const int cellID0 = simTHit->getCellID0() ;
 
-      //***********************************************************
-      // get the measurement surface for this hit using the CellID
-      //***********************************************************
+        //***********************************************************
+        // get the measurement surface for this hit using the CellID
+        //***********************************************************
 
-      auto findIter = _surfaceMap->find( cellID0 ) ;
+        const SurfaceData *surfaceData = _surfaces->find( cellID0 ) ;
 
-      if( findIter == _surfaceMap->end() ) {
-        std::stringstream err ; 
-        err << " DDPlanarDigiProcessor::processEvent(): no surface found for cellID : " << cellid_decoder( simTHit ).valueString() ;
-        marlin::ProcessorApi::abort( this, err.str() ) ;
-      }
+        if( nullptr == surfaceData ) {
+          std::stringstream err ; 
+          err << " DDPlanarDigiProcessor::processEvent(): no surface found for cellID : " << cellIDFields->valueString( simTHit ) ;
+          marlin::ProcessorApi::abort( this, err.str() ) ;
+        }
       
-      const auto surf = findIter->second ;
-      int layer = cellid_decoder( simTHit )["layer"] ;
-      dd4hep::rec::Vector3D oldPos( simTHit->getPosition()[0], simTHit->getPosition()[1], simTHit->getPosition()[2] ) ;
-      dd4hep::rec::Vector3D newPos ;
+        int layer = layerField( simTHit ) ;
+        dd4hep::rec::Vector3D oldPos( simTHit->getPosition()[0], simTHit->getPosition()[1], simTHit->getPosition()[2] ) ;
+        dd4hep::rec::Vector3D newPos ;
       
-      //************************************************************
-      // Check if Hit is inside senstive 
-      //************************************************************ 
+        //************************************************************
+        // Check if Hit is inside senstive 
+        //************************************************************ 
                                    
-      if ( ! surf->insideBounds( dd4hep::mm * oldPos ) ) {      
-        if( _forceHitsOntoSurface.get() ) {
-          dd4hep::rec::Vector2D lv = surf->globalToLocal( dd4hep::mm * oldPos  ) ;
-          dd4hep::rec::Vector3D oldPosOnSurf = (1./dd4hep::mm) * surf->localToGlobal( lv ) ; 
-          log<DEBUG3>() << " moved to " << oldPosOnSurf << " distance " << (oldPosOnSurf-oldPos).r() << std::endl ;       
-          oldPos = oldPosOnSurf ;
-        } 
-        else {
-          ++nDismissedHits;       
-          continue; 
+        if ( ! surfaceData->insideBounds( dd4hep::mm * oldPos ) ) {      
+          if( _forceHitsOntoSurface.get() ) {
+            dd4hep::rec::Vector2D lv = surfaceData->globalToLocal( dd4hep::mm * oldPos  ) ;
+            dd4hep::rec::Vector3D oldPosOnSurf = (1./dd4hep::mm) * surfaceData->localToGlobal( lv ) ; 
+            log<DEBUG3>() << " moved to " << oldPosOnSurf << " distance " << (oldPosOnSurf-oldPos).r() << std::endl ;       
+            oldPos = oldPosOnSurf ;
+          } 
+          else {
+            ++nDismissedHits;       
+            continue; 
+          }
         }
-      }
-      //**************************************************************************
-      // Try to smear the hit but ensure the hit is inside the sensitive region
-      //**************************************************************************
-      dd4hep::rec::Vector3D u = surf->u() ;
-      dd4hep::rec::Vector3D v = surf->v() ;
-      // get local coordinates on surface
-      dd4hep::rec::Vector2D lv = surf->globalToLocal( dd4hep::mm * oldPos  ) ;
-      double uL = lv[0] / dd4hep::mm ;
-      double vL = lv[1] / dd4hep::mm ;
-      bool accept_hit = false ;
-      unsigned  tries   =  0 ;              
-      float resU = ( _resolutionU.get().size() > 1 ?   _resolutionU.get().at(  layer )     : _resolutionU.get().at(0)   )  ;
-      float resV = ( _resolutionV.get().size() > 1 ?   _resolutionV.get().at(  layer )     : _resolutionV.get().at(0)   )  ; 
+        //**************************************************************************
+        // Try to smear the hit but ensure the hit is inside the sensitive region
+        //**************************************************************************
+        // get local coordinates on surface
+        dd4hep::rec::Vector2D lv = surfaceData->globalToLocal( dd4hep::mm * oldPos  ) ;
+        double uL = lv[0] / dd4hep::mm ;
+        double vL = lv[1] / dd4hep::mm ;
+        bool accept_hit = false ;
+        unsigned  tries   =  0 ;              
+        float resU = ( _resolutionU.get().size() > 1 ?   _resolutionU.get().at(  layer )     : _resolutionU.get().at(0)   )  ;
+        float resV = ( _resolutionV.get().size() > 1 ?   _resolutionV.get().at(  layer )     : _resolutionV.get().at(0)   )  ; 
       
-      while( tries <  DDPlanarDigiProcessor::SmearingNMaxTries ) {
+        while( tries <  DDPlanarDigiProcessor::SmearingNMaxTries ) {
       
-        if( tries > 0 ) {
-          log<DEBUG0>() << "retry smearing for " <<  cellid_decoder( simTHit ).valueString() << " : retries " << tries << std::endl ;
-        } 
-        double uSmear = gaussian( generator, std::normal_distribution<double>::param_type( 0., resU ) ) ;
-        double vSmear = gaussian( generator, std::normal_distribution<double>::param_type( 0., resV ) ) ;
-        dd4hep::rec::Vector3D newPosTmp = 1./dd4hep::mm  * 
-        ( ! _isStrip.get()  ? surf->localToGlobal( dd4hep::rec::Vector2D (  ( uL + uSmear ) * dd4hep::mm, ( vL + vSmear )  *dd4hep::mm ) )  :
-                              surf->localToGlobal( dd4hep::rec::Vector2D (  ( uL + uSmear ) * dd4hep::mm,          0.                  ) ) ) ;
-        log<DEBUG1>() << " hit at    : " << oldPos 
-                                << " smeared to: " << newPosTmp
-                                << " uL: " << uL 
-                                << " vL: " << vL 
-                                << " uSmear: " << uSmear
-                                << " vSmear: " << vSmear
-                                << std::endl ;
-        if ( surf->insideBounds( dd4hep::mm * newPosTmp ) ) { 
-          accept_hit = true ;
-          newPos     = newPosTmp ;
-          break;  
+          if( tries > 0 ) {
+            log<DEBUG0>() << "retry smearing for " <<  cellIDFields->valueString( simTHit ) << " : retries " << tries << std::endl ;
+          } 
+          double uSmear = gaussian( generator, std::normal_distribution<double>::param_type( 0., resU ) ) ;
+          double vSmear = gaussian( generator, std::normal_distribution<double>::param_type( 0., resV ) ) ;
+          dd4hep::rec::Vector3D newPosTmp = 1./dd4hep::mm  * 
+          ( ! _isStrip.get()  ? surfaceData->localToGlobal( dd4hep::rec::Vector2D (  ( uL + uSmear ) * dd4hep::mm, ( vL + vSmear )  *dd4hep::mm ) )  :
+                                surfaceData->localToGlobal( dd4hep::rec::Vector2D (  ( uL + uSmear ) * dd4hep::mm,          0.                  ) ) ) ;
+          log<DEBUG1>() << " hit at    : " << oldPos 
+                                  << " smeared to: " << newPosTmp
+                                  << " uL: " << uL 
+                                  << " vL: " << vL 
+                                  << " uSmear: " << uSmear
+                                  << " vSmear: " << vSmear
+                                  << std::endl ;
+          if ( surfaceData->insideBounds( dd4hep::mm * newPosTmp ) ) { 
+            accept_hit = true ;
+            newPos     = newPosTmp ;
+            break;  
+          } 
+          else {   
+            log<DEBUG1>() << "  hit at " << newPosTmp 
+                                    << " " << cellIDFields->valueString( simTHit ) 
+                                    << " is not on surface " 
+                                    << " distance: " << surfaceData->distance( dd4hep::mm * newPosTmp ) 
+                                    << std::endl;        
+          }
+          ++tries;
+        }
+        if( not accept_hit ) {
+          log<DEBUG4>() << "hit could not be smeared within ladder after " <<  DDPlanarDigiProcessor::SmearingNMaxTries << "  tries: hit dropped"  << std::endl ;
+          ++nDismissedHits ;
+          continue ; 
+        }
+        //**************************************************************************
+        // Store hit variables to TrackerHitPlaneImpl
+        //**************************************************************************
+        const int cellID1 = simTHit->getCellID1() ;
+        float u_direction[2] = { surfaceData->_uDirection[0], surfaceData->_uDirection[1] } ;
+        float v_direction[2] = { surfaceData->_vDirection[0], surfaceData->_vDirection[1] } ;
+        auto trkHit = std::make_unique<IMPL::TrackerHitPlaneImpl>() ;
+        trkHit->setCellID0( cellID0 ) ;
+        trkHit->setCellID1( cellID1 ) ;
+        trkHit->setPosition( newPos.const_array()  ) ;
+        trkHit->setTime( simTHit->getTime() ) ;
+        trkHit->setEDep( simTHit->getEDep() ) ;
+        trkHit->setU( u_direction ) ;
+        trkHit->setV( v_direction ) ;
+        trkHit->setdU( resU ) ;    
+        log<DEBUG0>() << " U[0] = "<< u_direction[0] << " U[1] = "<< u_direction[1] 
+                      << " V[0] = "<< v_direction[0] << " V[1] = "<< v_direction[1]
+                      << std::endl ;
+        if( _isStrip.get() ) {
+          // store the resolution from the length of the wafer - in case a fitter might want to treat this as 2d hit ....
+          double stripRes = (surfaceData->_lengthAlongV / dd4hep::mm ) / std::sqrt( 12. ) ;
+          trkHit->setdV( stripRes ); 
         } 
-        else {   
-          log<DEBUG1>() << "  hit at " << newPosTmp 
-                                  << " " << cellid_decoder( simTHit).valueString() 
-                                  << " is not on surface " 
-                                  << " distance: " << surf->distance( dd4hep::mm * newPosTmp ) 
-                                  << std::endl;        
+        else {
+          trkHit->setdV( resV ) ;
         }
-        ++tries;
-      }
-      if( not accept_hit ) {
-        log<DEBUG4>() << "hit could not be smeared within ladder after " <<  DDPlanarDigiProcessor::SmearingNMaxTries << "  tries: hit dropped"  << std::endl ;
-        ++nDismissedHits ;
-        continue ; 
-      }
-      //**************************************************************************
-      // Store hit variables to TrackerHitPlaneImpl
-      //**************************************************************************
-      const int cellID1 = simTHit->getCellID1() ;
-      float u_direction[2] ;
-      u_direction[0] = u.theta();
-      u_direction[1] = u.phi();    
-      float v_direction[2] ;
-      v_direction[0] = v.theta();
-      v_direction[1] = v.phi();
-      auto trkHit = std::make_unique<IMPL::TrackerHitPlaneImpl>() ;
-      trkHit->setCellID0( cellID0 ) ;
-      trkHit->setCellID1( cellID1 ) ;
-      trkHit->setPosition( newPos.const_array()  ) ;
-      trkHit->setTime( simTHit->getTime() ) ;
-      trkHit->setEDep( simTHit->getEDep() ) ;
-      trkHit->setU( u_direction ) ;
-      trkHit->setV( v_direction ) ;
-      trkHit->setdU( resU ) ;    
-      log<DEBUG0>() << " U[0] = "<< u_direction[0] << " U[1] = "<< u_direction[1] 
-                    << " V[0] = "<< v_direction[0] << " V[1] = "<< v_direction[1]
-                    << std::endl ;
-      if( _isStrip.get() ) {
-        // store the resolution from the length of the wafer - in case a fitter might want to treat this as 2d hit ....
-        double stripRes = (surf->length_along_v() / dd4hep::mm ) / std::sqrt( 12. ) ;
-        trkHit->setdV( stripRes ); 
-      } 
-      else {
-        trkHit->setdV( resV ) ;
-      }
-      if( _isStrip.get() ) {
-        trkHit->setType( UTIL::set_bit( trkHit->getType(), UTIL::ILDTrkHitTypeBit::ONE_DIMENSIONAL ) ) ;
+        if( _isStrip.get() ) {
+          trkHit->setType( UTIL::set_bit( trkHit->getType(), UTIL::ILDTrkHitTypeBit::ONE_DIMENSIONAL ) ) ;
+        }
+        //**************************************************************************
+        // Set Relation to SimTrackerHit
+        //**************************************************************************           
+        auto rel = new IMPL::LCRelationImpl() ;
+        rel->setFrom ( trkHit.get() ) ;
+        rel->setTo ( simTHit );
+        rel->setWeight( 1.0 ) ;
+        outputRelCollection->addElement( rel ) ;
+        //**************************************************************************
+        // Add hit to collection
+        //**************************************************************************    
+        outputCollection->addElement( trkHit.release() ) ; 
+        ++nCreatedHits ;
+        log<DEBUG3>() << "-------------------------------------------------------" << std::endl ;
       }
-      //**************************************************************************
-      // Set Relation to SimTrackerHit
-      //**************************************************************************           
-      auto rel = new IMPL::LCRelationImpl() ;
-      rel->setFrom ( trkHit.get() ) ;
-      rel->setTo ( simTHit );
-      rel->setWeight( 1.0 ) ;
-      outputRelCollection->addElement( rel ) ;
-      //**************************************************************************
-      // Add hit to collection
-      //**************************************************************************    
-      outputCollection->addElement( trkHit.release() ) ; 
-      ++nCreatedHits ;
-      log<DEBUG3>() << "-------------------------------------------------------" << std::endl ;
     }
     //**************************************************************************
     // Add collection to event
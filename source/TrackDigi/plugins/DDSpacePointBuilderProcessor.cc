@@ -8,7 +8,7 @@
 #include <IMPL/LCFlagImpl.h>
 #include <IMPL/LCRelationImpl.h>
 #include <UTIL/LCRelationNavigator.h>
-#include <UTIL/BitField64.h>
+#include <UTIL/CellIDEncoder.h>
 #include <UTIL/LCTrackerConf.h>
 #include <UTIL/ILDConf.h>
 
@@ -20,16 +20,17 @@
 using namespace marlin::loglevel ;
 
 // -- dd4hep headers
-#include "DD4hep/Detector.h"
 #include "DD4hep/DD4hepUnits.h"
 #include "DDRec/Vector2D.h"
 #include "DDRec/Vector3D.h"
 #include "DDRec/ISurface.h"
-#include "DDRec/SurfaceManager.h"
-#include "DDRec/SurfaceHelper.h"
-#include "DDRec/DetectorData.h"
+
+// -- marlinrecomt headers
+#include <MarlinRecoMT/CellIDFields.h>
+#include <MarlinRecoMT/GeometrySnapshot.h>
 
 // -- std headers
+#include <cstdint>
 #include <memory>
 
 // -- root headers
@@ -156,7 +157,14 @@ namespace marlinreco_mt {
                             "Name of dub detector" , "SIT" } ;
 
     dd4hep::rec::Vector3D                    _nominalVertex {} ;
-    const dd4hep::rec::SurfaceMap           *_surfaceMap {nullptr} ;
+    std::shared_ptr<const GeometrySnapshot>  _geometry {nullptr} ;
+    const SurfaceTable                      *_surfaces {nullptr} ;
+    const ZDiskPetalsGeometry               *_petals {nullptr} ;
+    CellIDField                              _subdetField {} ;
+    CellIDField                              _sideField {} ;
+    CellIDField                              _layerField {} ;
+    CellIDField                              _moduleField {} ;
+    CellIDField                              _sensorField {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -173,10 +181,28 @@ namespace marlinreco_mt {
     // usually a good idea to
     printParameters() ;
     _nominalVertex.fill( _nominalVertexX, _nominalVertexY, _nominalVertexZ ) ;
-    dd4hep::Detector& theDetector = dd4hep::Detector::getInstance() ;
-    dd4hep::rec::SurfaceManager& surfMan = *theDetector.extension<dd4hep::rec::SurfaceManager>() ;
-    dd4hep::DetElement det = theDetector.detector( _subDetectorName ) ;
-    _surfaceMap = surfMan.map( det.name() ) ;
+    _geometry = GeometrySnapshot::instance() ;
+    _surfaces = _geometry->surfaces( _subDetectorName ) ;
+    if( nullptr == _surfaces ) {
+      marlin::ProcessorApi::abort( this, "Could not find surfaces for detector: " + _subDetectorName.get() ) ;
+    }
+    // only for the FTD
+    _petals = _geometry->zDiskPetals( _subDetectorName ) ;
+    const auto cellIDFields = CellIDFields::get( UTIL::LCTrackerCellID::encoding_string() ) ;
+    _subdetField = cellIDFields->field( UTIL::LCTrackerCellID::subdet() ) ;
+    _sideField   = cellIDFields->field( UTIL::LCTrackerCellID::side() ) ;
+    _layerField  = cellIDFields->field( UTIL::LCTrackerCellID::layer() ) ;
+    _moduleField = cellIDFields->field( UTIL::LCTrackerCellID::module() ) ;
+    _sensorField = cellIDFields->field( UTIL::LCTrackerCellID::sensor() ) ;
+    // the space points are checked against the bounds of the sensors paired at the back only
+    for( auto cellID : _surfaces->cellIDs() ) {
+      for( auto cellID0Back : getCellID0sAtBack( static_cast<int>( cellID ) ) ) {
+        auto surface = _surfaces->find( cellID0Back ) ;
+        if( nullptr != surface && not surface->hasBounds() ) {
+          marlin::ProcessorApi::abort( this, "The bounds of the " + _subDetectorName.get() + " surfaces are not in the geometry cache file, load the DD4hep geometry instead" ) ;
+        }
+      }
+    }
   }
 
   //--------------------------------------------------------------------------
@@ -343,16 +369,16 @@ namespace marlinreco_mt {
     const auto mmInverse = ( 1. / dd4hep::mm ) ;
     // point A
     dd4hep::rec::Vector3D positionA( a->getPosition()[0] * dd4hep::mm, a->getPosition()[1]* dd4hep::mm, a->getPosition()[2] * dd4hep::mm ) ;
-    auto surfaceA = _surfaceMap->find( a->getCellID0() )->second ;
-    auto normalA = mmInverse * surfaceA->normal().to<TVector3>() ;
-    auto uA = mmInverse * surfaceA->u().to<TVector3>() ;
-    auto vA = mmInverse * surfaceA->v().to<TVector3>() ;
+    auto surfaceA = _surfaces->find( a->getCellID0() ) ;
+    auto normalA = mmInverse * surfaceA->_normal.to<TVector3>() ;
+    auto uA = mmInverse * surfaceA->_u.to<TVector3>() ;
+    auto vA = mmInverse * surfaceA->_v.to<TVector3>() ;
     // point B
     dd4hep::rec::Vector3D positionB( b->getPosition()[0] * dd4hep::mm, b->getPosition()[1]* dd4hep::mm, b->getPosition()[2] * dd4hep::mm ) ;
-    auto surfaceB = _surfaceMap->find( b->getCellID0() )->second ;
-    auto normalB = mmInverse * surfaceB->normal().to<TVector3>() ;
-    auto uB = mmInverse * surfaceB->u().to<TVector3>() ;
-    auto vB = mmInverse * surfaceB->v().to<TVector3>() ;
+    auto surfaceB = _surfaces->find( b->getCellID0() ) ;
+    auto normalB = mmInverse * surfaceB->_normal.to<TVector3>() ;
+    auto uB = mmInverse * surfaceB->_u.to<TVector3>() ;
+    auto vB = mmInverse * surfaceB->_v.to<TVector3>() ;
     // First: check if the two measurement surfaces are parallel (i.e. the w are parallel or antiparallel)
     double angle = std::fabs( normalB.Angle( normalA ) ) ;
     static const double angleLimit = 1.*M_PI/180.;
@@ -453,35 +479,32 @@ namespace marlinreco_mt {
   std::vector<int> DDSpacePointBuilderProcessor::getCellID0sAtBack( int cellID0 ) const {
     std::vector<int> back {} ;  
     // find out detector, layer
-    UTIL::BitField64 cellID( UTIL::LCTrackerCellID::encoding_string() );
-    cellID.setValue( cellID0 ) ;
-    int subdet = cellID[ UTIL::LCTrackerCellID::subdet() ] ;
-    int layer  = cellID[ UTIL::LCTrackerCellID::layer() ] ;
+    const std::uint64_t cellID = CellIDField::cellIDValue( cellID0, 0 ) ;
+    int subdet = _subdetField( cellID ) ;
+    int layer  = _layerField( cellID ) ;
     if ( subdet != UTIL::ILDDetID::FTD ) {
       // check if sensor is in front
       // even layers are front sensors
       if( layer%2 == 0 ) { 
-        cellID[ UTIL::LCTrackerCellID::layer() ] = layer + 1 ;
         // it is assumed that the even layers are the front layers
         // and the following odd ones the back layers        
-        back.push_back( cellID.lowWord() ) ;
+        back.push_back( static_cast<int>( _layerField.set( cellID, layer + 1 ) ) ) ;
       }
     }
     else {
-      dd4hep::Detector & theDetector2 = dd4hep::Detector::getInstance() ;
-      dd4hep::DetElement ftdDE = theDetector2.detector( _subDetectorName ) ;
-      dd4hep::rec::ZDiskPetalsData* ft = ftdDE.extension<dd4hep::rec::ZDiskPetalsData>() ;
-      int sensor = cellID[ UTIL::LCTrackerCellID::sensor() ] ;
-      int Nsensors = ft->layers.at(layer).sensorsPerPetal ;
+      if( nullptr == _petals ) {
+        throw EVENT::Exception( "DDSpacePointBuilderProcessor: no ZDiskPetalsData for detector " + _subDetectorName.get() ) ;
+      }
+      int sensor = _sensorField( cellID ) ;
+      int Nsensors = _petals->_layers.at(layer)._sensorsPerPetal ;
       log<DEBUG3>() << " layer " << layer << " sensors " << Nsensors << std::endl ;
       log<DEBUG3>() << " so sensor " << sensor << " is connected with sensor " << sensor + Nsensors/2 << std::endl ;
       // check if sensor is in front
       if (sensor <= Nsensors / 2 ) {
-        cellID[ UTIL::LCTrackerCellID::sensor() ] = sensor + Nsensors / 2 ; 
         // it is assumed, that sensors 1 until n/2 will be on front
         // and sensor n/2 + 1 until n are at the back
         // so the sensor x, will have sensor x+n/2 at the back
-        back.push_back( cellID.lowWord() ) ;
+        back.push_back( static_cast<int>( _sensorField.set( cellID, sensor + Nsensors / 2 ) ) ) ;
       }
     }
     return back ;
@@ -492,13 +515,12 @@ namespace marlinreco_mt {
   std::string DDSpacePointBuilderProcessor::getCellID0Info( int cellID0 ) const {
     std::stringstream ss ;
     //find out layer, module, sensor
-    UTIL::BitField64  cellID( UTIL::LCTrackerCellID::encoding_string() ) ;
-    cellID.setValue( cellID0 ) ;
-    int subdet = cellID[ UTIL::LCTrackerCellID::subdet() ] ;
-    int side   = cellID[ UTIL::LCTrackerCellID::side() ] ;
-    int module = cellID[ UTIL::LCTrackerCellID::module() ] ;
-    int sensor = cellID[ UTIL::LCTrackerCellID::sensor() ] ;
-    int layer  = cellID[ UTIL::LCTrackerCellID::layer() ] ;    
+    const std::uint64_t cellID = CellIDField::cellIDValue( cellID0, 0 ) ;
+    int subdet = _subdetField( cellID ) ;
+    int side   = _sideField( cellID ) ;
+    int module = _moduleField( cellID ) ;
+    int sensor = _sensorField( cellID ) ;
+    int layer  = _layerField( cellID ) ;    
     ss << "(su" << subdet << ",si" << side << ",la" << layer << ",mo" << module << ",se" << sensor << ")" ;
     return ss.str() ;
   }
@@ -0,0 +1,499 @@
+// -- lcio headers
+#include <EVENT/LCIO.h>
+#include <EVENT/MCParticle.h>
+#include <EVENT/SimTrackerHit.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCFlagImpl.h>
+#include <IMPL/LCRelationImpl.h>
+#include <IMPL/TrackerHitImpl.h>
+#include <UTIL/CellIDEncoder.h>
+#include <UTIL/LCTrackerConf.h>
+#include <UTIL/ILDConf.h>
+
+// -- marlin headers
+#include <marlin/Exceptions.h>
+#include <marlin/Processor.h>
+#include <marlin/ProcessorApi.h>
+#include <marlin/PluginManager.h>
+#include <marlin/Logging.h>
+using namespace marlin::loglevel ;
+
+// -- dd4hep headers
+#include "DDRec/Vector2D.h"
+#include "DDRec/Vector3D.h"
+#include "DD4hep/DD4hepUnits.h"
+
+// -- marlinrecomt headers
+#include <MarlinRecoMT/Circle.h>
+#include <MarlinRecoMT/FixedPadSizeDiskLayout.h>
+#include <MarlinRecoMT/GeometrySnapshot.h>
+#include <MarlinRecoMT/LCGeometryTypes.h>
+#include <MarlinRecoMT/TPCModularEndplate.h>
+#include <MarlinRecoMT/TPCVoxelGrid.h>
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace marlinreco_mt {
+
+  /** ======= DDTPCDigiProcessor ========== <br>
+   * Produces a TPC TrackerHit collection from SimTrackerHit collections, smeared in r-phi and z.
+   * The hits are first placed at the center of their pad row. A search is then
+   * made for adjacent hits on a pad row (see TPCVoxelGrid): if they are closer in z and r-phi than DoubleHitResolutionZ
+   * and DoubleHitResolutionRPhi they are considered to overlap. Clusters of up to MaxClusterSizeForMerge
+   * hits are merged into a single tracker hit, with the position given as the average position of the
+   * hits in phi and in z. Larger clusters are considered as unresolved and are not digitised.
+   * Hits falling into the gaps between the endplate modules are dropped.
+   * The resolution in r-phi depends on the drift length, on the angle between the track and the pad
+   * (padPhi) and on the polar angle of the track (padTheta). The angles are taken from the hit momentum
+   * if stored, else from a circle through the neighbour hits of the same MCParticle.
+   *
+   * All the event state (pad row voxels, random engine) is local to processEvent(): the processor
+   * is reentrant and can run with clone="false". The pad layout and endplate model are built in init()
+   * from the TPC geometry snapshot and only read afterwards.
+   *
+   * <h4>Input collections and prerequisites</h4>
+   * Processor requires the pad row based TPC SimTrackerHit collection <br>
+   * <h4>Output</h4>
+   * Processor produces a collection of smeared TrackerHits and the TrackerHit to SimTrackerHit relations <br>
+   * @param TPCPadRowHitCollectionName The name of the pad row based SimTrackerHit collection (default name TPCCollection) <br>
+   * @param TPCLowPtCollectionName The name of the low pt SimTrackerHit collection (default name TPCLowPtCollection) <br>
+   * @param TPCTrackerHitsCol The name of the output TrackerHit collection (default name TPCTrackerHits) <br>
+   * @param SimTrkHitRelCollection The name of the TrackerHit to SimTrackerHit relation collection (default name TPCTrackerHitRelations) <br>
+   * <br>
+   *
+   * @author S. Aplin, DESY, F. Gaede, DESY (MarlinReco version)
+   */
+  class DDTPCDigiProcessor : public marlin::Processor {
+    using RandomGenerator = std::mt19937 ;
+
+  public:
+    ~DDTPCDigiProcessor() = default ;
+    DDTPCDigiProcessor(const DDTPCDigiProcessor&) = delete ;
+    DDTPCDigiProcessor& operator=(const DDTPCDigiProcessor&) = delete ;
+
+    /**
+     *  @brief  Constructor
+     */
+    DDTPCDigiProcessor() ;
+
+    /** Called at the begin of the job before anything is read.
+     * Use to initialize the processor, e.g. book histograms.
+     */
+    void init() ;
+
+    /** Called for every event - the working horse.
+     */
+    void processEvent( EVENT::LCEvent * evt ) ;
+
+  private:
+    /** Compute the pad phi and theta angles of a sim hit. The neighbour hits are the
+     *  previous and next hits in the collection, used if the momentum is not stored
+     */
+    void padAngles( const EVENT::SimTrackerHit *simHit, const EVENT::SimTrackerHit *previousHit, const EVENT::SimTrackerHit *nextHit, bool hasMomentum, double &padPhi, double &padTheta ) const ;
+
+    /** Create the voxels of the sim hits of a collection. The sim hit of voxel i is simHits[i].
+     *  Returns the number of sim hits dropped
+     */
+    unsigned int createVoxels( const EVENT::LCCollection *collection, TPCVoxelGrid &voxels, std::vector<EVENT::SimTrackerHit*> &simHits ) ;
+
+  protected:
+    // processor parameters
+    marlin::InputCollectionProperty _padRowHitColName {this, EVENT::LCIO::SIMTRACKERHIT, "TPCPadRowHitCollectionName" ,
+                                "Name of the default pad-row based SimTrackerHit collection", "TPCCollection" } ;
+
+    marlin::InputCollectionProperty _lowPtHitsColName {this, EVENT::LCIO::SIMTRACKERHIT, "TPCLowPtCollectionName" ,
+                                "Name of the LowPt SimTrackerHit collection (not read if empty)", "TPCLowPtCollection" } ;
+
+    marlin::OutputCollectionProperty _trackerHitsColName {this, EVENT::LCIO::TRACKERHIT, "TPCTrackerHitsCol" ,
+                                "Name of the Output TrackerHit collection", "TPCTrackerHits" } ;
+
+    marlin::OutputCollectionProperty _outRelColName {this, EVENT::LCIO::LCRELATION, "SimTrkHitRelCollection" ,
+                                "Name of TrackerHit SimTrackHit relation collection", "TPCTrackerHitRelations" } ;
+
+    marlin::Property<bool> _useRawHitsToStoreSimhitPointer {this, "UseRawHitsToStoreSimhitPointer" ,
+                                "Store the pointer to the SimHits in the RawHits?", false } ;
+
+    marlin::Property<bool> _rejectCellID0 {this, "RejectCellID0" ,
+                                "whether or not to use hits without proper cell ID (cell ID = 0)", true } ;
+
+    marlin::Property<float> _pointResoPadPhi {this, "PointResolutionPadPhi" ,
+                                "Pad Phi Resolution constant in TPC", 0.900 } ;
+
+    marlin::Property<float> _pointResoRPhi0 {this, "PointResolutionRPhi" ,
+                                "R-Phi Resolution constant in TPC", 0.050 } ;
+
+    marlin::Property<float> _diffRPhi {this, "DiffusionCoeffRPhi" ,
+                                "R-Phi Diffusion Coefficent in TPC", 0.025 } ;
+
+    marlin::Property<int> _nEff {this, "N_eff" ,
+                                "Number of Effective electrons per pad in TPC", 22 } ;
+
+    marlin::Property<float> _pointResoZ0 {this, "PointResolutionZ" ,
+                                "TPC Z Resolution Coefficent independent of diffusion", 0.4 } ;
+
+    marlin::Property<float> _diffZ {this, "DiffusionCoeffZ" ,
+                                "TPC Z Diffusion Coefficent", 0.08 } ;
+
+    marlin::Property<float> _doubleHitResZ {this, "DoubleHitResolutionZ" ,
+                                "Defines the minimum distance for two seperable hits in Z", 5.0 } ;
+
+    marlin::Property<float> _doubleHitResRPhi {this, "DoubleHitResolutionRPhi" ,
+                                "Defines the minimum distance for two seperable hits in RPhi", 2.0 } ;
+
+    marlin::Property<int> _maxMerge {this, "MaxClusterSizeForMerge" ,
+                                "Defines the maximum number of adjacent hits which can be merged", 3 } ;
+
+    marlin::Property<float> _bField {this, "BField" ,
+                                "The magnetic field in Tesla used for the scaling of the r-phi diffusion, overrides the field of the geometry if positive", 0. } ;
+
+    marlin::Property<EVENT::IntVec> _tpcEndPlateModuleNumbers {this, "TPCEndPlateModuleNumbers" ,
+                                "Number of modules in the rings of the TPC endplate", {14, 18, 23, 28, 32, 37, 42, 46} } ;
+
+    marlin::Property<EVENT::FloatVec> _tpcEndPlateModulePhi0s {this, "TPCEndPlateModulePhi0s" ,
+                                "Phi0s of modules in the rings of the TPC endplate (default: 0 for all rings)", {} } ;
+
+    marlin::Property<float> _tpcEndPlateModuleGapPhi {this, "TPCEndPlateModuleGapPhi" ,
+                                "Gap size in mm of the gaps between the endplace modules in Phi", 1. } ;
+
+    marlin::Property<std::string> _subDetectorName {this, "SubDetectorName" ,
+                                "Name of the TPC sub detector", "TPC" } ;
+
+    // geometry, read only after init
+    std::shared_ptr<const GeometrySnapshot> _geometry {nullptr} ;
+    const dd4hep::rec::FixedPadSizeTPCData* _tpc {nullptr} ;
+    std::unique_ptr<FixedPadSizeDiskLayout> _padLayout {nullptr} ;
+    std::unique_ptr<TPCModularEndplate> _tpcEP {nullptr} ;
+    /// The magnetic field in Tesla
+    double _bFieldTesla {0.} ;
+    /// The maximum drift length in mm
+    double _driftLength {0.} ;
+    /// The readout radial extent in mm
+    double _rMinReadout {0.} ;
+    double _rMaxReadout {0.} ;
+  };
+
+  //--------------------------------------------------------------------------
+
+  DDTPCDigiProcessor::DDTPCDigiProcessor() :
+    Processor("DDTPCDigiProcessor") {
+    // modify processor description
+    _description = "Produces TPC TrackerHit collection from SimTrackerHit collection, smeared in RPhi and Z. "
+      "Adjacent hits on a pad row closer than the double hit resolution are merged if their cluster is small enough, "
+      "else they are considered as unresolved and dropped" ;
+    // processEvent() only uses per-event data and the read-only geometry: one shared instance, run concurrently
+    forceRuntimeOption( Processor::RuntimeOption::Critical, false ) ;
+    forceRuntimeOption( Processor::RuntimeOption::Clone, false ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void DDTPCDigiProcessor::init() {
+    // usually a good idea to
+    printParameters() ;
+
+    // initalisation of random number generator
+    marlin::ProcessorApi::registerForRandomSeeds( this ) ;
+
+    _geometry = GeometrySnapshot::instance() ;
+    _tpc = _geometry->fixedPadSizeTPC( _subDetectorName.get() ) ;
+    if( nullptr == _tpc ) {
+      std::stringstream err ;
+      err << " Could not find FixedPadSizeTPCData for detector: " << _subDetectorName.get() ;
+      marlin::ProcessorApi::abort( this, err.str() ) ;
+    }
+    _bFieldTesla = ( _bField.get() > 0.f ) ? _bField.get() : _geometry->magneticField() / dd4hep::tesla ;
+    if( _bFieldTesla <= 0. ) {
+      marlin::ProcessorApi::abort( this, "No magnetic field in the geometry, set the BField parameter" ) ;
+    }
+    _driftLength = _tpc->driftLength / dd4hep::mm ;
+    _rMinReadout = _tpc->rMinReadout / dd4hep::mm ;
+    _rMaxReadout = _tpc->rMaxReadout / dd4hep::mm ;
+    _padLayout = std::make_unique<FixedPadSizeDiskLayout>( _tpc ) ;
+
+    const auto &moduleNumbers = _tpcEndPlateModuleNumbers.get() ;
+    const auto &modulePhi0s = _tpcEndPlateModulePhi0s.get() ;
+    if( moduleNumbers.empty() ) {
+      marlin::ProcessorApi::abort( this, "TPCEndPlateModuleNumbers: at least one endplate module ring is required" ) ;
+    }
+    if( not modulePhi0s.empty() and modulePhi0s.size() != moduleNumbers.size() ) {
+      std::stringstream err ;
+      err << "Inconsistent number of endplate module rings: TPCEndPlateModuleNumbers: " << moduleNumbers.size()
+          << " != TPCEndPlateModulePhi0s: " << modulePhi0s.size() ;
+      marlin::ProcessorApi::abort( this, err.str() ) ;
+    }
+    _tpcEP = std::make_unique<TPCModularEndplate>( _tpc ) ;
+    for( unsigned int i=0 ; i<moduleNumbers.size() ; ++i ) {
+      _tpcEP->addModuleRing( moduleNumbers[i], modulePhi0s.empty() ? 0. : modulePhi0s[i] ) ;
+    }
+    _tpcEP->initialize() ;
+
+    log<DEBUG4>() << "DDTPCDigiProcessor::init(): " << _padLayout->getNRows() << " pad rows, drift length "
+                  << _driftLength << " mm, magnetic field " << _bFieldTesla << " T" << std::endl ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void DDTPCDigiProcessor::padAngles( const EVENT::SimTrackerHit *simHit, const EVENT::SimTrackerHit *previousHit, const EVENT::SimTrackerHit *nextHit, bool hasMomentum, double &padPhi, double &padTheta ) const {
+    // default: perpendicular to the pad row, in the transverse plane
+    padPhi = M_PI / 2. ;
+    padTheta = M_PI / 2. ;
+    const LCVector3D thisPoint( simHit->getPosition()[0], simHit->getPosition()[1], simHit->getPosition()[2] ) ;
+    if( hasMomentum ) {
+      const LCVector3D mom( simHit->getMomentum()[0], simHit->getMomentum()[1], simHit->getMomentum()[2] ) ;
+      if( mom.rho() > 0. ) {
+        padPhi = std::fabs( std::remainder( thisPoint.phi() - mom.phi(), 2. * M_PI ) ) ;
+        padTheta = mom.theta() ;
+      }
+      return ;
+    }
+    // momentum not stored: use the neighbour hits of the same MCParticle
+    const auto mcp = simHit->getMCParticle() ;
+    if( nullptr == mcp or nullptr == previousHit or nullptr == nextHit or
+        previousHit->getMCParticle() != mcp or nextHit->getMCParticle() != mcp ) {
+      return ;
+    }
+    const double *mcpMomentum = mcp->getMomentum() ;
+    if( std::sqrt( mcpMomentum[0]*mcpMomentum[0] + mcpMomentum[1]*mcpMomentum[1] ) < 0.01 ) {
+      return ;
+    }
+    const dd4hep::rec::Vector2D precedingPoint( previousHit->getPosition()[0], previousHit->getPosition()[1] ) ;
+    const dd4hep::rec::Vector2D currentPoint( thisPoint.x(), thisPoint.y() ) ;
+    const dd4hep::rec::Vector2D followingPoint( nextHit->getPosition()[0], nextHit->getPosition()[1] ) ;
+    Circle circle ;
+    try {
+      circle = Circle( precedingPoint, currentPoint, followingPoint ) ;
+    }
+    catch( marlin::Exception & ) {
+      // colinear hits: keep the default angles
+      return ;
+    }
+    // the track direction is tangent to the circle at the current point. For nearly colinear
+    // hits the center is far away and the tangent tends to the chord direction, folded below
+    const double localPhi = std::atan2( thisPoint.y() - circle.center().v(), thisPoint.x() - circle.center().u() ) + M_PI / 2. ;
+    // the angle between the track and the radial direction, folded in [0,pi/2]
+    padPhi = std::fabs( std::remainder( thisPoint.phi() - localPhi, M_PI ) ) ;
+    // the polar angle from the neighbour hits
+    const double deltaZ = nextHit->getPosition()[2] - previousHit->getPosition()[2] ;
+    const double deltaXY = std::hypot( followingPoint.u() - precedingPoint.u(), followingPoint.v() - precedingPoint.v() ) ;
+    padTheta = std::atan2( deltaXY, deltaZ ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned int DDTPCDigiProcessor::createVoxels( const EVENT::LCCollection *collection, TPCVoxelGrid &voxels, std::vector<EVENT::SimTrackerHit*> &simHits ) {
+    const int nSimHits = collection->getNumberOfElements() ;
+    const bool hasMomentum = IMPL::LCFlagImpl( collection->getFlag() ).bitSet( EVENT::LCIO::THBIT_MOMENTUM ) ;
+    const double aResoPoint = _pointResoRPhi0.get() * _pointResoRPhi0.get() ;
+    const double aResoPad = _pointResoPadPhi.get() * _pointResoPadPhi.get() ;
+    const double bFieldScale = ( 6. / _bFieldTesla ) * ( 6. / _bFieldTesla ) ;
+    const double bResoDiffusion = ( _diffRPhi.get() * _diffRPhi.get() / _nEff.get() ) * bFieldScale ;
+    const double zResoPoint = _pointResoZ0.get() * _pointResoZ0.get() ;
+    const double zResoDiffusion = _diffZ.get() * _diffZ.get() ;
+    unsigned int nDropped = 0 ;
+    // select the hits, then compute their distance to the module boundaries and find their pads in one go
+    std::vector<int> selectedHits ;
+    std::vector<double> rhos, phis ;
+    selectedHits.reserve( nSimHits ) ;
+    rhos.reserve( nSimHits ) ;
+    phis.reserve( nSimHits ) ;
+    for( int i=0 ; i<nSimHits ; ++i ) {
+      auto simHit = static_cast<const EVENT::SimTrackerHit*>( collection->getElementAt( i ) ) ;
+      if( _rejectCellID0.get() and ( 0 == simHit->getCellID0() ) ) {
+        ++nDropped ;
+        continue ;
+      }
+      const double *pos = simHit->getPosition() ;
+      const double rho = std::hypot( pos[0], pos[1] ) ;
+      if( rho < _rMinReadout or rho > _rMaxReadout or std::fabs( pos[2] ) > _driftLength ) {
+        ++nDropped ;
+        continue ;
+      }
+      selectedHits.push_back( i ) ;
+      rhos.push_back( rho ) ;
+      phis.push_back( std::atan2( pos[1], pos[0] ) ) ;
+    }
+    // hits falling into the gaps between the endplate modules are lost
+    std::vector<double> gapDistances( selectedHits.size() ) ;
+    _tpcEP->computeDistancesRPhi( rhos, phis, gapDistances ) ;
+    std::size_t nSelected = 0 ;
+    for( std::size_t h=0 ; h<selectedHits.size() ; ++h ) {
+      if( gapDistances[h] < _tpcEndPlateModuleGapPhi.get() / 2. ) {
+        ++nDropped ;
+        continue ;
+      }
+      selectedHits[nSelected] = selectedHits[h] ;
+      rhos[nSelected] = rhos[h] ;
+      phis[nSelected] = phis[h] ;
+      ++nSelected ;
+    }
+    selectedHits.resize( nSelected ) ;
+    rhos.resize( nSelected ) ;
+    phis.resize( nSelected ) ;
+    std::vector<int> padIndices( selectedHits.size() ) ;
+    _padLayout->getNearestPads( rhos, phis, padIndices ) ;
+    voxels.reserve( voxels.numberOfVoxels() + selectedHits.size() ) ;
+    simHits.reserve( simHits.size() + selectedHits.size() ) ;
+
+    for( std::size_t h=0 ; h<selectedHits.size() ; ++h ) {
+      const int i = selectedHits[h] ;
+      auto simHit = static_cast<EVENT::SimTrackerHit*>( collection->getElementAt( i ) ) ;
+      const double *pos = simHit->getPosition() ;
+      const double phi = phis[h] ;
+      const int padIndex = padIndices[h] ;
+      // place the hit at the center of the pad row
+      const double rowRadius = _padLayout->getPadCenter( padIndex )[0] ;
+      // resolutions
+      double padPhi(0.), padTheta(0.) ;
+      const EVENT::SimTrackerHit *previousHit = ( i > 0 ) ? static_cast<const EVENT::SimTrackerHit*>( collection->getElementAt( i-1 ) ) : nullptr ;
+      const EVENT::SimTrackerHit *nextHit = ( i+1 < nSimHits ) ? static_cast<const EVENT::SimTrackerHit*>( collection->getElementAt( i+1 ) ) : nullptr ;
+      padAngles( simHit, previousHit, nextHit, hasMomentum, padPhi, padTheta ) ;
+      // hits beyond the drift length are already dropped
+      const double driftLength = _driftLength - std::fabs( pos[2] ) ;
+      const double sinPadPhi = std::sin( padPhi ) ;
+      const double aReso = aResoPoint + aResoPad * sinPadPhi * sinPadPhi ;
+      const double bReso = bResoDiffusion * std::sin( padTheta ) ;
+      const double rPhiRes = std::sqrt( aReso + bReso * driftLength ) ;
+      const double zRes = std::sqrt( zResoPoint + zResoDiffusion * driftLength ) ;
+      voxels.addVoxel( _padLayout->getRowNumber( padIndex ), rowRadius, phi, pos[2], simHit->getEDep(), rPhiRes, zRes ) ;
+      simHits.push_back( simHit ) ;
+    }
+    return nDropped ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void DDTPCDigiProcessor::processEvent( EVENT::LCEvent * evt ) {
+    // initalisation of random number generator
+    auto eventSeed = marlin::ProcessorApi::getRandomSeed( this, evt ) ;
+    log<DEBUG4>() << "seed set to " << eventSeed << std::endl ;
+    RandomGenerator generator {} ;
+    generator.seed( eventSeed ) ;
+    std::normal_distribution<double> gaussian {} ;
+    // the voxels of the event and their sim hits
+    TPCVoxelGrid voxels ;
+    std::vector<EVENT::SimTrackerHit*> simHits ;
+    unsigned int nDroppedSimHits = 0 ;
+    bool hasInput = false ;
+    for( const std::string &colName : { _padRowHitColName.get(), _lowPtHitsColName.get() } ) {
+      if( colName.empty() ) {
+        continue ;
+      }
+      try {
+        nDroppedSimHits += createVoxels( evt->getCollection( colName ), voxels, simHits ) ;
+        hasInput = true ;
+      }
+      catch( EVENT::DataNotAvailableException &) {
+        log<DEBUG4>() << "Collection " << colName << " is unavailable in event " << evt->getEventNumber() << std::endl ;
+      }
+    }
+    if( not hasInput ) {
+      return ;
+    }
+    // output collections
+    auto trkhitVec = std::make_unique<IMPL::LCCollectionVec>( EVENT::LCIO::TRACKERHIT ) ;
+    auto relCol = std::make_unique<IMPL::LCCollectionVec>( EVENT::LCIO::LCRELATION ) ;
+    // to store the weights
+    IMPL::LCFlagImpl lcFlag( 0 ) ;
+    lcFlag.setBit( EVENT::LCIO::LCREL_WEIGHTED ) ;
+    relCol->setFlag( lcFlag.getFlag() ) ;
+    UTIL::CellIDEncoder<IMPL::TrackerHitImpl> cellid_encoder( UTIL::LCTrackerCellID::encoding_string(), trkhitVec.get() ) ;
+
+    // smear the (merged) voxel position and create the tracker hit
+    auto createHit = [&]( double rho, double voxelPhi, double voxelZ, double edep, double time, double rPhiRes, double zRes, int row ) {
+      const double phi = voxelPhi + gaussian( generator, std::normal_distribution<double>::param_type( 0., rPhiRes ) ) / rho ;
+      double z = voxelZ + gaussian( generator, std::normal_distribution<double>::param_type( 0., zRes ) ) ;
+      if( std::fabs( z ) > _driftLength ) {
+        z = ( z > 0. ) ? _driftLength : -_driftLength ;
+      }
+      const double cosPhi = std::cos( phi ) ;
+      const double sinPhi = std::sin( phi ) ;
+      const double position[3] = { rho * cosPhi, rho * sinPhi, z } ;
+      const double rPhiRes2 = rPhiRes * rPhiRes ;
+      const float covMat[TRKHITNCOVMATRIX] = {
+        static_cast<float>( sinPhi * sinPhi * rPhiRes2 ),
+        static_cast<float>( -cosPhi * sinPhi * rPhiRes2 ),
+        static_cast<float>( cosPhi * cosPhi * rPhiRes2 ),
+        0.f, 0.f,
+        static_cast<float>( zRes * zRes )
+      } ;
+      auto trkHit = new IMPL::TrackerHitImpl() ;
+      cellid_encoder[ UTIL::LCTrackerCellID::subdet() ] = UTIL::ILDDetID::TPC ;
+      // as in MarlinReco: the TPC is a barrel detector, whatever the hit z
+      cellid_encoder[ UTIL::LCTrackerCellID::side() ] = UTIL::ILDDetID::barrel ;
+      cellid_encoder[ UTIL::LCTrackerCellID::layer() ] = row ;
+      cellid_encoder[ UTIL::LCTrackerCellID::module() ] = 0 ;
+      cellid_encoder[ UTIL::LCTrackerCellID::sensor() ] = 0 ;
+      cellid_encoder.setCellID( trkHit ) ;
+      trkHit->setPosition( position ) ;
+      trkHit->setEDep( edep ) ;
+      trkHit->setTime( time ) ;
+      trkHit->setCovMatrix( covMat ) ;
+      trkhitVec->addElement( trkHit ) ;
+      return trkHit ;
+    } ;
+    // relate the tracker hit to its sim hits
+    auto addRelation = [&]( IMPL::TrackerHitImpl *trkHit, EVENT::SimTrackerHit *simHit, float weight ) {
+      if( _useRawHitsToStoreSimhitPointer.get() ) {
+        trkHit->rawHits().push_back( simHit ) ;
+      }
+      else {
+        relCol->addElement( new IMPL::LCRelationImpl( trkHit, simHit, weight ) ) ;
+      }
+    } ;
+
+    unsigned int nSingleHits = 0 ;
+    unsigned int nMergedHits = 0 ;
+    unsigned int nLostVoxels = 0 ;
+    voxels.buildClusters( _doubleHitResRPhi.get(), _doubleHitResZ.get() ) ;
+    for( std::size_t c=0 ; c<voxels.numberOfClusters() ; ++c ) {
+      const auto cluster = voxels.cluster( c ) ;
+      const unsigned int clusterSize = cluster.size() ;
+      if( 1 == clusterSize ) {
+        const unsigned int voxel = cluster[0] ;
+        auto trkHit = createHit( voxels.radius( voxel ), voxels.phi( voxel ), voxels.z( voxel ), voxels.edep( voxel ), simHits[voxel]->getTime(),
+                                 voxels.rPhiRes( voxel ), voxels.zRes( voxel ), voxels.row( voxel ) ) ;
+        addRelation( trkHit, simHits[voxel], 1.f ) ;
+        ++nSingleHits ;
+        continue ;
+      }
+      if( clusterSize > static_cast<unsigned int>( _maxMerge.get() ) ) {
+        // unresolved cluster: lost
+        nLostVoxels += clusterSize ;
+        continue ;
+      }
+      // merge: average position in phi and z, sum of the deposited energy
+      double sumZ(0.), sumEDep(0.), sumTime(0.), sumCos(0.), sumSin(0.), rPhiRes(0.), zRes(0.) ;
+      for( const unsigned int voxel : cluster ) {
+        sumZ += voxels.z( voxel ) ;
+        sumEDep += voxels.edep( voxel ) ;
+        sumTime += simHits[voxel]->getTime() ;
+        sumCos += std::cos( voxels.phi( voxel ) ) ;
+        sumSin += std::sin( voxels.phi( voxel ) ) ;
+        rPhiRes = std::max( rPhiRes, voxels.rPhiRes( voxel ) ) ;
+        zRes = std::max( zRes, voxels.zRes( voxel ) ) ;
+      }
+      const unsigned int seed = cluster[0] ;
+      auto trkHit = createHit( voxels.radius( seed ), std::atan2( sumSin, sumCos ), sumZ / clusterSize, sumEDep, sumTime / clusterSize,
+                               rPhiRes, zRes, voxels.row( seed ) ) ;
+      for( const unsigned int voxel : cluster ) {
+        addRelation( trkHit, simHits[voxel], 1.f / clusterSize ) ;
+      }
+      ++nMergedHits ;
+    }
+    evt->addCollection( trkhitVec.release(), _trackerHitsColName.get() ) ;
+    if( not _useRawHitsToStoreSimhitPointer.get() ) {
+      evt->addCollection( relCol.release(), _outRelColName.get() ) ;
+    }
+    log<DEBUG4>() << "Created " << nSingleHits << " single hits and " << nMergedHits << " merged hits, "
+                  << nLostVoxels << " hits lost in unresolved clusters, " << nDroppedSimHits << " sim hits dropped" << std::endl ;
+  }
+
+  // processor declaration
+  MARLIN_DECLARE_PROCESSOR( DDTPCDigiProcessor )
+}
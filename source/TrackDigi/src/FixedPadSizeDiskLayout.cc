@@ -5,6 +5,7 @@
 using namespace marlin::loglevel ;
 
 // -- std headers
+#include <algorithm>
 #include <cmath>
 #include <math.h>
 #include <iostream>
@@ -17,16 +18,27 @@ using namespace marlin::loglevel ;
 
 namespace marlinreco_mt {
 
-  FixedPadSizeDiskLayout::~FixedPadSizeDiskLayout()
-  {
-    cleanup();
-  }
+  namespace {
 
-  void FixedPadSizeDiskLayout::cleanup()
-  {
-    for( unsigned i=0; i<_padIndices.size(); ++i ){
-      delete _padIndices[i] ;
+    /// Bring phi in [0,2pi] if it is in [-2pi,4pi], without loop
+    inline double wrapPhi( double phi ) {
+      phi += ( phi < 0. ) ? 2. * M_PI : 0. ;
+      phi -= ( phi > 2. * M_PI ) ? 2. * M_PI : 0. ;
+      return phi ;
     }
+
+    /// Bring any phi in [0,2pi]: negative angles go to [0,2pi[, angles above 2pi to ]0,2pi],
+    /// i.e. the positive multiples of 2pi stay at 2pi. The rare angles further than one turn
+    /// away are wrapped by the original loops, so that the rounding is the same
+    inline double wrapAnyPhi( double phi ) {
+      if( phi >= -2. * M_PI && phi <= 4. * M_PI ) {
+        return wrapPhi( phi ) ;
+      }
+      while( phi < 0       ) {  phi += 2. * M_PI  ; }
+      while( phi > 2.*M_PI ) {  phi -= 2. * M_PI  ; }
+      return phi ;
+    }
+
   }
 
   FixedPadSizeDiskLayout::FixedPadSizeDiskLayout(const dd4hep::rec::FixedPadSizeTPCData* tpc) :
@@ -63,16 +75,6 @@ namespace marlinreco_mt {
 
     }
 
-    _padIndices.resize( _nRow ) ;
-    // initialise all pointers to 0
-    // this thing is only filled when accessed by getPadsInRow() the first time
-    // to allocate the memory only when needed
-    for (std::vector< std::vector<int>* >::iterator rowIter = _padIndices.begin() ;
-         rowIter < _padIndices.end(); rowIter++)
-      {
-        *rowIter=0;
-      }
-
     _rowHeight =  ( _rMax - _rMin ) / _nRow ;
 
     _nPad  = 0 ;
@@ -97,46 +99,24 @@ namespace marlinreco_mt {
       _rows.push_back( row ) ;
     }
 
-  }
-
-  FixedPadSizeDiskLayout::FixedPadSizeDiskLayout( const FixedPadSizeDiskLayout & right)
-  {
-    copy_and_assign(right);
-  }
-
-  FixedPadSizeDiskLayout & FixedPadSizeDiskLayout::operator = ( const FixedPadSizeDiskLayout & right)
-  {
-    cleanup();
-    copy_and_assign(right);
-    return *this;
-  }
+    // contiguous row tables used to locate the pads
+    _phiPad.reserve( _nRow ) ;
+    _maxPadNumber.reserve( _nRow ) ;
+    for( const auto &row : _rows ) {
+      _phiPad.push_back( row.PhiPad ) ;
+      _maxPadNumber.push_back( row.NPad - 1 ) ;
+    }
 
-  void FixedPadSizeDiskLayout::copy_and_assign(const  FixedPadSizeDiskLayout & right)
-  {
-    _rMin = right._rMin;
-    _rMax = right._rMax;
-    _phiMax = right._phiMax;
-    _rowHeight = right._rowHeight;
-    _padWidth = right._padWidth;
-    _padHeight = right._padHeight;
-    _padGap = right._padGap;
-    _nRow = right._nRow;
-    _nPad = right._nPad;
-    _rows = right._rows;
-    _extent = right._extent;
-
-    // just set the _padIndices to an vector of empty entries.
-    // In every instance, also the copied ones, it is filled only at first
-    // usage to save memory
-    // just like in the constructor
-    _padIndices.resize( _nRow ) ;
-    for (std::vector< std::vector<int>* >::iterator rowIter = _padIndices.begin() ;
-         rowIter < _padIndices.end(); rowIter++)
-      {
-        *rowIter=0;
+    // the pad indices of all rows, in one contiguous table
+    _rowOffsets.reserve( _nRow + 1 ) ;
+    _padIndices.reserve( _nPad ) ;
+    _rowOffsets.push_back( 0 ) ;
+    for( int i = 0 ; i < _nRow ; i++ ) {
+      for( int j = 0 ; j < _rows[i].NPad ; j++ ) {
+        _padIndices.push_back( getPadIndex( i , j ) ) ;
       }
-
-
+      _rowOffsets.push_back( _padIndices.size() ) ;
+    }
   }
 
   int FixedPadSizeDiskLayout::getNRows() const {
@@ -188,30 +168,17 @@ namespace marlinreco_mt {
     return dd4hep::rec::Vector2D( r , phi ) ;
   }
 
-  const std::vector<int>& FixedPadSizeDiskLayout::getPadsInRow(int rowNumber) const {
-
-    static std::vector<int> empty ;
-    try {
-      if( _padIndices.at(rowNumber )  == 0 ) {
-
-        int nPad = _rows.at(rowNumber).NPad ;
-
-        _padIndices[ rowNumber ]  = new std::vector<int>( nPad )  ;
+  Span<const int> FixedPadSizeDiskLayout::getPadsInRow(int rowNumber) const {
 
-        for(int i = 0 ; i < nPad ; i++){
-
-  	_padIndices[rowNumber]->operator[](i)  = getPadIndex( rowNumber , i  ) ;
-        }
-
-      }
-    } catch( std::out_of_range& r) {
+    if( rowNumber < 0 || rowNumber >= _nRow ) {
 
       //       std::cout << " FixedPadSizeDiskLayout::getPadsInRow : no row " << rowNumber << std::endl ;
-      return empty ;
-
+      return Span<const int>() ;
     }
 
-    return *_padIndices[ rowNumber ] ;
+    const int first = _rowOffsets[ rowNumber ] ;
+
+    return Span<const int>( _padIndices.data() + first , _rowOffsets[ rowNumber + 1 ] - first ) ;
 
   }
 
@@ -237,6 +204,20 @@ namespace marlinreco_mt {
 
   }
 
+  inline int FixedPadSizeDiskLayout::nearestPadInRange(double r, double phi) const {
+
+    // r < _rMin is clamped to the first row, r > _rMax to the last row.
+    // Both positions are positive: the truncation is the floor.
+    // Divisions, not reciprocal multiplications, so that points on a pad boundary
+    // get the same pad as in the original implementation
+    const double rowPosition = std::min( std::max( ( r - _rMin ) / _rowHeight , 0. ) , _nRow - 1. ) ;
+    const int rowNum = static_cast<int>( rowPosition ) ;
+
+    const int padNum = std::min( static_cast<int>( phi / _phiPad[ rowNum ] ) , _maxPadNumber[ rowNum ] ) ;
+
+    return ( rowNum << 16 ) | ( 0x0000ffff & padNum ) ;
+  }
+
   int FixedPadSizeDiskLayout::getNearestPad(double r, double phi) const {
 
     if (fabs(r) < 1e-6)
@@ -249,9 +230,8 @@ namespace marlinreco_mt {
       
     if (fabs(_phiMax - 2*M_PI) < 1e-6) {
   	  
-      // wrap phi to 0 < phi < 2*M_PI
-      while( phi < 0       ) {  phi += 2. * M_PI  ; }
-      while( phi > 2.*M_PI ) {  phi -= 2. * M_PI  ; }
+      // wrap phi to 0 <= phi <= 2*M_PI
+      phi = wrapAnyPhi( phi ) ;
   	
     } else {
   	 
@@ -276,21 +256,7 @@ namespace marlinreco_mt {
     // This was the original code for the whole circle. (Modified a bit)
   	
     if ( r > 0. && phi >= 0. && phi <= _phiMax) {
-      rowNum = r < _rMin ? 0 : (int) std::floor( ( r - _rMin ) / _rowHeight  ) ;
-    
-      if( rowNum >= _nRow  )
-        rowNum = _nRow -1 ;
-    
-      padNum = (int) std::floor( phi / _rows[ rowNum ].PhiPad ) ;
-    
-      if( padNum >=  _rows[ rowNum ].NPad  )
-        padNum = _rows[ rowNum ].NPad  - 1 ;
-    
-      //     std::cout << " FixedPadSizeDiskLayout::getNearestPad( " << r << " , " << phi << " ) "
-      // 	      << "  _rows[ rowNum ].PhiPad : " <<  _rows[ rowNum ].PhiPad
-      // 	      << std::endl ;
-    
-      return getPadIndex( rowNum , padNum ) ;
+      return nearestPadInRange( r , phi ) ;
     }
   	
     // Area 2 can be optimized by dividing it into more areas.
@@ -431,6 +397,43 @@ namespace marlinreco_mt {
     //return getPadIndex( rowNum , padNum ) ;
   }
 
+  void FixedPadSizeDiskLayout::getNearestPads(Span<const double> r, Span<const double> phi, Span<int> padIndices) const {
+
+    const std::size_t nPoints = padIndices.size() ;
+
+    if( r.size() != nPoints || phi.size() != nPoints ) {
+      throw std::invalid_argument( "FixedPadSizeDiskLayout::getNearestPads: inconsistent input/output sizes" ) ;
+    }
+
+    if( fabs(_phiMax - 2*M_PI) >= 1e-6 ) {
+      for( std::size_t i = 0 ; i < nPoints ; i++ ) {
+        padIndices[i] = getNearestPad( r[i] , phi[i] ) ;
+      }
+      return ;
+    }
+
+    // first pass, branch free: all the points as if they were in range
+    bool allInRange = true ;
+    for( std::size_t i = 0 ; i < nPoints ; i++ ) {
+      const double wrapped = wrapPhi( phi[i] ) ;
+      const double phiInRange = std::min( std::max( wrapped , 0. ) , _phiMax ) ;
+      allInRange &= ( r[i] >= 1e-6 ) & ( wrapped == phiInRange ) ;
+      padIndices[i] = nearestPadInRange( r[i] , phiInRange ) ;
+    }
+
+    if( allInRange ) {
+      return ;
+    }
+
+    // second pass: the few points that were not in range
+    for( std::size_t i = 0 ; i < nPoints ; i++ ) {
+      const double wrapped = wrapPhi( phi[i] ) ;
+      if( ! ( r[i] >= 1e-6 && wrapped >= 0. && wrapped <= _phiMax ) ) {
+        padIndices[i] = getNearestPad( r[i] , phi[i] ) ;
+      }
+    }
+  }
+
   int FixedPadSizeDiskLayout::getLeftNeighbour(int padIndex) const {
 
     int pn = getPadNumber( padIndex ) + 1  ;
@@ -9,7 +9,9 @@
 using namespace marlin::loglevel ;
 
 // -- std headers
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
 
 namespace marlinreco_mt {
 
@@ -22,12 +24,22 @@ namespace marlinreco_mt {
       throw marlin::Exception("TPCModularEndplate: addModuleRing() called after initialize() ") ; 
     }
     
-    _moduleRings.push_back( { nModules, phi0, 0 , 0 , 0 } )  ;
+    _moduleRings.push_back( { nModules, phi0, 0 , 0 , 0 , 0 } )  ;
   }
 
 
   void TPCModularEndplate::initialize(){
 
+    // the ring lookups need at least one ring, each with at least one module
+    if( _moduleRings.empty() ){
+      throw marlin::Exception("TPCModularEndplate: initialize() called without module ring") ; 
+    }
+    for( const auto& modRing : _moduleRings){
+      if( 0 == modRing.nModules ){
+        throw marlin::Exception("TPCModularEndplate: module ring without module") ; 
+      }
+    }
+
     unsigned nRing = _moduleRings.size() ;
 
     double deltaR = ( _tpc->rMaxReadout/dd4hep::mm  - _tpc->rMinReadout/dd4hep::mm ) /  nRing ;
@@ -42,45 +54,87 @@ namespace marlinreco_mt {
       modRing.rMax = rMax ;
 
       modRing.deltaPhi =  2. * M_PI / modRing.nModules ;  
+      modRing.invDeltaPhi = 1. / modRing.deltaPhi ;
       
       rMin += deltaR ;
       rMax += deltaR ;
     }
 
+    _rMinReadout = _tpc->rMinReadout/dd4hep::mm ;
+
+    _invDeltaR = nRing / ( _tpc->rMaxReadout/dd4hep::mm - _rMinReadout ) ;
+
     isInitialized = true ; 
   }
 
 
 
-  double TPCModularEndplate::computeDistanceRPhi(const dd4hep::rec::Vector3D& hit){
+  namespace {
+
+    /// distance in phi to the closest module boundary, phi relative to the ring phi0
+    inline double distancePhi( double phi, const TPCModularEndplate::ModuleRing& modRing ) {
+
+      // fmod( phi, deltaPhi ) with the precomputed reciprocal
+      double deltaPhi  = std::fabs( phi - std::trunc( phi * modRing.invDeltaPhi ) * modRing.deltaPhi ) ;
+
+      // distance to the closest of the two boundaries
+      return std::min( deltaPhi , modRing.deltaPhi - deltaPhi ) ;
+    }
+
+  }
+
+
+  double TPCModularEndplate::computeDistanceRPhi(const dd4hep::rec::Vector3D& hit) const {
 
     if( !isInitialized ){
       throw std::runtime_error("TPCModularEndplate: computeDistanceRPhi() called before initialize() ") ; 
     }
     
-    unsigned indexR = std::floor( _moduleRings.size() * ( hit.rho()  - _tpc->rMinReadout/dd4hep::mm )  / ( _tpc->rMaxReadout/dd4hep::mm  - _tpc->rMinReadout/dd4hep::mm )  ) ;
+    const double rho = hit.rho() ;
 
-    if( indexR > _moduleRings.size() -1 ){
+    const double ringPosition = ( rho - _rMinReadout ) * _invDeltaR ;
 
-      streamlog_out( WARNING ) << " wrong index  : " << indexR << " for point " << hit << std::endl ;
+    if( ! ( ringPosition >= 0. && ringPosition < _moduleRings.size() ) ){
+
+      streamlog_out( WARNING ) << " wrong ring index  : " << std::floor( ringPosition ) << " for point " << hit << std::endl ;
 
       return 1e6 ;
     }
 
+    const auto& modRing = _moduleRings[ static_cast<unsigned>( ringPosition ) ] ;
 
-    auto modRing = _moduleRings.at( indexR )  ;
+    return rho * distancePhi( hit.phi() - modRing.phi0 , modRing ) ;
 
-    double phi = hit.phi() - modRing.phi0   ;
+  }
 
-    double deltaPhi  = std::fabs( std::fmod(  phi , modRing.deltaPhi ) );
 
-    if( deltaPhi > modRing.deltaPhi/2. ) {
+  void TPCModularEndplate::computeDistancesRPhi( Span<const double> rho, Span<const double> phi, Span<double> distances ) const {
 
-      deltaPhi = modRing.deltaPhi - deltaPhi ;
-    }  
+    if( !isInitialized ){
+      throw std::runtime_error("TPCModularEndplate: computeDistancesRPhi() called before initialize() ") ; 
+    }
+
+    const std::size_t nHits = distances.size() ;
+
+    if( rho.size() != nHits || phi.size() != nHits ) {
+      throw std::invalid_argument( "TPCModularEndplate::computeDistancesRPhi: inconsistent input/output sizes" ) ;
+    }
 
-    return hit.rho() * deltaPhi ;
+    const double lastRing = _moduleRings.size() - 1. ;
 
+    for( std::size_t i = 0 ; i < nHits ; i++ ) {
+
+      const double ringPosition = ( rho[i] - _rMinReadout ) * _invDeltaR ;
+
+      const bool inRange = ( ringPosition >= 0. ) & ( ringPosition < lastRing + 1. ) ;
+
+      // clamped so that the ring lookup is always valid, the result is dropped if not in range
+      const auto& modRing = _moduleRings[ static_cast<unsigned>( std::min( std::max( ringPosition , 0. ) , lastRing ) ) ] ;
+
+      const double distance = rho[i] * distancePhi( phi[i] - modRing.phi0 , modRing ) ;
+
+      distances[i] = inRange ? distance : 1e6 ;
+    }
   }
   
 }
@@ -0,0 +1,181 @@
+#include <MarlinRecoMT/TPCVoxelGrid.h>
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace marlinreco_mt {
+
+  void TPCVoxelGrid::reserve( std::size_t n ) {
+    _row.reserve( n ) ;
+    _radius.reserve( n ) ;
+    _phi.reserve( n ) ;
+    _z.reserve( n ) ;
+    _edep.reserve( n ) ;
+    _rPhiRes.reserve( n ) ;
+    _zRes.reserve( n ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void TPCVoxelGrid::clear() {
+    _row.clear() ;
+    _radius.clear() ;
+    _phi.clear() ;
+    _z.clear() ;
+    _edep.clear() ;
+    _rPhiRes.clear() ;
+    _zRes.clear() ;
+    _sorted.clear() ;
+    _phiBin.clear() ;
+    _nPhiBins.clear() ;
+    _binned.clear() ;
+    _parent.clear() ;
+    _clusterIndex.clear() ;
+    _clusterOffsets.clear() ;
+    _clusterVoxels.clear() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned int TPCVoxelGrid::addVoxel( int row, double radius, double phi, double z, double edep, double rPhiRes, double zRes ) {
+    _row.push_back( row ) ;
+    _radius.push_back( radius ) ;
+    _phi.push_back( phi ) ;
+    _z.push_back( z ) ;
+    _edep.push_back( edep ) ;
+    _rPhiRes.push_back( rPhiRes ) ;
+    _zRes.push_back( zRes ) ;
+    return _row.size() - 1 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void TPCVoxelGrid::buildClusters( double doubleHitResRPhi, double doubleHitResZ ) {
+    const unsigned int nVoxels = _row.size() ;
+    // bin the rows in phi: a bin is at least doubleHitResRPhi wide at the row radius,
+    // so that only the voxels of the same and of the adjacent bins can be linked.
+    // With less than 3 bins, a row is a single bin
+    _phiBin.resize( nVoxels ) ;
+    _nPhiBins.resize( nVoxels ) ;
+    for( unsigned int v=0 ; v<nVoxels ; ++v ) {
+      const double maxBins = ( doubleHitResRPhi > 0. ) ? std::floor( 2. * M_PI * _radius[v] / doubleHitResRPhi ) : 1. ;
+      const unsigned int nBins = ( maxBins < 3. ) ? 1 : static_cast<unsigned int>( std::min( maxBins, double(maxPhiBins) ) ) ;
+      const double phi = _phi[v] - 2. * M_PI * std::floor( _phi[v] / ( 2. * M_PI ) ) ;
+      _nPhiBins[v] = nBins ;
+      _phiBin[v] = std::min( nBins - 1, static_cast<unsigned int>( phi * nBins / ( 2. * M_PI ) ) ) ;
+    }
+    // sort the voxels in (row, phi bin, z), ties by index to stay reproducible
+    _binned.resize( nVoxels ) ;
+    std::iota( _binned.begin(), _binned.end(), 0 ) ;
+    std::sort( _binned.begin(), _binned.end(), [this]( unsigned int lhs, unsigned int rhs ) {
+      if( _row[lhs] != _row[rhs] ) {
+        return _row[lhs] < _row[rhs] ;
+      }
+      if( _phiBin[lhs] != _phiBin[rhs] ) {
+        return _phiBin[lhs] < _phiBin[rhs] ;
+      }
+      if( _z[lhs] != _z[rhs] ) {
+        return _z[lhs] < _z[rhs] ;
+      }
+      return lhs < rhs ;
+    }) ;
+    // link the voxels: each voxel looks at the next voxels in z of its own bin and at the
+    // voxels of the next bin (with wrap around) inside the z window, so that every pair of
+    // neighbour bins is visited once
+    _parent.resize( nVoxels ) ;
+    std::iota( _parent.begin(), _parent.end(), 0 ) ;
+    auto link = [&]( unsigned int a, unsigned int b ) {
+      const double dRPhi = std::fabs( std::remainder( _phi[a] - _phi[b], 2. * M_PI ) ) * _radius[a] ;
+      if( dRPhi < doubleHitResRPhi ) {
+        const unsigned int rootA = findRoot( a ) ;
+        const unsigned int rootB = findRoot( b ) ;
+        if( rootA != rootB ) {
+          _parent[ std::max( rootA, rootB ) ] = std::min( rootA, rootB ) ;
+        }
+      }
+    } ;
+    unsigned int rowBegin = 0 ;
+    while( rowBegin < nVoxels ) {
+      const int row = _row[ _binned[rowBegin] ] ;
+      unsigned int rowEnd = rowBegin ;
+      while( rowEnd < nVoxels and _row[ _binned[rowEnd] ] == row ) {
+        ++rowEnd ;
+      }
+      for( unsigned int s=rowBegin ; s<rowEnd ; ++s ) {
+        const unsigned int a = _binned[s] ;
+        const unsigned int bin = _phiBin[a] ;
+        for( unsigned int t=s+1 ; t<rowEnd ; ++t ) {
+          const unsigned int b = _binned[t] ;
+          if( _phiBin[b] != bin or _z[b] - _z[a] > doubleHitResZ ) {
+            break ;
+          }
+          link( a, b ) ;
+        }
+        if( _nPhiBins[a] == 1 ) {
+          continue ;
+        }
+        const unsigned int nextBin = ( bin + 1 ) % _nPhiBins[a] ;
+        const double zMin = _z[a] - doubleHitResZ ;
+        auto first = std::partition_point( _binned.begin() + rowBegin, _binned.begin() + rowEnd, [&]( unsigned int voxel ) {
+          return _phiBin[voxel] < nextBin or ( _phiBin[voxel] == nextBin and _z[voxel] < zMin ) ;
+        }) ;
+        for( ; first != _binned.begin() + rowEnd ; ++first ) {
+          const unsigned int b = *first ;
+          if( _phiBin[b] != nextBin or _z[b] - _z[a] > doubleHitResZ ) {
+            break ;
+          }
+          link( a, b ) ;
+        }
+      }
+      rowBegin = rowEnd ;
+    }
+    // sort the voxels in (row, z) for the cluster ordering
+    _sorted.resize( nVoxels ) ;
+    std::iota( _sorted.begin(), _sorted.end(), 0 ) ;
+    std::sort( _sorted.begin(), _sorted.end(), [this]( unsigned int lhs, unsigned int rhs ) {
+      if( _row[lhs] != _row[rhs] ) {
+        return _row[lhs] < _row[rhs] ;
+      }
+      if( _z[lhs] != _z[rhs] ) {
+        return _z[lhs] < _z[rhs] ;
+      }
+      return lhs < rhs ;
+    }) ;
+    // label the clusters in (row, z) order of their first voxel and count their voxels
+    constexpr unsigned int noCluster = std::numeric_limits<unsigned int>::max() ;
+    _clusterIndex.assign( nVoxels, noCluster ) ;
+    _clusterOffsets.assign( 1, 0 ) ;
+    for( unsigned int s=0 ; s<nVoxels ; ++s ) {
+      const unsigned int root = findRoot( _sorted[s] ) ;
+      if( noCluster == _clusterIndex[root] ) {
+        _clusterIndex[root] = _clusterOffsets.size() - 1 ;
+        _clusterOffsets.push_back( 0 ) ;
+      }
+      ++_clusterOffsets[ _clusterIndex[root] + 1 ] ;
+    }
+    std::partial_sum( _clusterOffsets.begin(), _clusterOffsets.end(), _clusterOffsets.begin() ) ;
+    // fill the clusters, using the offsets as cursors. After the fill, offset i
+    // is the end of cluster i: shift them back by one
+    _clusterVoxels.resize( nVoxels ) ;
+    for( unsigned int s=0 ; s<nVoxels ; ++s ) {
+      const unsigned int voxel = _sorted[s] ;
+      _clusterVoxels[ _clusterOffsets[ _clusterIndex[ findRoot( voxel ) ] ]++ ] = voxel ;
+    }
+    std::copy_backward( _clusterOffsets.begin(), _clusterOffsets.end() - 1, _clusterOffsets.end() ) ;
+    _clusterOffsets[0] = 0 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned int TPCVoxelGrid::findRoot( unsigned int voxel ) {
+    while( _parent[voxel] != voxel ) {
+      _parent[voxel] = _parent[ _parent[voxel] ] ;
+      voxel = _parent[voxel] ;
+    }
+    return voxel ;
+  }
+
+}
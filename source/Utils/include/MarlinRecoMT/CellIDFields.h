@@ -0,0 +1,177 @@
+#ifndef MARLINRECOMT_CELLIDFIELDS_h
+#define MARLINRECOMT_CELLIDFIELDS_h 1
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+
+// -- std headers
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace marlinreco_mt {
+
+  /** Compiled extractor of a single field of a cellID encoding.
+   *  The 64 bits cellID value follows the LCIO convention: cellID0 in
+   *  the lower 32 bits, cellID1 in the upper 32 bits. Extracting a field
+   *  costs a few integer operations (shift and mask, or shift and arithmetic
+   *  shift for signed fields).
+   *  Example usage: <br>
+   *  <pre>
+   *     auto fields = CellIDFields::get( collection ) ;
+   *     const CellIDField layerField = fields->field( "layer" ) ;
+   *     for( ... ) {
+   *       int layer = layerField( hit ) ;
+   *     }
+   *  </pre>
+   */
+  class CellIDField {
+  public:
+    constexpr CellIDField() = default ;
+
+    /** Constructor
+     *  @param offset the field bit offset
+     *  @param width the field bit width (1 to 64)
+     *  @param isSigned whether the field is signed
+     */
+    constexpr CellIDField( unsigned int offset, unsigned int width, bool isSigned ) :
+      _offset( offset ),
+      _leftShift( 64 - offset - width ),
+      _rightShift( 64 - width ),
+      _mask( width >= 64 ? ~std::uint64_t(0) : ( ( std::uint64_t(1) << width ) - 1 ) ),
+      _isSigned( isSigned ) {
+      /* nop */
+    }
+
+    /** Extract the field value from a 64 bits cellID
+     */
+    constexpr long long operator()( std::uint64_t cellID ) const {
+      return _isSigned ?
+        ( static_cast<long long>( cellID << _leftShift ) >> _rightShift ) :
+        static_cast<long long>( ( cellID >> _offset ) & _mask ) ;
+    }
+
+    /** Extract the field value from cellID0 and cellID1
+     */
+    constexpr long long operator()( int cellID0, int cellID1 ) const {
+      return (*this)( cellIDValue( cellID0, cellID1 ) ) ;
+    }
+
+    /** Extract the field value from an object providing getCellID0() and getCellID1()
+     */
+    template <typename T>
+    constexpr long long operator()( const T *obj ) const {
+      return (*this)( obj->getCellID0(), obj->getCellID1() ) ;
+    }
+
+    /** Extract the field values of all the elements of a collection of type T.
+     *  The output vector is resized to the number of elements
+     */
+    template <typename T>
+    void extract( const EVENT::LCCollection *collection, std::vector<long long> &values ) const ;
+
+    /** Return the 64 bits cellID with this field set to value (truncated to the field width)
+     */
+    constexpr std::uint64_t set( std::uint64_t cellID, long long value ) const {
+      return ( cellID & ~( _mask << _offset ) ) | ( ( static_cast<std::uint64_t>( value ) & _mask ) << _offset ) ;
+    }
+
+    /** The field bit offset */
+    constexpr unsigned int offset() const { return _offset ; }
+
+    /** The field bit width */
+    constexpr unsigned int width() const { return 64 - _rightShift ; }
+
+    /** Whether the field is signed */
+    constexpr bool isSigned() const { return _isSigned ; }
+
+    /** Combine cellID0 and cellID1 into a 64 bits cellID (LCIO convention)
+     */
+    static constexpr std::uint64_t cellIDValue( int cellID0, int cellID1 ) {
+      return ( static_cast<std::uint64_t>( static_cast<std::uint32_t>( cellID1 ) ) << 32 ) | static_cast<std::uint32_t>( cellID0 ) ;
+    }
+
+  private:
+    unsigned int       _offset {0} ;
+    unsigned int       _leftShift {0} ;
+    unsigned int       _rightShift {0} ;
+    std::uint64_t      _mask {0} ;
+    bool               _isSigned {false} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /** Parsed cellID encoding string (e.g "system:5,side:-2,layer:9,module:8,sensor:8").
+   *  Encodings are parsed once and cached process-wide by encoding string,
+   *  the cached objects are immutable and can be shared between threads.
+   */
+  class CellIDFields {
+  public:
+    CellIDFields( const CellIDFields& ) = delete ;
+    CellIDFields& operator=( const CellIDFields& ) = delete ;
+
+    /** Get the parsed encoding for the encoding string. Thread safe.
+     *  An empty encoding string falls back to UTIL::LCTrackerCellID::encoding_string()
+     */
+    static std::shared_ptr<const CellIDFields> get( const std::string &encoding ) ;
+
+    /** Get the parsed encoding of the collection CellIDEncoding parameter. Thread safe.
+     *  Collections without encoding parameter use the default tracker encoding, see above
+     */
+    static std::shared_ptr<const CellIDFields> get( const EVENT::LCCollection *collection ) ;
+
+    /** The encoding string
+     */
+    const std::string &encoding() const ;
+
+    /** Whether the encoding has a field with this name
+     */
+    bool hasField( const std::string &name ) const ;
+
+    /** Get the field extractor by name. Throws if the field doesn't exist
+     */
+    const CellIDField &field( const std::string &name ) const ;
+
+    /** Format the field values of a 64 bits cellID as "name:value,name:value,...",
+     *  as UTIL::BitField64::valueString(). For messages, not meant for hot loops
+     */
+    std::string valueString( std::uint64_t cellID ) const ;
+
+    /** Format the field values of an object providing getCellID0() and getCellID1()
+     */
+    template <typename T>
+    std::string valueString( const T *obj ) const {
+      return valueString( CellIDField::cellIDValue( obj->getCellID0(), obj->getCellID1() ) ) ;
+    }
+
+  private:
+    /** Constructor, parse the encoding string
+     */
+    CellIDFields( const std::string &encoding ) ;
+
+  private:
+    /// The encoding string
+    std::string                    _encoding {} ;
+    /// The field names
+    std::vector<std::string>       _names {} ;
+    /// The field extractors
+    std::vector<CellIDField>       _fields {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline void CellIDField::extract( const EVENT::LCCollection *collection, std::vector<long long> &values ) const {
+    const int nElements = collection->getNumberOfElements() ;
+    values.resize( nElements ) ;
+    for( int i=0 ; i<nElements ; ++i ) {
+      values[i] = (*this)( static_cast<const T*>( collection->getElementAt( i ) ) ) ;
+    }
+  }
+
+}
+
+#endif
@@ -1,49 +1,101 @@
+#ifndef MARLINRECOMT_CIRCLE_h
+#define MARLINRECOMT_CIRCLE_h 1
+
 // Circle.h: interface for the Circle class.
 // Circle class.
 // Purpose : Represent the circle object
 // Input : 3 different points
 // Process : Calcuate the radius and center
 // Output : Circle
-//           
-// This class originally designed for representation of discretized curvature information 
-// of sequential pointlist  
+//
+// This class originally designed for representation of discretized curvature information
+// of sequential pointlist
 // KJIST CAD/CAM     Ryu, Jae Hun ( ryu@geguri.kjist.ac.kr)
 // Last update : 2019.09, R.Ete, DESY
 
 #include <DDRec/Vector2D.h>
 
+// -- marlinreco mt headers
+#include <MarlinRecoMT/Span.h>
+
+// -- std headers
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
 namespace marlinreco_mt {
-	
+
+	/// The indices of three points in the coordinate arrays, see Circle::fromTriplets()
+	struct CircleTriplet {
+		std::uint32_t            first {0} ;
+		std::uint32_t            second {0} ;
+		std::uint32_t            third {0} ;
+	};
+
+	/// The circles through point triplets, as structure of arrays, see Circle::fromTriplets()
+	struct TripletCircles {
+		/// Resize all the arrays to n circles
+		void resize( std::size_t n ) ;
+
+		/// The number of circles
+		std::size_t size() const { return radius.size() ; }
+
+		/// The circle radii, infinite for degenerate triplets
+		std::vector<double>         radius {} ;
+		/// The circle center x coordinates, 0 for degenerate triplets
+		std::vector<double>         xCenter {} ;
+		/// The circle center y coordinates, 0 for degenerate triplets
+		std::vector<double>         yCenter {} ;
+		/// +1 if first -> second -> third turns counter-clockwise, -1 if clockwise, 0 for degenerate triplets
+		std::vector<std::int8_t>    curvatureSign {} ;
+		/// 1 if the three points are colinear or not distinct, else 0
+		std::vector<std::uint8_t>   degenerate {} ;
+	};
+
 	class Circle {
 	public:
 		/// The tolerance used in the circle computations
 		static constexpr double TOLERANCE = 0.000000001 ;
-		
+
 	public:
 		/// Default constructor
 		Circle() = default ;
-		
+
 		/// Default destructor
 		~Circle() = default ;
-		
-		/// Constructor with co-planar vectors
+
+		/** Constructor with co-planar vectors. Throws marlin::Exception if the points are colinear,
+		 *  see TOLERANCE. Nearly colinear points give a large radius and a far away center, the
+		 *  direction from the center to the points stays accurate.
+		 */
 		Circle( const dd4hep::rec::Vector2D &p1, const dd4hep::rec::Vector2D &p2, const dd4hep::rec::Vector2D &p3 ) ;
-		
-		/// Get the circle radius 
+
+		/// Get the circle radius
 		double radius() const ;
-		
+
 		/// Get the circle center vector
 		const dd4hep::rec::Vector2D &center() const ;
 
-	private:
-		void calculateCircleProperties( const dd4hep::rec::Vector2D &p1, const dd4hep::rec::Vector2D &p2, const dd4hep::rec::Vector2D &p3 ) ;
-		bool isPerpendicular( const dd4hep::rec::Vector2D &p1, const dd4hep::rec::Vector2D &p2, const dd4hep::rec::Vector2D &p3 ) const ;
-		
+		/** Compute the circles through many point triplets at once, e.g for track seeding.
+		 *  Same computation as the constructor, with the arithmetic split from the degenerate
+		 *  triplet handling so that it vectorises with the default compiler flags. A triplet
+		 *  is degenerate, instead of throwing, if the sine of the angle between its two chords
+		 *  from the first point is below TOLERANCE.
+		 *  The triplet indices are not range checked.
+		 *  Throws std::invalid_argument if x and y don't have the same size.
+		 *  @param x, y the point coordinates
+		 *  @param triplets the indices of the points of each circle
+		 *  @param circles return argument, resized to the number of triplets
+		 */
+		static void fromTriplets( Span<const double> x, Span<const double> y, Span<const CircleTriplet> triplets, TripletCircles &circles ) ;
+
 	private:
 		/// The circle radius
 		double                   _radius {0.f} ;
 		/// The circle center
 		dd4hep::rec::Vector2D    _center {} ;
 	};
-		
+
 }
+
+#endif
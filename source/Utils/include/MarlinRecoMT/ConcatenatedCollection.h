@@ -0,0 +1,132 @@
+#ifndef MARLINRECOMT_CONCATENATEDCOLLECTION_h
+#define MARLINRECOMT_CONCATENATEDCOLLECTION_h 1
+
+// -- lcio headers
+#include <EVENT/LCCollection.h>
+#include <IMPL/LCParametersImpl.h>
+
+// -- std headers
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace marlinreco_mt {
+
+  /** Read-only collection presenting several collections of the same type as a single
+   *  subset collection, without copying the element pointers. Element access goes through
+   *  the underlying collections, so these must stay in the event and must not be modified
+   *  as long as the view is used (the element counts are recorded when a collection is added).
+   *
+   *  The collection parameters are built lazily by a user provided function, on the first
+   *  call to getParameters() or parameters(). Consumers that never look at the parameters
+   *  don't pay for merging them.
+   *
+   *  Restriction: the view is not an IMPL::LCCollectionVec. Consumers must only use the
+   *  EVENT::LCCollection interface: a dynamic_cast<IMPL::LCCollectionVec*> of the view
+   *  returns nullptr, and code relying on it (e.g. to iterate over the vector directly or to
+   *  modify the collection) does not work with views. Use a copying merge for such consumers.
+   *  Example usage: <br>
+   *  <pre>
+   *     auto view = new ConcatenatedCollection( [](const ConcatenatedCollection &v, EVENT::LCParameters &p){ ... } ) ;
+   *     view->addCollection( "EvenHits", evt->getCollection( "EvenHits" ) ) ;
+   *     view->addCollection( "OddHits", evt->getCollection( "OddHits" ) ) ;
+   *     evt->addCollection( view, "AllHits" ) ;
+   *  </pre>
+   */
+  class ConcatenatedCollection : public EVENT::LCCollection {
+  public:
+    /// The lazy parameter builder
+    using ParameterBuilder = std::function<void(const ConcatenatedCollection&, EVENT::LCParameters&)> ;
+
+  public:
+    ConcatenatedCollection( const ConcatenatedCollection& ) = delete ;
+    ConcatenatedCollection& operator=( const ConcatenatedCollection& ) = delete ;
+
+    /** Constructor
+     *  @param builder the function building the collection parameters on first access (can be empty)
+     */
+    ConcatenatedCollection( ParameterBuilder builder = nullptr ) ;
+
+    /** Destructor. Neither the underlying collections nor the elements are owned
+     */
+    ~ConcatenatedCollection() = default ;
+
+    /** Append a collection to the view. The first collection defines the type and the flag
+     *  of the view (with the subset bit set), the next ones must have the same type.
+     *  Throws EVENT::Exception otherwise
+     *  @param name the collection name, as seen by the parameter builder
+     *  @param collection the collection to append
+     */
+    void addCollection( const std::string &name, const EVENT::LCCollection *collection ) ;
+
+    /** The number of underlying collections
+     */
+    unsigned int numberOfCollections() const ;
+
+    /** The underlying collection at index i
+     */
+    const EVENT::LCCollection *collection( unsigned int i ) const ;
+
+    /** The name of the underlying collection at index i
+     */
+    const std::string &collectionName( unsigned int i ) const ;
+
+    // from EVENT::LCCollection
+    int getNumberOfElements() const ;
+    const std::string & getTypeName() const ;
+    EVENT::LCObject * getElementAt( int index ) const ;
+    int getFlag() const ;
+    bool isTransient() const ;
+    bool isDefault() const ;
+    bool isSubset() const ;
+    const EVENT::LCParameters & getParameters() const ;
+    EVENT::LCParameters & parameters() ;
+
+    /** Set the collection flag. The subset bit is always set, so that the view is written
+     *  and read back as a subset collection
+     */
+    void setFlag( int flag ) ;
+    void setTransient( bool val=true ) ;
+
+    /** Always a subset. Throws EVENT::ReadOnlyException on setSubset(false)
+     */
+    void setSubset( bool val=true ) ;
+
+    /** Read-only view. Throws EVENT::ReadOnlyException
+     */
+    void addElement( EVENT::LCObject * obj ) ;
+
+    /** Read-only view. Throws EVENT::ReadOnlyException
+     */
+    void removeElementAt( int i ) ;
+
+  private:
+    /** Build the parameters with the parameter builder, once
+     */
+    void materializeParameters() const ;
+
+  private:
+    /// The underlying collections
+    std::vector<const EVENT::LCCollection*>     _collections {} ;
+    /// The underlying collection names
+    std::vector<std::string>                    _names {} ;
+    /// The cumulated element counts (end index of each collection in the view)
+    std::vector<int>                            _ends {} ;
+    /// The element type name
+    std::string                                 _typeName {} ;
+    /// The collection flag
+    int                                         _flag {1 << EVENT::LCCollection::BITSubset} ;
+    /// Whether the collection is transient
+    bool                                        _transient {false} ;
+    /// The lazy parameter builder
+    ParameterBuilder                            _parameterBuilder {} ;
+    /// Guard for building the parameters once
+    mutable std::once_flag                      _parametersFlag {} ;
+    /// The collection parameters, built on first access
+    mutable IMPL::LCParametersImpl              _parameters {} ;
+  };
+
+}
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef MARLINRECOMT_EVENTARENA_h
+#define MARLINRECOMT_EVENTARENA_h 1
+
+// -- std headers
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+
+namespace marlinreco_mt {
+
+  template <typename T>
+  class EventArena ;
+
+  /** LCIO object created in an EventArena.
+   *  The object is still owned and deleted by its collection: the class specific
+   *  operator delete, picked through the virtual destructor, releases the object
+   *  from its arena buffer instead of freeing it.
+   */
+  template <typename T>
+  class ArenaObject : public T {
+  public:
+    using T::T ;
+
+    /** Release the object from its arena buffer
+     */
+    static void operator delete( void *ptr ) noexcept {
+      EventArena<T>::release( ptr ) ;
+    }
+
+  private:
+    friend class EventArena<T> ;
+    /// Only created by EventArena::create()
+    static void *operator new( std::size_t, void *slot ) noexcept {
+      return slot ;
+    }
+    /// Called if the constructor throws, the slot is simply not used
+    static void operator delete( void *, void * ) noexcept {
+      /* nop */
+    }
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /** Memory arena for the output objects of one processor call on one event.
+   *  The objects are carved from buffers of n objects, n being the expected number
+   *  of objects (usually the number of input elements), so that a whole output
+   *  collection costs a single allocation. A buffer is freed in bulk when its last
+   *  object is deleted, i.e. when the collections are deleted with the event, on
+   *  whatever thread. The arena itself is local to the processEvent() call.
+   *  Example usage: <br>
+   *  <pre>
+   *     EventArena<IMPL::CalorimeterHitImpl> hitArena( col->getNumberOfElements() ) ;
+   *     outputCollection->reserve( col->getNumberOfElements() ) ;
+   *     auto hit = hitArena.create() ;
+   *     outputCollection->addElement( hit ) ;
+   *  </pre>
+   */
+  template <typename T>
+  class EventArena {
+  public:
+    using Object = ArenaObject<T> ;
+
+  public:
+    EventArena() = delete ;
+    EventArena( const EventArena & ) = delete ;
+    EventArena &operator=( const EventArena & ) = delete ;
+
+    /** Constructor. No memory is allocated before the first object is created
+     *  @param capacity the number of objects per buffer
+     */
+    explicit EventArena( std::size_t capacity ) ;
+
+    /** Destructor. The buffers are freed with their objects
+     */
+    ~EventArena() ;
+
+    /** Create an object in the arena
+     *  @param args the object constructor arguments
+     */
+    template <typename ...Args>
+    Object *create( Args &&...args ) ;
+
+  private:
+    friend class ArenaObject<T> ;
+
+    /// The buffer header, counting the buffer objects plus one while the arena uses it
+    struct Buffer {
+      std::atomic<std::size_t>     _references {1} ;
+    };
+
+    static_assert( alignof(Object) <= alignof(std::max_align_t), "EventArena: over-aligned types are not supported" ) ;
+    /// Round up to a multiple of the object alignment
+    static constexpr std::size_t aligned( std::size_t size ) {
+      return ( size + alignof(Object) - 1 ) / alignof(Object) * alignof(Object) ;
+    }
+    /// Each object is preceded by a pointer to its buffer
+    static constexpr std::size_t SlotHeader = aligned( sizeof(Buffer*) ) ;
+    static constexpr std::size_t SlotSize = SlotHeader + aligned( sizeof(Object) ) ;
+    /// The offset of the first slot in a buffer
+    static constexpr std::size_t BufferHeader = ( sizeof(Buffer) + alignof(std::max_align_t) - 1 ) / alignof(std::max_align_t) * alignof(std::max_align_t) ;
+    /// The minimum number of objects per buffer
+    static constexpr std::size_t MinCapacity = 16 ;
+
+    /// Release an object slot, free the buffer with its last reference
+    static void release( void *object ) ;
+
+    /// Drop a buffer reference
+    static void unref( Buffer *buffer ) ;
+
+  private:
+    /// The number of objects per buffer
+    const std::size_t     _capacity ;
+    /// The current buffer
+    Buffer               *_buffer {nullptr} ;
+    /// The number of slots used in the current buffer
+    std::size_t           _used {0} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline EventArena<T>::EventArena( std::size_t capacity ) :
+    _capacity( std::max( capacity, MinCapacity ) ) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline EventArena<T>::~EventArena() {
+    if( nullptr != _buffer ) {
+      unref( _buffer ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  template <typename ...Args>
+  inline typename EventArena<T>::Object *EventArena<T>::create( Args &&...args ) {
+    if( nullptr == _buffer || _capacity == _used ) {
+      void *memory = ::operator new( BufferHeader + _capacity * SlotSize ) ;
+      if( nullptr != _buffer ) {
+        unref( _buffer ) ;
+      }
+      _buffer = ::new( memory ) Buffer() ;
+      _used = 0 ;
+    }
+    char *slot = reinterpret_cast<char*>( _buffer ) + BufferHeader + _used * SlotSize ;
+    Object *object = new( slot + SlotHeader ) Object( std::forward<Args>( args )... ) ;
+    ::new( slot ) Buffer*( _buffer ) ;
+    ++_used ;
+    _buffer->_references.fetch_add( 1, std::memory_order_relaxed ) ;
+    return object ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline void EventArena<T>::release( void *object ) {
+    unref( *reinterpret_cast<Buffer**>( static_cast<char*>( object ) - SlotHeader ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  template <typename T>
+  inline void EventArena<T>::unref( Buffer *buffer ) {
+    if( 1 == buffer->_references.fetch_sub( 1, std::memory_order_acq_rel ) ) {
+      buffer->~Buffer() ;
+      ::operator delete( static_cast<void*>( buffer ) ) ;
+    }
+  }
+
+}
+
+#endif
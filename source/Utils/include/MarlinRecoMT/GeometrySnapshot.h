@@ -0,0 +1,300 @@
+#ifndef MARLINRECOMT_GEOMETRYSNAPSHOT_h
+#define MARLINRECOMT_GEOMETRYSNAPSHOT_h 1
+
+// -- dd4hep headers
+#include <DDRec/DetectorData.h>
+#include <DDRec/ISurface.h>
+#include <DDRec/Vector2D.h>
+#include <DDRec/Vector3D.h>
+
+// -- std headers
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dd4hep {
+  class Detector ;
+}
+
+namespace marlinreco_mt {
+
+  /** Cached properties of a measurement surface.
+   *  Lengths are in DD4hep units, as in DDRec. The geometry queries go to the DDRec
+   *  surface when available. Surfaces read from a geometry cache file have no DDRec
+   *  surface: they are then treated as planes bounded by the section of their volume
+   *  by the surface plane. This section is only known for planar surfaces of box and
+   *  trapezoid volumes (e.g VXD ladders, FTD petals), see hasBounds().
+   */
+  struct SurfaceData {
+    /** Local (u,v) coordinates of a global point projected on the surface
+     */
+    dd4hep::rec::Vector2D globalToLocal( const dd4hep::rec::Vector3D &point ) const ;
+
+    /** Global point of the local (u,v) coordinates
+     */
+    dd4hep::rec::Vector3D localToGlobal( const dd4hep::rec::Vector2D &local ) const ;
+
+    /** Signed distance of a point to the surface
+     */
+    double distance( const dd4hep::rec::Vector3D &point ) const ;
+
+    /** Whether the point is on the surface, within epsilon, and inside its bounds
+     */
+    bool insideBounds( const dd4hep::rec::Vector3D &point, double epsilon = 1.e-4 ) const ;
+
+    /** Whether insideBounds() can be used, i.e the DDRec surface or the bounds polygon is available
+     */
+    bool hasBounds() const ;
+
+    /// The DDRec surface, nullptr if read from a cache file
+    const dd4hep::rec::ISurface     *_surface {nullptr} ;
+    /// Whether the surface is a plane
+    bool                             _isPlane {false} ;
+    /// The surface origin
+    dd4hep::rec::Vector3D            _origin {} ;
+    /// The first measurement direction
+    dd4hep::rec::Vector3D            _u {} ;
+    /// The second measurement direction
+    dd4hep::rec::Vector3D            _v {} ;
+    /// The surface normal
+    dd4hep::rec::Vector3D            _normal {} ;
+    /// The u direction as (theta, phi)
+    std::array<float, 2>             _uDirection {{0.f, 0.f}} ;
+    /// The v direction as (theta, phi)
+    std::array<float, 2>             _vDirection {{0.f, 0.f}} ;
+    /// The surface length along u
+    double                           _lengthAlongU {0.} ;
+    /// The surface length along v
+    double                           _lengthAlongV {0.} ;
+    /// The surface bounds, as a counter-clockwise convex polygon in local (u,v) coordinates. Only read from a cache file, empty with a DDRec surface
+    std::vector<dd4hep::rec::Vector2D>  _bounds {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /** The surfaces of a sub-detector, sorted by cellID
+   */
+  class SurfaceTable {
+  public:
+    /** Find the surface for a cellID. Returns nullptr if not found
+     */
+    const SurfaceData *find( std::uint64_t cellID ) const ;
+
+    /** The number of surfaces
+     */
+    std::size_t size() const ;
+
+    /** The sorted surface cellIDs
+     */
+    const std::vector<std::uint64_t> &cellIDs() const ;
+
+    /** Whether all the surfaces have bounds, see SurfaceData::hasBounds()
+     */
+    bool hasBounds() const ;
+
+  private:
+    friend class GeometrySnapshot ;
+    /// The sorted surface cellIDs
+    std::vector<std::uint64_t>       _cellIDs {} ;
+    /// The surface data, same order as the cellIDs
+    std::vector<SurfaceData>         _surfaces {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /** A calorimeter layer, from dd4hep::rec::LayeredCalorimeterData.
+   *  Lengths are in DD4hep units
+   */
+  struct CalorimeterLayer {
+    double       _distance {0.} ;
+    double       _phi0 {0.} ;
+    double       _absorberThickness {0.} ;
+    double       _sensitiveThickness {0.} ;
+    double       _cellSize0 {0.} ;
+    double       _cellSize1 {0.} ;
+  };
+
+  /** A layered calorimeter, from dd4hep::rec::LayeredCalorimeterData.
+   *  Lengths are in DD4hep units
+   */
+  struct CalorimeterGeometry {
+    /// The sub-detector name
+    std::string                      _name {} ;
+    /// The sub-detector type flag (see dd4hep::DetType)
+    unsigned long                    _typeFlag {0} ;
+    /// The extent: rmin, rmax, zmin, zmax (barrel) and rmin, rmax (endcap)
+    std::array<double, 6>            _extent {{0., 0., 0., 0., 0., 0.}} ;
+    int                              _innerSymmetry {0} ;
+    int                              _outerSymmetry {0} ;
+    double                           _innerPhi0 {0.} ;
+    double                           _outerPhi0 {0.} ;
+    /// The layers, from inside to outside
+    std::vector<CalorimeterLayer>    _layers {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /** A disk layer made of petals, from dd4hep::rec::ZDiskPetalsData.
+   *  Lengths are in DD4hep units
+   */
+  struct ZDiskPetalsLayer {
+    double       _zPosition {0.} ;
+    double       _phi0 {0.} ;
+    double       _petalHalfAngle {0.} ;
+    int          _petalNumber {0} ;
+    int          _sensorsPerPetal {0} ;
+  };
+
+  /** A disk tracker, from dd4hep::rec::ZDiskPetalsData.
+   *  Lengths are in DD4hep units
+   */
+  struct ZDiskPetalsGeometry {
+    /// The sub-detector name
+    std::string                      _name {} ;
+    double                           _widthStrip {0.} ;
+    double                           _lengthStrip {0.} ;
+    double                           _pitchStrip {0.} ;
+    double                           _angleStrip {0.} ;
+    /// The disk layers
+    std::vector<ZDiskPetalsLayer>    _layers {} ;
+  };
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  /** Process wide, read-only copy of the DD4hep geometry data used by MarlinRecoMT.
+   *  The snapshot is extracted once, on the first call to instance(), from the geometry
+   *  loaded in dd4hep::Detector (which must then be loaded) or from a geometry cache file.
+   *  The cache file is set once for the process with configure(), by the GeometrySnapshot
+   *  processor which must run before the processors using the snapshot.
+   *  It holds for each sub-detector:
+   *  - the DDRec surfaces (SurfaceManager)
+   *  - the dd4hep::rec::LayeredCalorimeterData
+   *  - the dd4hep::rec::ZDiskPetalsData
+   *  - the dd4hep::rec::FixedPadSizeTPCData
+   *  and the magnetic field at the origin.
+   *  The snapshot is never modified after construction and is shared by all the processor
+   *  instances and their clones: look up the tables in init() and use them in processEvent()
+   *  without further calls to DD4hep.
+   *
+   *  Geometry cache file layout (native endianness):
+   *  - header: magic "MRMTGEOM", version (uint32), reserved (uint32), geometry hash (uint64)
+   *  - the surface tables, calorimeters, disk petals and TPCs, each section starting with
+   *    its number of entries (uint64), strings and arrays prefixed by their size (uint64)
+   *  - the magnetic field z component at the origin (double)
+   *  The geometry hash is computed from the content of the DD4hep compact file and of the
+   *  files it includes (see geometryHash()). A cache file with another version or hash is ignored.
+   *  Only the TPC parameters listed in the implementation are cached. The surface bounds
+   *  are only computed when writing the cache file: with the DD4hep geometry loaded, the
+   *  DDRec surfaces provide them.
+   *  Example usage: <br>
+   *  <pre>
+   *     _geometry = GeometrySnapshot::instance() ;
+   *     _surfaces = _geometry->surfaces( "VXD" ) ;
+   *  </pre>
+   */
+  class GeometrySnapshot {
+  public:
+    /// The cache file format version
+    static constexpr std::uint32_t Version = 3 ;
+
+  public:
+    GeometrySnapshot( const GeometrySnapshot& ) = delete ;
+    GeometrySnapshot& operator=( const GeometrySnapshot& ) = delete ;
+
+    /** Set the process wide geometry cache settings, before the snapshot is created. Thread safe.
+     *  Calling it again with the same settings is a no-op. Throws if the settings differ from
+     *  a previous call, or if the snapshot was already created without these settings
+     *  @param cacheFile the geometry cache file name (empty: not used)
+     *  @param compactFile the DD4hep compact file the cache is validated against (required with a cache file)
+     */
+    static void configure( const std::string &cacheFile, const std::string &compactFile ) ;
+
+    /** Get the process snapshot, created on first call. Thread safe.
+     *  If a cache file is configured, the snapshot is read from it if it is valid for the
+     *  compact file. Else it is extracted from dd4hep::Detector and written to the cache file.
+     *  Throws if the geometry can't be read, or if no geometry is loaded in dd4hep::Detector
+     *  when it has to be extracted. Nothing is cached in that case
+     */
+    static std::shared_ptr<const GeometrySnapshot> instance() ;
+
+    /** Compute the geometry hash of a DD4hep compact file, from its content and,
+     *  recursively, the content of the files referenced by its include elements.
+     *  Other external inputs (e.g field maps) are not part of the hash.
+     *  Throws if a file can't be read
+     */
+    static std::uint64_t geometryHash( const std::string &compactFile ) ;
+
+    /** Read a geometry cache file. Returns nullptr if the file doesn't exist,
+     *  is invalid or was written for another version or geometry hash
+     */
+    static std::shared_ptr<const GeometrySnapshot> read( const std::string &fileName, std::uint64_t hash ) ;
+
+    /** Extract the geometry data from the detector
+     */
+    GeometrySnapshot( const dd4hep::Detector &detector ) ;
+
+    /** The surfaces of a sub-detector. Returns nullptr if none
+     */
+    const SurfaceTable *surfaces( const std::string &detector ) const ;
+
+    /** The calorimeter data of a sub-detector. Returns nullptr if none
+     */
+    const CalorimeterGeometry *calorimeter( const std::string &detector ) const ;
+
+    /** The calorimeters with all the includeFlag bits and none of the excludeFlag
+     *  bits set in their type flag, as dd4hep::DetectorSelector does
+     */
+    std::vector<const CalorimeterGeometry*> calorimeters( unsigned long includeFlag, unsigned long excludeFlag = 0 ) const ;
+
+    /** The disk petals data of a sub-detector. Returns nullptr if none
+     */
+    const ZDiskPetalsGeometry *zDiskPetals( const std::string &detector ) const ;
+
+    /** The TPC data of a sub-detector. Returns nullptr if none
+     */
+    const dd4hep::rec::FixedPadSizeTPCData *fixedPadSizeTPC( const std::string &detector ) const ;
+
+    /** The z component of the magnetic field at the origin, in dd4hep units
+     */
+    double magneticField() const ;
+
+    /** Whether the snapshot has no geometry data at all, e.g extracted while
+     *  no geometry was loaded
+     */
+    bool empty() const ;
+
+    /** Write the snapshot to a geometry cache file. The file is first written
+     *  in a temporary file and then renamed, so that concurrent readers never see a
+     *  partial file. Returns false if the file could not be written or if the snapshot
+     *  is empty
+     *  @param fileName the cache file name
+     *  @param hash the geometry hash to store
+     */
+    bool write( const std::string &fileName, std::uint64_t hash ) const ;
+
+  private:
+    GeometrySnapshot() = default ;
+
+  private:
+    /// The surfaces per sub-detector
+    std::map<std::string, SurfaceTable>                              _surfaces {} ;
+    /// The calorimeters per sub-detector
+    std::map<std::string, CalorimeterGeometry>                       _calorimeters {} ;
+    /// The disk petals per sub-detector
+    std::map<std::string, ZDiskPetalsGeometry>                       _zDiskPetals {} ;
+    /// The TPCs per sub-detector (plain copy, already a flat structure)
+    std::map<std::string, dd4hep::rec::FixedPadSizeTPCData>          _tpcs {} ;
+    /// The z component of the magnetic field at the origin
+    double                                                           _magneticField {0.} ;
+  };
+
+}
+
+#endif
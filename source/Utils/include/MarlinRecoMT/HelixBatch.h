@@ -0,0 +1,135 @@
+#ifndef MARLINRECOMT_HELIXBATCH_h
+#define MARLINRECOMT_HELIXBATCH_h 1
+
+// -- marlinreco mt headers
+#include <MarlinRecoMT/LCGeometryTypes.h>
+#include <MarlinRecoMT/HelixIntersections.h>
+#include <MarlinRecoMT/Span.h>
+
+// -- std headers
+#include <cstddef>
+#include <vector>
+
+namespace marlinreco_mt {
+
+  /** A set of helices, stored as structure of arrays, extrapolated all at once.
+   *  The helices use the SimpleHelix parametrisation (d0, phi0, omega, z0, tanLambda
+   *  at a reference point, s=0 at the point of closest approach) and give the same
+   *  results track by track. The cached quantities (centre, phase, dip angle) are
+   *  computed once in addHelix(), the extrapolations are plain loops over the helices.
+   *  The output spans must have one entry per helix, std::invalid_argument is thrown
+   *  otherwise.
+   *  Example usage: <br>
+   *  <pre>
+   *     HelixBatch helices( 3.5 ) ;
+   *     for( auto track : tracks ) {
+   *       helices.addHelix( d0, phi0, omega, z0, tanLambda, reference, &covariance ) ;
+   *     }
+   *     std::vector<double> s( helices.size() ) ;
+   *     std::vector<HelixIntersectionStatus> status( helices.size() ) ;
+   *     helices.intersectionsWithCylinder( ecalBarrel, s, status ) ;
+   *     helices.positionsAt( s, x, y, z ) ;
+   *  </pre>
+   */
+  class HelixBatch {
+  public:
+    /** Constructor
+     *  @param bField the magnetic field (Tesla), used for the momentum covariances
+     */
+    explicit HelixBatch( double bField ) ;
+
+    /** Reserve space for n helices
+     */
+    void reserve( std::size_t n ) ;
+
+    /** Remove all the helices, keep the allocated memory
+     */
+    void clear() ;
+
+    /** Add a helix. Returns its index, the number of helices added before
+     *  @param d0 the impact parameter
+     *  @param phi0 the azimuthal angle at the point of closest approach
+     *  @param omega the signed curvature
+     *  @param z0 the z position at the point of closest approach
+     *  @param tanLambda the dip angle tangent
+     *  @param referencePoint the reference point of the parameters
+     *  @param errors the covariance matrix of the parameters (optional)
+     */
+    unsigned int addHelix( double d0, double phi0, double omega, double z0, double tanLambda,
+                           const LCVector3D &referencePoint, const LCErrorMatrix<5> *errors = nullptr ) ;
+
+    /** The number of helices */
+    std::size_t size() const { return _d0.size() ; }
+
+    /** The magnetic field (Tesla) */
+    double bField() const { return _bField ; }
+
+    /** The coefficients of a helix used by the intersection computations */
+    HelixCoefficients coefficients( std::size_t index ) const ;
+
+    /** The positions of the helices at the given path lengths
+     *  @param s the path length, per helix
+     *  @param x, y, z return arguments, the positions
+     */
+    void positionsAt( Span<const double> s, Span<double> x, Span<double> y, Span<double> z ) const ;
+
+    /** The directions (unit vectors) of the helices at the given path lengths
+     *  @param s the path length, per helix
+     *  @param dx, dy, dz return arguments, the directions
+     */
+    void directionsAt( Span<const double> s, Span<double> dx, Span<double> dy, Span<double> dz ) const ;
+
+    /** The closest intersections of the helices with a plane in the forward direction.
+     *  See SimpleHelix::intersectWithPlane()
+     *  @param plane the plane to intersect with
+     *  @param s return argument, the path lengths at the intersections
+     *  @param status return argument, the intersection status
+     */
+    void intersectionsWithPlane( const LCPlane3D &plane, Span<double> s, Span<HelixIntersectionStatus> status ) const ;
+
+    /** The closest intersections of the helices with a cylinder in the forward direction.
+     *  See SimpleHelix::intersectWithCylinder()
+     *  @param cylinder the cylinder to intersect with
+     *  @param s return argument, the path lengths at the intersections
+     *  @param status return argument, the intersection status
+     */
+    void intersectionsWithCylinder( const LCCylinder &cylinder, Span<double> s, Span<HelixIntersectionStatus> status ) const ;
+
+    /** The covariance matrices of (x, y, z, px, py, pz) at the given path lengths,
+     *  propagated from the parameter covariance matrices with the analytic Jacobian.
+     *  See propagateHelixCovariance()
+     *  @param s the path length, per helix
+     *  @param covariances return argument, the covariance matrices
+     */
+    void covariancesAt( Span<const double> s, Span<LCErrorMatrix<6>> covariances ) const ;
+
+  private:
+    /// Throw std::invalid_argument if the span size does not match the number of helices
+    void checkSize( std::size_t spanSize ) const ;
+
+  private:
+    /// The magnetic field (Tesla)
+    double                          _bField {0.} ;
+    // the helix parameters
+    std::vector<double>             _d0 {} ;
+    std::vector<double>             _phi0 {} ;
+    std::vector<double>             _omega {} ;
+    std::vector<double>             _z0 {} ;
+    std::vector<double>             _tanLambda {} ;
+    std::vector<LCVector3D>         _reference {} ;
+    std::vector<LCErrorMatrix<5>>   _errors {} ;
+    // the cached quantities, see SimpleHelix
+    std::vector<double>             _xCentre {} ;
+    std::vector<double>             _yCentre {} ;
+    std::vector<double>             _zOffset {} ;
+    std::vector<double>             _absRadius {} ;
+    std::vector<double>             _varphi0 {} ;
+    std::vector<double>             _sinVarphi0 {} ;
+    std::vector<double>             _cosVarphi0 {} ;
+    std::vector<double>             _w {} ;
+    std::vector<double>             _sinLambda {} ;
+  };
+
+}
+
+#endif
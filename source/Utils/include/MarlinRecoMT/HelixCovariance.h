@@ -0,0 +1,53 @@
+#ifndef MARLINRECOMT_HELIXCOVARIANCE_h
+#define MARLINRECOMT_HELIXCOVARIANCE_h 1
+
+// -- marlinreco mt headers
+#include <MarlinRecoMT/LCGeometryTypes.h>
+
+namespace marlinreco_mt {
+
+  /// Jacobian of (x, y, z, px, py, pz) with respect to (d0, phi0, omega, z0, tanLambda)
+  using HelixJacobian = ROOT::Math::SMatrix<double, 6, 5> ;
+  /// Jacobian of (x, y, z) with respect to (d0, phi0, omega, z0, tanLambda)
+  using HelixPositionJacobian = ROOT::Math::SMatrix<double, 3, 5> ;
+
+  /** The position rows of helixJacobian(), which don't depend on the magnetic field
+   *  @param d0 the impact parameter
+   *  @param phi0 the azimuthal angle at the point of closest approach
+   *  @param omega the signed curvature (1/mm)
+   *  @param tanLambda the dip angle tangent
+   *  @param s the path length (mm)
+   */
+  HelixPositionJacobian helixPositionJacobian( double d0, double phi0, double omega, double tanLambda, double s ) ;
+
+  /** The Jacobian of the position and momentum at path length s with respect to the
+   *  helix parameters, in the SimpleHelix parametrisation (s=0 at the point of closest
+   *  approach to the reference point). The momentum is pT = 2.99792458E-4 * bField / |omega|
+   *  @param d0 the impact parameter
+   *  @param phi0 the azimuthal angle at the point of closest approach
+   *  @param omega the signed curvature (1/mm)
+   *  @param tanLambda the dip angle tangent
+   *  @param s the path length (mm)
+   *  @param bField the magnetic field (Tesla)
+   */
+  HelixJacobian helixJacobian( double d0, double phi0, double omega, double tanLambda, double s, double bField ) ;
+
+  /** The covariance matrix of (x, y, z) at path length s, propagated from the
+   *  covariance matrix of the helix parameters. See helixPositionJacobian()
+   */
+  inline LCErrorMatrix<3> propagateHelixPositionCovariance( double d0, double phi0, double omega, double tanLambda,
+                                                             double s, const LCErrorMatrix<5> &errors ) {
+    return ROOT::Math::Similarity( helixPositionJacobian( d0, phi0, omega, tanLambda, s ), errors ) ;
+  }
+
+  /** The covariance matrix of (x, y, z, px, py, pz) at path length s, propagated from
+   *  the covariance matrix of the helix parameters. See helixJacobian()
+   */
+  inline LCErrorMatrix<6> propagateHelixCovariance( double d0, double phi0, double omega, double tanLambda,
+                                                     double s, double bField, const LCErrorMatrix<5> &errors ) {
+    return ROOT::Math::Similarity( helixJacobian( d0, phi0, omega, tanLambda, s, bField ), errors ) ;
+  }
+
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef MARLINRECOMT_HELIXINTERSECTIONS_h
+#define MARLINRECOMT_HELIXINTERSECTIONS_h 1
+
+// -- marlinreco mt headers
+#include <MarlinRecoMT/LCGeometryTypes.h>
+#include <MarlinRecoMT/LCPlane3D.h>
+#include <MarlinRecoMT/LCCylinder.h>
+
+namespace marlinreco_mt {
+
+  /// The status of the helix intersection computations
+  enum class HelixIntersectionStatus : unsigned int {
+    Found,            /// The helix crosses the surface
+    NoIntersection,   /// The helix does not cross the surface in the forward direction
+    NotConverged      /// The solver reached its maximum number of iterations
+  };
+
+  /** The helix quantities needed by the intersection computations.
+   *  The position at path length s is
+   *    x = xCentre + absRadius * cos( varphi0 - w*s )
+   *    y = yCentre + absRadius * sin( varphi0 - w*s )
+   *    z = zOffset + sinLambda * s
+   */
+  struct HelixCoefficients {
+    double xCentre {0.} ;
+    double yCentre {0.} ;
+    double zOffset {0.} ;
+    double absRadius {1.} ;
+    double varphi0 {0.} ;
+    double w {1.} ;
+    double sinLambda {0.} ;
+  };
+
+  /** Compute the helix coefficients from the canonical helix parameters.
+   *  Shared by SimpleHelix and HelixBatch so that both give the same results
+   *  @param d0, phi0, omega, z0, tanLambda the canonical helix parameters
+   *  @param referencePoint the helix reference point
+   *  @param sinVarphi0 return argument, sin( varphi0 )
+   *  @param cosVarphi0 return argument, cos( varphi0 )
+   *  @param cosLambda return argument, the cosine of the dip angle
+   */
+  HelixCoefficients computeHelixCoefficients( double d0, double phi0, double omega, double z0, double tanLambda,
+                                              const LCVector3D &referencePoint,
+                                              double &sinVarphi0, double &cosVarphi0, double &cosLambda ) ;
+
+  /** Closest intersection of a helix with a plane in the forward direction (s >= 0).
+   *  Solved in closed form if the plane is parallel or perpendicular to the helix axis,
+   *  by bracketed Newton iterations otherwise.
+   *  @param helix the helix coefficients
+   *  @param plane the plane to intersect with
+   *  @param s return argument, the path length at the intersection. Set to 0 if not found
+   */
+  HelixIntersectionStatus intersectHelixWithPlane( const HelixCoefficients &helix, const LCPlane3D &plane, double &s ) ;
+
+  /** Whether the cylinder axis is parallel to the helix axis (z)
+   */
+  bool isAxialCylinder( const LCCylinder &cylinder ) ;
+
+  /** Closest intersection of a helix with a cylinder parallel to the helix axis
+   *  (see isAxialCylinder()) in the forward direction (s >= 0), in closed form.
+   *  The end planes are considered if the cylinder is closed.
+   *  @param helix the helix coefficients
+   *  @param cylinder the cylinder to intersect with
+   *  @param s return argument, the path length at the intersection. Set to 0 if not found
+   */
+  HelixIntersectionStatus intersectHelixWithAxialCylinder( const HelixCoefficients &helix, const LCCylinder &cylinder, double &s ) ;
+
+}
+
+#endif
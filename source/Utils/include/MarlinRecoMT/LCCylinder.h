@@ -2,10 +2,16 @@
 #define LCCylinder_H 1
 
 #include <MarlinRecoMT/LCGeometryTypes.h>
+#include <MarlinRecoMT/LCPlane3D.h>
+#include <MarlinRecoMT/LCLine3D.h>
+
+#include <cmath>
+#include <type_traits>
 
 namespace marlinreco_mt {
 
   /** Definition of a LCCylinder describing a geometrical cylinder in 3D space.
+   *  Header only, with the compiler generated copy and assignment.
    *  @author T.Kraemer, DESY
    *  @version $Id: LCCylinder.h,v 1.1 2006-10-16 15:23:32 tkraemer Exp $
    */
@@ -15,91 +21,175 @@ namespace marlinreco_mt {
   public:
 
     /**
-     * Constructor from two points and a radius. 
+     * Constructor from two points and a radius.
      * @param point1 point1 is the start point of the cylinder axis
      * @param point2 point2 is the end point of the cylinder axis
      * @param radius radius is the radius of the xylinder
      * @param endPlane endPlane switches if cylinder is open or not
      */
-    LCCylinder(const LCVector3D &point1, 
-  	     const LCVector3D &point2, 
-  	     double radius, 
-  	     bool endPlane = false) ;
+    LCCylinder(const LCVector3D &point1,
+  	     const LCVector3D &point2,
+  	     double radius,
+  	     bool endPlane = false) :
+      _radius(std::fabs(radius)),
+      _endPlane(endPlane),
+      _axisSstartPoint(point1),
+      _axisEndPoint(point2)
+    {}
 
     /**
      * Constructor from one point, th Axis of the cylinder and the radius
      * @param radius radius of cylinder.
      * @param point point in the middle of the axis of the xylinder
-     * @param axis axis is the orientation of the xylinder axis. 
+     * @param axis axis is the orientation of the xylinder axis.
      *             the length of axis is the half length of the cylinder
      * @param endPlane endPlane switches if cylinder is open or not
      */
-    LCCylinder(double radius, const LCVector3D &point, const LCVector3D &axis, bool endPlane) ;
-
-    /** Copy constructor.
-     * @param cylinder cylinder is an other LCCylinder.
-     */
-    LCCylinder(const LCCylinder & cylinder) ;
-
-    /**
-     * Destructor. */
-    ~LCCylinder() {}
-
-    /**
-     * Assignment. */
-    LCCylinder & operator=(const LCCylinder & rhs) ;
+    LCCylinder(double radius, const LCVector3D &point, const LCVector3D &axis, bool endPlane) :
+      _radius(std::fabs(radius)),
+      _endPlane(endPlane),
+      _axisSstartPoint(point - axis),
+      _axisEndPoint(point + axis)
+    {}
 
     /**
      * startpoint of cylinder axis */
-    LCVector3D startPoint() const ;
+    LCVector3D startPoint() const { return _axisSstartPoint ; }
 
     /**
      * end point of cylinder axis */
-    LCVector3D endPoint() const ;
+    LCVector3D endPoint() const { return _axisEndPoint ; }
 
     /**
      * orientation of cylinder axis. the return vector is normalised */
-    LCVector3D axisDirection() const ;
+    LCVector3D axisDirection() const
+    {
+      return (_axisEndPoint - _axisSstartPoint).unit();
+    }
 
     /**
      * length of cylinder axis */
-    double length() const ;
+    double length() const
+    {
+      return std::sqrt((_axisEndPoint - _axisSstartPoint).mag2());
+    }
 
     /**
      * Radius of cylinder.  */
-    double radius() const ;
+    constexpr double radius() const { return _radius ; }
 
     /**
-     * Distance of a point to the cylinder. 
+     * Whether the cylinder is closed by its end planes */
+    constexpr bool endPlane() const { return _endPlane ; }
+
+    /**
+     * Distance of a point to the cylinder.
      * @param point point is a point in space
      */
-    double distance(const LCVector3D & point) const ;  
+    double distance(const LCVector3D & point) const
+    {
+      int dummy ;
+      return std::sqrt((point - projectPoint( point, dummy ) ).mag2()) ;
+    }
 
     /**
-     * Projection of a point on to the surface of the cylinder. 
+     * Projection of a point on to the surface of the cylinder.
      * @param point point is a point in space.
-     * @param code code gives an integer code for the type of area the 
+     * @param code code gives an integer code for the type of area the
      * point gets projected to:
      * 0 : No projection possible (point is not normal above the surface)
-     * 1 : prjection hits plane at start point ( startPoint() ) 
-     * 2 : prjection hits plane at end point ( endPoint() ) 
+     * 1 : prjection hits plane at start point ( startPoint() )
+     * 2 : prjection hits plane at end point ( endPoint() )
      * 3 : projection hits the finite tube of the cylinder
      */
-    LCVector3D projectPoint(const LCVector3D & point, int & code) const ;
+    LCVector3D projectPoint(const LCVector3D & point, int & code) const
+    {
+      const LCVector3D direction = axisDirection() ;
+      LCLine3D a( _axisSstartPoint , direction );
+      double s = a.projectPoint( _axisSstartPoint ) ;
+      double e = a.projectPoint( _axisEndPoint ) ;
+      double p = a.projectPoint( point ) ;
+      double d = a.distance( point ) ;
+
+      double drp = std::fabs( d - _radius ) ;
+      double dsp = std::fabs( s - p ) ;
+      double dep = std::fabs( e - p ) ;
+
+      // classify in which region the point is located:
+      // on the end planes if the cylinder is closed and the point is within the radius
+      if (_endPlane && (d <= _radius) )
+        {
+          const bool between = ( p >= s && p <= e ) ;
+          if ( between && (drp <= dsp) && (drp <= dep) )
+            {
+              code = 3;
+              return tubePoint( a, direction, point, p, p ) ;
+            }
+          else if ( between ? (dsp <= dep) : (p < s) )
+            {
+              code = 1;
+              return LCPlane3D(-direction,_axisSstartPoint).projectPoint( point );
+            }
+          else
+            {
+              code = 2;
+              return LCPlane3D(direction,_axisEndPoint).projectPoint( point );
+            }
+        }
+      // on the tube, or on the tube edges if outside the two planes at the end
+      if ( p >= s && p <= e )
+        {
+          code = 3;
+          return tubePoint( a, direction, point, p, p ) ;
+        }
+      code = 0;
+      return tubePoint( a, direction, point, p, (p < s) ? s : e ) ;
+    }
 
     /**
      * Checks if a given point is inside the clyinder.
      * @param point point is a point in space.
      */
-    bool isInside(const LCVector3D & point) const ;
+    bool isInside(const LCVector3D & point) const
+    {
+      LCLine3D a( _axisSstartPoint , axisDirection() );
+
+      if ( _radius < a.distance( point ) ) return false ;
+
+      double s = a.projectPoint( _axisSstartPoint ) ;
+      double e = a.projectPoint( _axisEndPoint ) ;
+      double p = a.projectPoint( point ) ;
+      if (p < s || p > e) return false;
+
+      return true ;
+    }
 
     /**
      * Test for equality. */
-    bool operator==(const LCCylinder & rhs) const ; 
+    bool operator==(const LCCylinder & rhs) const
+    {
+      return (_radius == rhs._radius &&
+              _axisSstartPoint == rhs._axisSstartPoint &&
+              _axisEndPoint == rhs._axisEndPoint &&
+              _endPlane == rhs._endPlane ) ;
+    }
 
     /**
      * Test for inequality. */
-    bool operator!=(const LCCylinder & rhs) const ; 
+    bool operator!=(const LCCylinder & rhs) const
+    {
+      return !( *this == rhs ) ;
+    }
+
+  private:
+    /// The point at radius() from the axis point at sAxis, in the radial direction of the point at sPoint
+    LCVector3D tubePoint(const LCLine3D &axis, const LCVector3D &direction,
+                         const LCVector3D &point, double sPoint, double sAxis) const
+    {
+      LCVector3D radial = ( point - axis.position(sPoint) ).unit() ;
+      if (std::sqrt(radial.mag2()) < 0.00001) radial = vector::orthogonal(direction).unit() ;
+      return axis.position(sAxis) + radial * _radius ;
+    }
 
   protected:
 
@@ -110,6 +200,10 @@ namespace marlinreco_mt {
     LCVector3D _axisEndPoint;
 
   };
+
+  // no user defined copy: as cheap to copy as the underlying ROOT vectors
+  static_assert( std::is_trivially_copyable<LCCylinder>::value == std::is_trivially_copyable<LCVector3D>::value,
+                 "LCCylinder must not define its own copy operations" ) ;
   
 }
 
@@ -4,9 +4,15 @@
 #include <MarlinRecoMT/LCGeometryTypes.h>
 #include <MarlinRecoMT/LCPlane3D.h>
 
+#include <cfloat>
+#include <cmath>
+#include <ostream>
+#include <type_traits>
+
 namespace marlinreco_mt {
 
   /** Definition of a LCLine3D describing a geometrical line in 3D space.
+   *  Header only, with the compiler generated copy and assignment.
    *  @author T.Kraemer, DESY
    *  @version $Id: LCLine3D.h,v 1.8 2006-11-03 16:43:13 tkraemer Exp $
    */
@@ -17,124 +23,211 @@ namespace marlinreco_mt {
     /** Standard constructor:
      * Initializes a line along the x-axis.
      */
-    LCLine3D();
+    LCLine3D() = default ;
 
     /**
      * Constructor from a point and a direction.
      * @param point Point is a point of the line
      * @param direction Direction is the directional vector of the line.
      */
-    LCLine3D(const LCVector3D & point, const LCVector3D & direction) ;
+    LCLine3D(const LCVector3D & point, const LCVector3D & direction)
+    {
+      set( point, direction, LCVector3D(0.,0.,0.) );
+    }
 
     /**
      * Constructor from a point and a direction.
      * @param point Point is a point of the line
      * @param direction Direction is the directional vector of the line.
-     * @param reference reference point of the line. 
+     * @param reference reference point of the line.
      */
-    LCLine3D(const LCVector3D & point, 
-  	   const LCVector3D & direction, 
-  	   const LCVector3D & reference) ;
+    LCLine3D(const LCVector3D & point,
+  	   const LCVector3D & direction,
+  	   const LCVector3D & reference)
+    {
+      set( point, direction, reference );
+    }
 
     /**
-     * Constructor using the canonical parameterization. 
+     * Constructor using the canonical parameterization.
      * @param d0 d0 is the point of closest approach in the xy plane.
      * @param phi0 phi0 is the angle in  the xy plane.
      * @param z0 z0 is the z coordinate of the point of closest approach.
      * @param tanLambda tanLambda is the angle of with respect to the xy plane.
      */
-    LCLine3D(double d0, double phi0, double z0, double tanLambda) ;
+    LCLine3D(double d0, double phi0, double z0, double tanLambda)
+    {
+      set( d0, phi0, z0, tanLambda, LCVector3D(0.,0.,0.) );
+    }
 
     /**
-     * Constructor using the canonical parameterization. 
+     * Constructor using the canonical parameterization.
      * @param d0 d0 is the point of closest approach in the xy plane.
      * @param phi0 phi0 is the angle in  the xy plane.
      * @param z0 z0 is the z coordinate of the point of closest approach.
      * @param tanLambda tanLambda is the angle of with respect to the xy plane.
-     * @param reference reference point of the line. 
+     * @param reference reference point of the line.
      */
     LCLine3D(double d0, double phi0, double z0, double tanLambda,
-  	   const LCVector3D & reference) ;
-
-    /** Copy constructor.
-     * @param line line is an other LCLine3D.
-     */
-    LCLine3D(const LCLine3D & line) ;
-
-    /**
-     * Destructor. */
-    ~LCLine3D() {}
+  	   const LCVector3D & reference)
+    {
+      set( d0, phi0, z0, tanLambda, reference );
+    }
 
     /**
      * set the Parameters for a line using a point and a direction.
      * @param point Point is a point of the line
      * @param direction Direction is the directional vector of the line.
-     * @param reference reference point of the line. 
+     * @param reference reference point of the line.
      */
-    bool set(const LCVector3D & point, 
-  	   const LCVector3D & direction, 
-  	   const LCVector3D & reference) ;
+    bool set(const LCVector3D & point,
+  	   const LCVector3D & direction,
+  	   const LCVector3D & reference)
+    {
+      _reference = reference;
+      _direction = direction.unit();
+      if (_direction.mag2() == 0)
+        {
+          return false;
+        }
+
+      // calculate _point to be the PCA to the reference point according to the
+      // definition given in LC-LC-DET-2006-004:
+      // the x,y compnents have to beh teh  PCA, the z compnente is calculated
+      // after that.
+      LCVector3D p = point, d = _direction;
+      p.SetZ(0.);
+      d.SetZ(0.);
+      auto mag = std::sqrt(d.mag2());
+
+      if (mag !=  0.)
+        {
+          double sFaktor = 1./mag;
+          d = d.unit();
+          double s = ( - p.Dot(d) ) / d.mag2() ;
+          _point = ( (point + _direction*s*sFaktor) );
+        }
+      else
+        {
+          _point = point;
+          _point.SetZ(0.);
+        }
+      return true;
+    }
 
     /**
-     * Set the Parameters of a line using the canonical parameterization. 
+     * Set the Parameters of a line using the canonical parameterization.
      * @param d0 d0 is the point of closest approach in the xy plane.
      * @param phi0 phi0 is the angle in  the xy plane.
      * @param z0 z0 is the z coordinate of the point of closest approach.
      * @param tanLambda tanLambda is the angle of with respect to the xy plane.
-     * @param reference reference point of the line. 
+     * @param reference reference point of the line.
      */
     bool set(double d0, double phi0, double z0, double tanLambda,
-  	   const LCVector3D & reference) ;
+  	   const LCVector3D & reference)
+    {
+      _reference = reference;
+      _direction.SetXYZ( std::cos(phi0), std::sin(phi0), tanLambda );
+      _direction = _direction.unit();
+      if (d0 == 0.)
+        {
+          _point.SetXYZ(0.,0.,z0);
+        }
+      else
+        {
+          _point.SetXYZ( ( d0*std::sin(phi0) ), ( d0*std::cos(phi0) ), z0 );
+        }
+      return true;
+    }
 
     /**
-     * Assignment. */
-    LCLine3D & operator=(const LCLine3D & rhs) ;
-
-    /**
-     * Position is the point of the line after a distance s. 
+     * Position is the point of the line after a distance s.
      * Is is given with respect to the point of closes approach to the origen of
-     * the coordinate system. 
+     * the coordinate system.
      * @param s s is the path length along the line */
-    LCVector3D position(const double s = 0) const ;
+    LCVector3D position(const double s = 0) const
+    {
+      return (_reference+_point + s*_direction) ;
+    }
 
-    /** Direction of the line 
+    /** Direction of the line
      */
-    LCVector3D direction() const ;
+    LCVector3D direction() const
+    {
+      return _direction;
+    }
 
     /**
-     * Distance of a point to the line. 
+     * Distance of a point to the line.
      * @param point point is a point in space
      */
-    double distance(const LCVector3D & point) const ;  
+    double distance(const LCVector3D & point) const
+    {
+      return std::sqrt(( point - position( projectPoint( point ) ) ).mag2()) ;
+    }
 
     /**
-     * Projection of a point on to the line. 
+     * Projection of a point on to the line.
      * @param point point is a point in space.
      */
-    double projectPoint(const LCVector3D & point) const ;
+    double projectPoint(const LCVector3D & point) const
+    {
+      // the last therm : (...) / _direction.mag2() is not there becaus
+      // the _direction vector is normalised.
+      return ( point.Dot(_direction) - (_reference+_point).Dot(_direction) ) / _direction.mag2() ;
+    }
 
     /**
      * Test for equality. */
-    bool operator==(const LCLine3D & rhs) const ; 
+    bool operator==(const LCLine3D & rhs) const
+    {
+      return (_point == rhs._point &&
+              _direction == rhs._direction &&
+              _reference == rhs._reference);
+    }
 
     /**
      * Test for inequality. */
-    bool operator!=(const LCLine3D & rhs) const ; 
+    bool operator!=(const LCLine3D & rhs) const
+    {
+      return !( *this == rhs ) ;
+    }
 
     /** Pathlength at closest intersection point with plane - undefined
      *  if pointExists==false.
      */
-    double intersectionWithPlane(const LCPlane3D plane, bool& pointExists) const ;
+    double intersectionWithPlane(const LCPlane3D &plane, bool& pointExists) const
+    {
+      // the plane coefficients are normalised on construction
+      const LCVector3D normal( plane.a(), plane.b(), plane.c() ) ;
+      double c = _direction.Dot(normal) ;
+
+      if (c == 0)
+        { // no interaction
+          pointExists = false;
+          return DBL_MAX;
+        }
+
+      pointExists = true;
+      return - ( position().Dot(normal) + plane.d() ) / c ;
+    }
 
   protected:
 
-    LCVector3D _point{};
-    LCVector3D _direction{};
-    LCVector3D _reference{};
+    LCVector3D _point{0.,0.,0.};
+    LCVector3D _direction{1.,0.,0.};
+    LCVector3D _reference{0.,0.,0.};
   };
 
-  std::ostream & operator << (std::ostream &os, const LCLine3D &l) ;
-  
+  // no user defined copy: as cheap to copy as the underlying ROOT vectors
+  static_assert( std::is_trivially_copyable<LCLine3D>::value == std::is_trivially_copyable<LCVector3D>::value,
+                 "LCLine3D must not define its own copy operations" ) ;
+
+  inline std::ostream & operator << (std::ostream &os, const LCLine3D &l)
+  {
+    return os << l.position() << "+s*" << l.direction() ;
+  }
+
 }
 
 #endif /* ifndef LCLine3D_H */
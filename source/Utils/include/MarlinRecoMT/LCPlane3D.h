@@ -4,9 +4,16 @@
 // #include "CLHEP/Vector/ThreeVector.h"
 #include <MarlinRecoMT/LCGeometryTypes.h>
 
+#include <cmath>
+#include <ostream>
+#include <sstream>
+#include <type_traits>
+
 namespace marlinreco_mt {
 
   /** Definition of a LCPlane3D describing a geometrical plane in 3D space.
+   *  Header only and trivially copyable: pass it by const reference or by value
+   *  in tight loops, all the computations can be inlined.
    *  @author T.Kraemer, DESY
    *  @version $Id: LCPlane3D.h,v 1.3 2006-10-19 15:59:26 tkraemer Exp $
    */
@@ -15,110 +22,201 @@ namespace marlinreco_mt {
   public:
 
     /**
-     * Constructor from four numbers - creates plane a*x+b*y+c*z+d=0. 
+     * Constructor from four numbers - creates plane a*x+b*y+c*z+d=0.
      * @param a
      * @param b
      * @param c
      * @param d
      */
-    LCPlane3D(double a = 0, double b = 0, double c = 1, double d = 0) ;
-
-    /**
-     * Constructor from normal and point. 
-     * @param normal vector pointing in the direction of the normal. 
+    LCPlane3D(double a = 0, double b = 0, double c = 1, double d = 0) :
+      _a(a),
+      _b(b),
+      _c(c),
+      _d(d)
+    {
+      normalize();
+
+      // _d has to be negative to give the distance with the normal vector pointing
+      // away from the Origen !!!
+      if (_d > 0)
+        {
+          _a = -_a;
+          _b = -_b;
+          _c = -_c;
+          _d = -_d;
+        }
+    }
+
+    /**
+     * Constructor from normal and point.
+     * @param normal vector pointing in the direction of the normal.
      *               This vector does not have to be normalised.
      * @param point Point on the plane.
      */
-    LCPlane3D(const LCVector3D &normal, const LCVector3D &point) ;
+    LCPlane3D(const LCVector3D &normal, const LCVector3D &point)
+    {
+      LCVector3D n = normal.unit();
+      _a = n.x();
+      _b = n.y();
+      _c = n.z();
+      _d = - n.Dot(point);
+    }
 
     /**
-     * Constructor from three different points. 
+     * Constructor from three different points.
      * @param point1 Point on the plane.
      * @param point2 Point on the plane.
      * @param point3 Point on the plane.
      */
-    LCPlane3D(const LCVector3D &point1, const LCVector3D &point2, const LCVector3D &point3) ;
-
-    /** Constructor for a plane using a normal and the Distance between Origen 
+    LCPlane3D(const LCVector3D &point1, const LCVector3D &point2, const LCVector3D &point3)
+    {
+      LCVector3D n = ( (point2-point1).Cross(point3-point1) ).unit();
+      _a = n.x() ;
+      _b = n.y() ;
+      _c = n.z() ;
+      _d = - n.Dot(point1);
+    }
+
+    /** Constructor for a plane using a normal and the Distance between Origen
      * and the plane.
-     * @param normal vector pointing in the direction of the normal. 
+     * @param normal vector pointing in the direction of the normal.
      *               This vector does not have to be normalised.
-     * @param distance distance is the distance from the origen to the plane. 
+     * @param distance distance is the distance from the origen to the plane.
      */
-    LCPlane3D(const LCVector3D &normal, double distance) ;
-
-    /** Copy constructor.
-     * @param plane plane is an other LCPlane3D.
-     */
-    LCPlane3D(const LCPlane3D & plane) ;
-
-    /**
-     * Destructor. */
-    ~LCPlane3D() {}
-
-    /**
-     * Assignment. */
-
-    LCPlane3D & operator=(const LCPlane3D & rhs) ;
+    LCPlane3D(const LCVector3D &normal, double distance)
+    {
+      LCVector3D n = normal.unit() ;
+      _a = n.x();
+      _b = n.y();
+      _c = n.z();
+      _d = distance * -1.f;
+    }
 
     /**
      * Returns the a-coefficient in the plane equation: a*x+b*y+c*z+d=0. */
-    double a() const ; 
+    constexpr double a() const { return _a ; }
 
     /**
      * Returns the b-coefficient in the plane equation: a*x+b*y+c*z+d=0. */
-    double b() const ; 
+    constexpr double b() const { return _b ; }
 
     /**
      * Returns the c-coefficient in the plane equation: a*x+b*y+c*z+d=0. */
-    double c() const ; 
+    constexpr double c() const { return _c ; }
 
     /**
      * Returns the free member of the plane equation: a*x+b*y+c*z+d=0. */
-    double d() const ;
+    constexpr double d() const { return _d ; }
 
     /**
      * Returns normal. */
-    LCVector3D normal() const ;
+    LCVector3D normal() const
+    {
+      return LCVector3D(_a,_b,_c).unit();
+    }
 
     /**
      * Normalization. */
-    LCPlane3D & normalize() ;
-
-    /**
-     * Distance of a point to the plane. 
-     * The value of the distance is 
+    LCPlane3D & normalize()
+    {
+      double norm = std::sqrt( _a*_a + _b*_b + _c*_c );
+      if (norm > 0.)
+        {
+          _a /= norm;
+          _b /= norm;
+          _c /= norm;
+          _d /= norm;
+        }
+      return *this;
+    }
+
+    /**
+     * Distance of a point to the plane.
+     * The value of the distance is
      * - negative if the point and the origen are on the same side of the plane
-     * - positive if the Point and the origen are on opposite sides of the 
+     * - positive if the Point and the origen are on opposite sides of the
      *   plane.
      * @param point point is a point in space
      */
-    double distance(const LCVector3D & point) const ;  
+    double distance(const LCVector3D & point) const
+    {
+      return _a*point.x() + _b*point.y() + _c*point.z() + _d ;
+    }
 
     /**
-     * Projection of a point on to the plane. 
+     * Projection of a point on to the plane.
      * @param point point is a point in space.
      */
-    LCVector3D projectPoint(const LCVector3D & point) const ;
+    LCVector3D projectPoint(const LCVector3D & point) const
+    {
+      double k = distance(point) / ( _a*_a + _b*_b + _c*_c );
+      return LCVector3D( point.x()-_a*k, point.y()-_b*k, point.z()-_c*k);
+    }
 
     /**
      * Projection of the origin onto the plane. */
-    LCVector3D projectPoint() const ;
+    LCVector3D projectPoint() const
+    {
+      double k = -_d / ( _a*_a + _b*_b + _c*_c );
+      return LCVector3D( _a*k, _b*k, _c*k);
+    }
 
     /**
      * Test for equality. */
-    bool operator==(const LCPlane3D & plane) const ; 
+    constexpr bool operator==(const LCPlane3D & plane) const
+    {
+      return ( _a == plane._a &&
+               _b == plane._b &&
+               _c == plane._c &&
+               _d == plane._d );
+    }
 
     /**
      * Test for inequality. */
-    bool operator!=(const LCPlane3D & plane) const ; 
+    constexpr bool operator!=(const LCPlane3D & plane) const
+    {
+      return !( *this == plane );
+    }
 
   protected:
     double _a=0, _b=0, _c=0, _d=0;
   };
 
-  std::ostream & operator << (std::ostream &os, const LCPlane3D &p) ;
-  
+  static_assert( std::is_trivially_copyable<LCPlane3D>::value, "LCPlane3D must be trivially copyable" ) ;
+
+  inline std::ostream & operator << (std::ostream &os, const LCPlane3D &p)
+  {
+    std::stringstream returnString ;
+    bool isFirst = true;
+
+    returnString << "(" ;
+    if (p.a() != 0)
+      {
+        returnString << p.a() << "*x" ;
+        isFirst = false;
+      }
+    if (p.b() != 0)
+      {
+        if (!isFirst && (p.b() > 0.) ) returnString << "+";
+        returnString << p.b() << "*y" ;
+        isFirst = false;
+      }
+    if (p.c() != 0)
+      {
+        if (!isFirst && (p.c() > 0) ) returnString << "+";
+        returnString << p.c() << "*z" ;
+        isFirst = false;
+      }
+    if (p.d() != 0)
+      {
+        if (!isFirst && (p.d() > 0) ) returnString << "+";
+        returnString << p.d() ;
+      }
+    returnString << "=0)" ;
+
+    return os << returnString.str() ;
+  }
+
 }
 
 #endif /* ifndef LCPlane3D_H */
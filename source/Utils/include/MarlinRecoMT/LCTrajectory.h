@@ -47,7 +47,7 @@ namespace marlinreco_mt {
     /** Pathlength at closest intersection point with plane - undefined 
      *  if pointExists==false. 
      */
-    virtual double getIntersectionWithPlane( LCPlane3D p, bool& pointExists) const = 0 ;
+    virtual double getIntersectionWithPlane( const LCPlane3D &p, bool& pointExists) const = 0 ;
     
     
     /** Pathlength at closest intersection point with cylinder - undefined 
@@ -2,28 +2,40 @@
 #define SimpleHelix_H 1
 
 #include <MarlinRecoMT/LCTrajectory.h>
+#include <MarlinRecoMT/HelixIntersections.h>
 
 namespace marlinreco_mt {
 
   /** Simple helix trajectory.
+   *  The helix centre, the trigonometric functions of the starting phase and the
+   *  dip angle are computed once at construction. getPathAt() solves for the point
+   *  of closest approach with a few Newton iterations started from an analytic guess,
+   *  the plane and cylinder intersections are solved in closed form or by bracketed
+   *  Newton iterations, with a bounded number of iterations in all cases.
    *  @author T.Kraemer, DESY
    *  @version $Id: SimpleHelix.h,v 1.7 2007-06-20 18:47:25 samson Exp $
    */
   class SimpleHelix : public LCTrajectory {
 
+  public:
+    using IntersectionStatus = HelixIntersectionStatus ;
+
   public:
 
     virtual ~SimpleHelix() {} 
    
     /** Construct Helix from canonical parameters.
+     *  The magnetic field (Tesla) is only used for the momentum covariances:
+     *  without it, getCovarianceMatrix() throws.
      */
     SimpleHelix( double d0, double phi0, double omega,
   	       double z0, double tanLambda, 
-  	       LCVector3D referencePoint, LCErrorMatrix<5>* errors=0) ;
+  	       LCVector3D referencePoint, LCErrorMatrix<5>* errors=0,
+  	       double bField=0.) ;
     
     /** Position at path length s - s==0 corresponds to P.C.A to the origin.
      *  @param s      path length
-     *  @param errors return argument - not computed if NULL
+     *  @param errors return argument, the position covariance - not computed if NULL
      */
     virtual LCVector3D getPosition(double s, LCErrorMatrix<3>* errors=0) const ;
     
@@ -33,7 +45,9 @@ namespace marlinreco_mt {
      */
     virtual LCVector3D getDirection(double s,  LCErrorMatrix<3>* errors=0) const ;
     
-    /** Full covariance Matrix of x,y,z,px,py,pz   
+    /** Full covariance Matrix of x,y,z,px,py,pz, propagated from the helix
+     *  parameter covariance with the analytic Jacobian (see propagateHelixCovariance()).
+     *  Throws std::logic_error if the helix was built without magnetic field.
      *  @param s      path length
      */
     virtual LCErrorMatrix<6> getCovarianceMatrix( double s) const ;
@@ -54,7 +68,7 @@ namespace marlinreco_mt {
     /** Pathlength at closest intersection point with plane - undefined 
      *  if pointExists==false. 
      */
-    virtual double getIntersectionWithPlane( LCPlane3D p, bool& pointExists) const  ;
+    virtual double getIntersectionWithPlane( const LCPlane3D &p, bool& pointExists) const  ;
     
     /** Pathlength at closest intersection point with cylinder - undefined 
      *  if pointExists==false. 
@@ -63,6 +77,26 @@ namespace marlinreco_mt {
     virtual  double getIntersectionWithCylinder(const LCCylinder & cylinder,
                                                 bool & pointExists) const ;
 
+    /** Closest intersection with a plane in the forward direction (s >= 0).
+     *  The intersection is solved in closed form if the plane is parallel to the helix
+     *  axis or perpendicular to it, by bracketed Newton iterations otherwise.
+     *  @param plane the plane to intersect with
+     *  @param s return argument, the path length at the intersection. Set to 0 if not found
+     */
+    IntersectionStatus intersectWithPlane( const LCPlane3D &plane, double &s ) const ;
+
+    /** Closest intersection with a cylinder in the forward direction (s >= 0).
+     *  The intersection is solved in closed form for cylinders parallel to the helix axis,
+     *  by stepping along the helix with a bounded number of steps otherwise.
+     *  @param cylinder the cylinder to intersect with
+     *  @param s return argument, the path length at the intersection. Set to 0 if not found
+     */
+    IntersectionStatus intersectWithCylinder( const LCCylinder &cylinder, double &s ) const ;
+
+    /** The helix coefficients used by the intersection computations
+     */
+    HelixCoefficients getCoefficients() const ;
+
     /** Pathlength at the start and end point of the trajectory. 
      */
     virtual double getStart() const ;
@@ -80,7 +114,10 @@ namespace marlinreco_mt {
 
   protected:
 
-    SimpleHelix() {} 
+    SimpleHelix() { computeCachedParameters() ; }
+
+    /// Compute the cached helix quantities. To call again if the helix parameters are modified
+    void computeCachedParameters() ;
 
     virtual double getCentreX() const ;
     virtual double getCentreY() const ;
@@ -100,6 +137,22 @@ namespace marlinreco_mt {
 
     LCVector3D  _reference {};
     LCErrorMatrix<5> _errors {};
+    double _bField=0.0;
+
+    // cached quantities, see computeCachedParameters()
+    double _xCentre=0.0;
+    double _yCentre=0.0;
+    double _zOffset=0.0;
+    /// The absolute radius
+    double _absRadius=1.0;
+    /// The phase of the position on the circle at s=0
+    double _varphi0=0.0;
+    double _sinVarphi0=0.0;
+    double _cosVarphi0=1.0;
+    /// The phase advance per unit path length
+    double _w=1.0;
+    double _sinLambda=0.0;
+    double _cosLambda=1.0;
 
   }; // class 
 
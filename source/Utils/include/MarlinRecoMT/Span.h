@@ -0,0 +1,68 @@
+#ifndef MARLINRECOMT_SPAN_h
+#define MARLINRECOMT_SPAN_h 1
+
+// -- std headers
+#include <cstddef>
+#include <utility>
+
+namespace marlinreco_mt {
+
+  /** Non-owning view on a contiguous sequence of T (a minimal std::span, not
+   *  available in C++17). The viewed memory must outlive the span.
+   *  Example usage: <br>
+   *  <pre>
+   *     std::vector<double> radii = ... ;
+   *     Span<const double> view( radii ) ;
+   *     for( double r : view ) { ... }
+   *  </pre>
+   */
+  template <typename T>
+  class Span {
+  public:
+    using element_type = T ;
+    using iterator = T* ;
+
+  public:
+    constexpr Span() = default ;
+
+    /** Constructor from a pointer and a number of elements
+     */
+    constexpr Span( T *data, std::size_t size ) :
+      _data( data ),
+      _size( size ) {
+      /* nop */
+    }
+
+    /** Constructor from a vector (const or not, matching T)
+     */
+    template <typename V, typename = decltype( static_cast<T*>( std::declval<V&>().data() ) )>
+    constexpr Span( V &vec ) :
+      _data( vec.data() ),
+      _size( vec.size() ) {
+      /* nop */
+    }
+
+    /** The pointer to the first element */
+    constexpr T *data() const { return _data ; }
+
+    /** The number of elements */
+    constexpr std::size_t size() const { return _size ; }
+
+    /** Whether the span is empty */
+    constexpr bool empty() const { return 0 == _size ; }
+
+    /** Element access, not range checked */
+    constexpr T &operator[]( std::size_t i ) const { return _data[i] ; }
+
+    /** Iterators */
+    constexpr iterator begin() const { return _data ; }
+    constexpr iterator end() const { return _data + _size ; }
+
+  private:
+    T                 *_data {nullptr} ;
+    std::size_t        _size {0} ;
+  };
+
+}
+
+#endif
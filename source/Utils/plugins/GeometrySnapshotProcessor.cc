@@ -0,0 +1,79 @@
+// -- marlin headers
+#include <marlin/Processor.h>
+#include <marlin/ProcessorApi.h>
+#include <marlin/PluginManager.h>
+#include <marlin/Logging.h>
+using namespace marlin::loglevel ;
+
+// -- marlin reco mt headers
+#include <MarlinRecoMT/GeometrySnapshot.h>
+
+// -- std headers
+#include <string>
+
+namespace marlinreco_mt {
+
+  /** Processor holding the process wide settings of the geometry snapshot (see GeometrySnapshot).
+   *  It configures the geometry cache file and creates the snapshot in init(), so it must run
+   *  before all the processors using the snapshot. Without it, the snapshot is extracted from
+   *  the DD4hep geometry.
+   *
+   *  @parameter GeometryCacheFile the geometry cache file, read instead of the DD4hep geometry if valid, else written
+   *  @parameter GeometryCompactFile the DD4hep compact file the geometry cache file is validated against
+   */
+  class GeometrySnapshotProcessor : public marlin::Processor {
+   public:
+    /** Constructor
+     */
+    GeometrySnapshotProcessor() ;
+
+    /** Configure and create the geometry snapshot
+     */
+    void init() ;
+
+    /** Nothing to do per event
+     */
+    void processEvent( EVENT::LCEvent * evt ) ;
+
+  protected:
+    marlin::Property<std::string> _geometryCacheFile {this, "GeometryCacheFile" ,
+             "Geometry cache file, read instead of the DD4hep geometry if valid, else written (empty: not used)", "" } ;
+
+    marlin::Property<std::string> _geometryCompactFile {this, "GeometryCompactFile" ,
+             "The DD4hep compact file the geometry cache file is validated against", "" } ;
+  };
+
+  //--------------------------------------------------------------------------
+
+  GeometrySnapshotProcessor::GeometrySnapshotProcessor() :
+    Processor("GeometrySnapshot") {
+    // modify processor description
+    _description = "Set the geometry cache file of the geometry snapshot used by the MarlinRecoMT processors" ;
+    // process wide settings, one instance is enough
+    forceRuntimeOption( Processor::RuntimeOption::Critical, false ) ;
+    forceRuntimeOption( Processor::RuntimeOption::Clone, false ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void GeometrySnapshotProcessor::init() {
+    // usually a good idea to
+    printParameters() ;
+    try {
+      GeometrySnapshot::configure( _geometryCacheFile, _geometryCompactFile ) ;
+      GeometrySnapshot::instance() ;
+    }
+    catch( std::exception& e ) {
+      marlin::ProcessorApi::abort( this, "Couldn't create the geometry snapshot: " + std::string(e.what()) ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void GeometrySnapshotProcessor::processEvent( EVENT::LCEvent * ) {
+    /* nop */
+  }
+
+  // processor declaration
+  MARLIN_DECLARE_PROCESSOR( GeometrySnapshotProcessor )
+}
@@ -1,5 +1,5 @@
 // -- lcio headers
-#include <IMPL/LCCollectionVec.h>
+#include <EVENT/LCParameters.h>
 // #include <LCRTRelations.h>
 
 // -- marlin headers
@@ -8,11 +8,21 @@
 #include <marlin/ProcessorApi.h>
 #include <marlin/PluginManager.h>
 
+// -- marlinreco headers
+#include <MarlinRecoMT/ConcatenatedCollection.h>
+
+// -- std headers
+#include <vector>
+
 namespace marlinreco_mt {
 
   /** Helper processor that merges several input collections into a transient subset collections.
+   *  The output collection is a read-only view on the input collections (see ConcatenatedCollection):
+   *  the element pointers are not copied. The output collection is not an IMPL::LCCollectionVec:
+   *  consumers doing a dynamic_cast<IMPL::LCCollectionVec*> on it get a nullptr.
    *  The names and optionally the IDs of the merged collections
    *  are stored in collection parameters MergedCollectionNames and MergedCollectionIDs.
+   *  The collection parameters are only merged when a consumer reads them.
    *
    * @param InputCollections    Name of the input collections
    * @param InputCollectionIDs  Optional IDs for input collections - if given, IDs will be added to all objects in merged collections as ext<CollID>()"
@@ -43,6 +53,10 @@ namespace marlinreco_mt {
     ///< Helper function to get collection safely
     EVENT::LCCollection* getCollection( EVENT::LCEvent* evt, const std::string name ) const ;
 
+    ///< Build the output collection parameters from the input collections. indices are the
+    ///< positions in the InputCollections parameter of the collections in the view
+    void mergeParameters( const ConcatenatedCollection &view, const std::vector<std::size_t> &indices, EVENT::LCParameters &parameters ) const ;
+
   protected:
     marlin::Property<std::vector<std::string>> _inColNames {this, "InputCollections" ,
               "Names of all input collections" } ;
@@ -75,15 +89,8 @@ namespace marlinreco_mt {
   //--------------------------------------------------------------------------
 
   void MergeCollections::processEvent( EVENT::LCEvent * evt ) {
-    std::vector<std::string> colNamesPresent;
-    std::vector<int> colIDsPresent;
-    std::vector<int> colNElements;
-    std::vector<int> colNIntParam;
-    std::vector<int> colNFloatParam;
-    std::vector<int> colNStringParam;
-
-    std::size_t nCol = _inColNames.get().size() ;
-    std::size_t nColID = _inColIDs.get().size() ;
+    const std::size_t nCol = _inColNames.get().size() ;
+    const std::size_t nColID = _inColIDs.get().size() ;
 
     if( marlin::ProcessorApi::isFirstEvent( evt ) && nColID != nCol ) {
       log<marlin::WARNING>() << " MergeCollections::processEvent : incompatible parameter vector sizes : InputCollections: " << nCol
@@ -91,104 +98,106 @@ namespace marlinreco_mt {
       log<marlin::WARNING>() << " MergeCollections::processEvent : standard numbering (0,1,2,...) used." << std::endl;
     }
 
-    //--- copy existing collections to a vector first
-    std::vector<EVENT::LCCollection*> colVec( nCol ) ;
-
-    for( std::size_t i=0 ; i<nCol ; ++i ) {
-      EVENT::LCCollection *col = getCollection( evt , _inColNames.get()[i] ) ;
-      if( col != 0 ) {
-        colVec[i] = col  ;
-        colNamesPresent.push_back(_inColNames.get()[i]);
-        if( nColID == nCol ) {
-          colIDsPresent.push_back(_inColIDs.get()[i]);
-        }
-        else {
-          colIDsPresent.push_back(i) ;
-        }
-      }
-      else {
-        log<marlin::DEBUG2>() << " input collection missing : " << _inColNames.get()[i] << std::endl ;
-      }
-    }
-
-    //--- now loop over collections
-    IMPL::LCCollectionVec* outCol = 0 ;
-    bool first = true ;
+    // the output is a view on the input collections: no element copy.
+    // The collection parameters are merged only if a consumer reads them
+    std::vector<EVENT::LCCollection*> cols ;
+    std::vector<std::size_t> indices ;
+    cols.reserve( nCol ) ;
+    indices.reserve( nCol ) ;
 
     for( std::size_t k=0 ; k<nCol ; ++k ) {
-      EVENT::LCCollection* col = colVec[k] ;
+      EVENT::LCCollection *col = getCollection( evt , _inColNames.get()[k] ) ;
       if( ! col ) {
+        log<marlin::DEBUG2>() << " input collection missing : " << _inColNames.get()[k] << std::endl ;
         continue ;
       }
-      if( first ){
-        // copy collection flags from first collections
-        outCol = new IMPL::LCCollectionVec( col->getTypeName() )  ;
-        outCol->setFlag( col->getFlag() ) ;
-        first = false ;
-      }
-      int nEle = col->getNumberOfElements() ;
-      for( int j=0 ; j<nEle ; ++j ) {
-        EVENT::LCObject* elem = col->getElementAt(j) ;
-        outCol->addElement(  elem ) ;
-      }
+      cols.push_back( col ) ;
+      indices.push_back( k ) ;
+    }
+    if( cols.empty() ) {
+      return ;
+    }
+    // the parameter indices are kept by the view builder: an input name can be listed twice
+    auto outCol = new ConcatenatedCollection( [this, indices]( const ConcatenatedCollection &view, EVENT::LCParameters &parameters ){
+      mergeParameters( view, indices, parameters ) ;
+    }) ;
+    for( std::size_t c=0 ; c<cols.size() ; ++c ) {
+      outCol->addCollection( _inColNames.get()[ indices[c] ], cols[c] ) ;
+    }
+    outCol->setTransient( false ) ;
+    evt->addCollection( outCol, _outColName ) ;
+  }
+
+  //--------------------------------------------------------------------------
 
-      int intParams = 0;
-      int floatParams = 0;
-      int stringParams = 0;
+  void MergeCollections::mergeParameters( const ConcatenatedCollection &view, const std::vector<std::size_t> &indices, EVENT::LCParameters &parameters ) const {
+    const auto &inColNames = _inColNames.get() ;
+    const auto &inColIDs = _inColIDs.get() ;
+    const std::size_t nCol = view.numberOfCollections() ;
+    std::vector<std::string> colNamesPresent ;
+    std::vector<int> colIDsPresent ;
+    std::vector<int> colNElements ;
+    std::vector<int> colNIntParam ;
+    std::vector<int> colNFloatParam ;
+    std::vector<int> colNStringParam ;
+    colNamesPresent.reserve( nCol ) ;
+    colIDsPresent.reserve( nCol ) ;
+    colNElements.reserve( nCol ) ;
+    colNIntParam.reserve( nCol ) ;
+    colNFloatParam.reserve( nCol ) ;
+    colNStringParam.reserve( nCol ) ;
+
+    for( std::size_t c=0 ; c<nCol ; ++c ) {
+      const EVENT::LCCollection *col = view.collection( c ) ;
+      const std::string &colName = view.collectionName( c ) ;
+      // index of the collection in the processor parameter list
+      const std::size_t k = indices[c] ;
+      const bool copyParameters = ( unsigned(_collectionParameterIndex) == k ) ;
+      colNamesPresent.push_back( colName ) ;
+      colIDsPresent.push_back( inColIDs.size() == inColNames.size() ? inColIDs[k] : int(k) ) ;
 
       std::vector<std::string> intKeys ;
-      int nIntParameters = col->getParameters().getIntKeys( intKeys ).size() ;
-      for(int i=0; i< nIntParameters ; i++ ){
+      const int nIntParameters = col->getParameters().getIntKeys( intKeys ).size() ;
+      for( int i=0 ; i<nIntParameters ; i++ ) {
         std::vector<int> intVec ;
-        col->getParameters().getIntVals(  intKeys[i], intVec ) ;
-        const std::string newIntKey = _inColNames.get()[k]+"_"+intKeys[i];
-        outCol->parameters().setValues(newIntKey,intVec);
-        intParams++;
-        if( unsigned(_collectionParameterIndex) == k )
-  	      outCol->parameters().setValues(intKeys[i],intVec);
+        col->getParameters().getIntVals( intKeys[i], intVec ) ;
+        parameters.setValues( colName + "_" + intKeys[i], intVec ) ;
+        if( copyParameters )
+          parameters.setValues( intKeys[i], intVec ) ;
       }
 
       std::vector<std::string> floatKeys ;
-      int nFloatParameters = col->getParameters().getFloatKeys( floatKeys ).size() ;
-      for(int i=0; i< nFloatParameters ; i++ ){
+      const int nFloatParameters = col->getParameters().getFloatKeys( floatKeys ).size() ;
+      for( int i=0 ; i<nFloatParameters ; i++ ) {
         std::vector<float> floatVec ;
-        col->getParameters().getFloatVals(  floatKeys[i], floatVec ) ;
-        const std::string newFloatKey = _inColNames.get()[k]+"_"+floatKeys[i];
-        outCol->parameters().setValues(newFloatKey,floatVec);
-        floatParams++;
-        if( unsigned(_collectionParameterIndex) == k )
-  	      outCol->parameters().setValues(floatKeys[i],floatVec);
+        col->getParameters().getFloatVals( floatKeys[i], floatVec ) ;
+        parameters.setValues( colName + "_" + floatKeys[i], floatVec ) ;
+        if( copyParameters )
+          parameters.setValues( floatKeys[i], floatVec ) ;
       }
 
       std::vector<std::string> stringKeys ;
-      int nStringParameters = col->getParameters().getStringKeys( stringKeys ).size() ;
-      for(int i=0; i< nStringParameters ; i++ ){
+      const int nStringParameters = col->getParameters().getStringKeys( stringKeys ).size() ;
+      for( int i=0 ; i<nStringParameters ; i++ ) {
         std::vector<std::string> stringVec ;
-        col->getParameters().getStringVals(  stringKeys[i], stringVec ) ;
-        const std::string newStringKey = _inColNames.get()[k]+"_"+stringKeys[i];
-        outCol->parameters().setValues(newStringKey,stringVec);
-        stringParams++;
-        if( unsigned(_collectionParameterIndex) == k )
-  	      outCol->parameters().setValues(stringKeys[i],stringVec);
+        col->getParameters().getStringVals( stringKeys[i], stringVec ) ;
+        parameters.setValues( colName + "_" + stringKeys[i], stringVec ) ;
+        if( copyParameters )
+          parameters.setValues( stringKeys[i], stringVec ) ;
       }
-      colNElements.push_back(nEle);
-      colNIntParam.push_back(intParams);
-      colNFloatParam.push_back(floatParams);
-      colNStringParam.push_back(stringParams);
-    }
-    if( outCol ) {
-      outCol->parameters().setValues("MergedCollection_Names",_inColNames);
-      outCol->parameters().setValues("MergedCollection_IDs",_inColIDs);
-      outCol->parameters().setValues("MergedCollection_NamesPresent",colNamesPresent);
-      outCol->parameters().setValues("MergedCollection_IDsPresent",colIDsPresent);
-      outCol->parameters().setValues("MergedCollection_NElements",colNElements);
-      outCol->parameters().setValues("MergedCollection_NIntParameters",colNIntParam);
-      outCol->parameters().setValues("MergedCollection_NFloatParameters",colNFloatParam);
-      outCol->parameters().setValues("MergedCollection_NStringParameters",colNStringParam);
-      outCol->setTransient( false ) ;
-      outCol->setSubset( true ) ;
-      evt->addCollection( outCol, _outColName   ) ;
+      colNElements.push_back( col->getNumberOfElements() ) ;
+      colNIntParam.push_back( nIntParameters ) ;
+      colNFloatParam.push_back( nFloatParameters ) ;
+      colNStringParam.push_back( nStringParameters ) ;
     }
+    parameters.setValues( "MergedCollection_Names", inColNames ) ;
+    parameters.setValues( "MergedCollection_IDs", inColIDs ) ;
+    parameters.setValues( "MergedCollection_NamesPresent", colNamesPresent ) ;
+    parameters.setValues( "MergedCollection_IDsPresent", colIDsPresent ) ;
+    parameters.setValues( "MergedCollection_NElements", colNElements ) ;
+    parameters.setValues( "MergedCollection_NIntParameters", colNIntParam ) ;
+    parameters.setValues( "MergedCollection_NFloatParameters", colNFloatParam ) ;
+    parameters.setValues( "MergedCollection_NStringParameters", colNStringParam ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -4,7 +4,6 @@
 #include <EVENT/TrackerHit.h>
 #include <EVENT/SimCalorimeterHit.h>
 #include <EVENT/CalorimeterHit.h>
-#include <UTIL/BitField64.h>
 
 // -- marlin headers
 #include <marlin/Processor.h>
@@ -14,18 +13,23 @@
 using namespace marlin::loglevel ;
 
 // -- std headers
-#include <functional>
 #include <string>
 #include <memory>
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
 
 // -- marlin reco mt headers
-#include <MarlinRecoMT/LCIOHelper.h>
+#include <MarlinRecoMT/CellIDFields.h>
 
 namespace marlinreco_mt {
 
   /** Utility processor that allows to split a collection of Hits into 
    *  several collections based on the layer information in the cellID word.
    *  Works for all four lcio hit classes.
+   *  The processor has no event state: the layer to output collection table
+   *  is built at init and the output collections are local to processEvent,
+   *  so a single instance can process several events concurrently.
    *
    *  @parameter InputCollection name of the hit collection with (Sim)TrackerHits/(Sim)CalorimeterHits
    *  @parameter OutputCollections ( ColName  StartLayer EndLayer )    
@@ -42,8 +46,8 @@ namespace marlinreco_mt {
       std::string                                 _name {} ;
       unsigned                                    _layerStart {0} ;
       unsigned                                    _layerEnd {0} ;
-      std::unique_ptr<IMPL::LCCollectionVec>      _collection {nullptr} ;
     };
+    using OutputCollections = std::vector<std::unique_ptr<IMPL::LCCollectionVec>> ;
 
    public:
     /** Constructor
@@ -58,6 +62,13 @@ namespace marlinreco_mt {
     /** Called for every event - the working horse.
      */
     void processEvent( EVENT::LCEvent * evt ) ;
+    
+  private:
+    /** Dispatch the hits of the collection in the output collections, 
+     *  using the cellID of the concrete hit type T
+     */
+    template <typename T>
+    void splitHits( const EVENT::LCCollection *collection, const CellIDField &layerField, OutputCollections &outputs ) const ;
 
   protected:
     marlin::Property<std::string> _inputCollectionName {this, "InputCollection" , 
@@ -66,7 +77,10 @@ namespace marlinreco_mt {
     marlin::Property<std::vector<std::string>> _collectionsAndLayers {this, "OutputCollections" , 
              "Name of the output collection with start and end layer number" , { "FTD_PIXELCollection", "0", "1", "FTD_STRIPCollection", "2", "6" } } ;
     
+    /// The output collection settings
     std::vector<OutputCollectionInfo>         _outputCollections {} ;
+    /// The output collection indices per layer (dense table, up to the highest end layer)
+    std::vector<std::vector<unsigned int>>    _layerOutputs {} ;
   };
 
   //--------------------------------------------------------------------------
@@ -75,6 +89,8 @@ namespace marlinreco_mt {
     Processor("SplitCollectionByLayer") {
     // modify processor description
     _description = "split a hit collection based on the layer number of the hits " ;
+    // no event state, a single instance can run concurrently
+    forceRuntimeOption( Processor::RuntimeOption::Critical, false ) ;
   }
 
   //--------------------------------------------------------------------------
@@ -87,14 +103,25 @@ namespace marlinreco_mt {
     if( 0 != _collectionsAndLayers.get().size() % 3 ) {
       marlin::ProcessorApi::abort( this, "The OutputCollections parameter length should be a multiple of 3 (CollectionName layer0 layer1)." ) ;
     }
-    std::size_t len = _collectionsAndLayers.get().size() % 3 ;
+    std::size_t len = _collectionsAndLayers.get().size() / 3 ;
     _outputCollections.resize( len ) ;
     
     std::size_t index = 0 ;
+    unsigned int maxLayer = 0 ;
     for( std::size_t i=0 ; i<len ; i++ ) {
       _outputCollections[i]._name        = _collectionsAndLayers.get()[ index ] ; index ++ ;
       _outputCollections[i]._layerStart  = std::atoi( _collectionsAndLayers.get()[ index ].c_str() ) ; index ++ ;
       _outputCollections[i]._layerEnd    = std::atoi( _collectionsAndLayers.get()[ index ].c_str() ) ; index ++ ;
+      maxLayer = std::max( maxLayer, _outputCollections[i]._layerEnd ) ;
+    }
+    // layer -> output collections lookup table
+    _layerOutputs.resize( len > 0 ? maxLayer + 1 : 0 ) ;
+    for( unsigned int layer=0 ; layer<_layerOutputs.size() ; layer++ ) {
+      for( std::size_t i=0 ; i<len ; i++ ) {
+        if( ( _outputCollections[i]._layerStart <= layer ) && ( layer <= _outputCollections[i]._layerEnd ) ) {
+          _layerOutputs[layer].push_back( i ) ;
+        }
+      }
     }
   }
 
@@ -109,57 +136,60 @@ namespace marlinreco_mt {
       log<DEBUG5>() <<  " input collection not in event : " << _inputCollectionName << "   - nothing to do    !!! " << std::endl ;  
       return ;
     }
-    // cellID converter function
-    std::function<long long( const EVENT::LCObject* )> cellIDFunction = nullptr ;
+    const auto &typeName = collection->getTypeName() ;
+    if( typeName != lcio::LCIO::SIMTRACKERHIT && typeName != lcio::LCIO::TRACKERHIT 
+     && typeName != lcio::LCIO::SIMCALORIMETERHIT && typeName != lcio::LCIO::CALORIMETERHIT ) {
+      log<WARNING>() <<  " input collection unexpected type : " << typeName << "   - skipping    !!! " << std::endl ;  
+      return ;
+    }
+    std::string encoderString = collection->getParameters().getStringVal( "CellIDEncoding" ) ;
+    const CellIDField layerField = CellIDFields::get( encoderString )->field( "layer" ) ;
     
-    // remember the type of the hit collection
-    if( collection->getTypeName() == lcio::LCIO::SIMTRACKERHIT ) {
-      cellIDFunction = std::bind(&LCIOHelper::cellIDToLong<EVENT::SimTrackerHit>, std::placeholders::_1 ) ;
+    // create output collections
+    OutputCollections outputs ( _outputCollections.size() ) ;
+    for( std::size_t i=0 ; i<outputs.size() ; i++ ) {
+      outputs[i] = std::make_unique<IMPL::LCCollectionVec>( typeName ) ;
+      outputs[i]->setSubset( true ) ;
+      outputs[i]->parameters().setValue( "CellIDEncoding", encoderString ) ;
+      log<DEBUG5>() << " create new output collection " << _outputCollections[i]._name << " of type " <<  typeName << std::endl ;
     }
-    else if( collection->getTypeName() == lcio::LCIO::TRACKERHIT ) {
-      cellIDFunction = std::bind(&LCIOHelper::cellIDToLong<EVENT::TrackerHit>, std::placeholders::_1 ) ;
+    // split the hits, with the concrete hit type
+    if( typeName == lcio::LCIO::SIMTRACKERHIT ) {
+      splitHits<EVENT::SimTrackerHit>( collection, layerField, outputs ) ;
     }
-    else if( collection->getTypeName() == lcio::LCIO::SIMCALORIMETERHIT ) {
-      cellIDFunction = std::bind(&LCIOHelper::cellIDToLong<EVENT::SimCalorimeterHit>, std::placeholders::_1 ) ;
+    else if( typeName == lcio::LCIO::TRACKERHIT ) {
+      splitHits<EVENT::TrackerHit>( collection, layerField, outputs ) ;
     }
-    else if( collection->getTypeName() == lcio::LCIO::CALORIMETERHIT ) {
-      cellIDFunction = std::bind(&LCIOHelper::cellIDToLong<EVENT::CalorimeterHit>, std::placeholders::_1 ) ;
+    else if( typeName == lcio::LCIO::SIMCALORIMETERHIT ) {
+      splitHits<EVENT::SimCalorimeterHit>( collection, layerField, outputs ) ;
     }
     else {
-      log<WARNING>() <<  " input collection unexpected type : " << collection->getTypeName() << "   - skipping    !!! " << std::endl ;  
-      return ;
+      splitHits<EVENT::CalorimeterHit>( collection, layerField, outputs ) ;
     }
-    std::string encoderString = collection->getParameters().getStringVal( "CellIDEncoding" ) ;
-    UTIL::BitField64 encoder( encoderString ) ;
-    unsigned layerIndex = encoder.index("layer") ;
-    
-    // create output collections
-    for( auto &outcol : _outputCollections ) {
-      outcol._collection = std::make_unique<IMPL::LCCollectionVec>( collection->getTypeName() ) ;
-      outcol._collection->setSubset( true ) ;
-      outcol._collection->parameters().setValue( "CellIDEncoding", encoderString ) ;
-      log<DEBUG5>() << " create new output collection " << outcol._name << " of type " <<  collection->getTypeName() << std::endl ;
+    // add non empty collections to the event
+    for( std::size_t i=0 ; i<outputs.size() ; i++ ) {
+      if( outputs[i]->getNumberOfElements() > 0 ) {
+        evt->addCollection( outputs[i].release(), _outputCollections[i]._name ) ;
+        log<DEBUG5>() << " output collection " << _outputCollections[i]._name << " of type " <<  typeName << " added to the event  " << std::endl ;
+      }
     }
-    // loop over hits
+  }
+  
+  //--------------------------------------------------------------------------
+  
+  template <typename T>
+  void SplitCollectionByLayerProcessor::splitHits( const EVENT::LCCollection *collection, const CellIDField &layerField, OutputCollections &outputs ) const {
     int nHit = collection->getNumberOfElements()  ;
     for( int iHit=0; iHit< nHit ; iHit++ ) {
-      auto h = collection->getElementAt( iHit ) ;
-      auto id = cellIDFunction( h ) ;
-      encoder.setValue( id ) ;
-      unsigned int layerID = encoder[ layerIndex ] ;
+      auto h = static_cast<T*>( collection->getElementAt( iHit ) ) ;
+      const auto layerID = layerField( h ) ;
       // check if we have an output collection for this layer
-      for( auto &outcol : _outputCollections ) {
-        if( ( outcol._layerStart <= layerID )  && ( layerID <= outcol._layerEnd ) ) {
-          outcol._collection->addElement( h ) ;
-          log<DEBUG0>() << " adding hit for layer " << layerID << " to collection : " << outcol._name << std::endl ;
-        }    
+      if( layerID < 0 || layerID >= static_cast<long long>( _layerOutputs.size() ) ) {
+        continue ;
       }
-    }
-    // add non empty collections to the event
-    for( auto &outcol : _outputCollections ) {
-      if( outcol._collection->getNumberOfElements() > 0 ) {
-        evt->addCollection( outcol._collection.release(), outcol._name ) ;
-        log<DEBUG5>() << " output collection " << outcol._name << " of type " <<  collection->getTypeName() << " added to the event  " << std::endl ;
+      for( auto index : _layerOutputs[ layerID ] ) {
+        outputs[ index ]->addElement( h ) ;
+        log<DEBUG0>() << " adding hit for layer " << layerID << " to collection : " << _outputCollections[ index ]._name << std::endl ;
       }
     }
   }
@@ -0,0 +1,113 @@
+#include <MarlinRecoMT/CellIDFields.h>
+
+// -- lcio headers
+#include <EVENT/LCIO.h>
+#include <EVENT/LCParameters.h>
+#include <Exceptions.h>
+#include <UTIL/LCTrackerConf.h>
+
+// -- std headers
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+#include <unordered_map>
+
+namespace marlinreco_mt {
+
+  std::shared_ptr<const CellIDFields> CellIDFields::get( const std::string &encodingString ) {
+    // same default as LCIO's CellIDDecoder for collections without encoding
+    const std::string &encoding = encodingString.empty() ? UTIL::LCTrackerCellID::encoding_string() : encodingString ;
+    static std::mutex cacheMutex ;
+    static std::unordered_map<std::string, std::shared_ptr<const CellIDFields>> cache ;
+    std::lock_guard<std::mutex> lock( cacheMutex ) ;
+    auto iter = cache.find( encoding ) ;
+    if( cache.end() != iter ) {
+      return iter->second ;
+    }
+    std::shared_ptr<const CellIDFields> fields( new CellIDFields( encoding ) ) ;
+    cache.insert( { encoding, fields } ) ;
+    return fields ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<const CellIDFields> CellIDFields::get( const EVENT::LCCollection *collection ) {
+    return CellIDFields::get( collection->getParameters().getStringVal( EVENT::LCIO::CellIDEncoding ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &CellIDFields::encoding() const {
+    return _encoding ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool CellIDFields::hasField( const std::string &name ) const {
+    return ( _names.end() != std::find( _names.begin(), _names.end(), name ) ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const CellIDField &CellIDFields::field( const std::string &name ) const {
+    auto iter = std::find( _names.begin(), _names.end(), name ) ;
+    if( _names.end() == iter ) {
+      throw EVENT::Exception( "CellIDFields::field: unknown field '" + name + "' in encoding '" + _encoding + "'" ) ;
+    }
+    return _fields[ std::distance( _names.begin(), iter ) ] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::string CellIDFields::valueString( std::uint64_t cellID ) const {
+    std::ostringstream values ;
+    for( std::size_t i=0 ; i<_fields.size() ; ++i ) {
+      values << ( i ? "," : "" ) << _names[i] << ":" << _fields[i]( cellID ) ;
+    }
+    return values.str() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  CellIDFields::CellIDFields( const std::string &encoding ) :
+    _encoding( encoding ) {
+    // same syntax as UTIL::BitField64: "name:width" or "name:offset:width",
+    // comma separated, negative width for signed fields
+    std::istringstream encodingStream( encoding ) ;
+    std::string fieldDescription ;
+    unsigned int currentOffset(0) ;
+    std::uint64_t usedBits(0) ;
+    while( std::getline( encodingStream, fieldDescription, ',' ) ) {
+      fieldDescription.erase( std::remove_if( fieldDescription.begin(), fieldDescription.end(), ::isspace ), fieldDescription.end() ) ;
+      if( fieldDescription.empty() ) {
+        continue ;
+      }
+      std::vector<std::string> tokens ;
+      std::istringstream fieldStream( fieldDescription ) ;
+      std::string token ;
+      while( std::getline( fieldStream, token, ':' ) ) {
+        tokens.push_back( token ) ;
+      }
+      if( tokens.size() < 2 || tokens.size() > 3 ) {
+        throw EVENT::Exception( "CellIDFields: invalid field description '" + fieldDescription + "' in encoding '" + encoding + "'" ) ;
+      }
+      const int signedWidth = std::atoi( tokens.back().c_str() ) ;
+      const unsigned int offset = ( 3 == tokens.size() ) ? std::atoi( tokens[1].c_str() ) : currentOffset ;
+      const unsigned int width = std::abs( signedWidth ) ;
+      if( 0 == width || offset + width > 64 ) {
+        throw EVENT::Exception( "CellIDFields: invalid field width/offset for '" + tokens[0] + "' in encoding '" + encoding + "'" ) ;
+      }
+      const std::uint64_t fieldBits = ( width >= 64 ? ~std::uint64_t(0) : ( ( std::uint64_t(1) << width ) - 1 ) ) << offset ;
+      if( 0 != ( usedBits & fieldBits ) || hasField( tokens[0] ) ) {
+        throw EVENT::Exception( "CellIDFields: overlapping or duplicated field '" + tokens[0] + "' in encoding '" + encoding + "'" ) ;
+      }
+      usedBits |= fieldBits ;
+      _names.push_back( tokens[0] ) ;
+      _fields.push_back( CellIDField( offset, width, signedWidth < 0 ) ) ;
+      currentOffset = offset + width ;
+    }
+  }
+
+}
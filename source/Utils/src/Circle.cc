@@ -4,94 +4,139 @@
 #include <marlin/Exceptions.h>
 
 // -- std headers
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <string>
 
 namespace marlinreco_mt {
 
-  Circle::Circle( const dd4hep::rec::Vector2D &pt1, const dd4hep::rec::Vector2D &pt2, const dd4hep::rec::Vector2D &pt3 ) {  	
-  	if (!this->isPerpendicular(pt1, pt2, pt3) ) {
-      this->calculateCircleProperties(pt1, pt2, pt3) ;
-  	}
-    else if (!this->isPerpendicular(pt1, pt3, pt2) ) {
-      this->calculateCircleProperties(pt1, pt3, pt2) ;
-  	}
-    else if (!this->isPerpendicular(pt2, pt1, pt3) ) {
-      this->calculateCircleProperties(pt2, pt1, pt3) ;	
-  	}
-  	else if (!this->isPerpendicular(pt3, pt2, pt1) ) {
-      this->calculateCircleProperties(pt3, pt2, pt1) ;	
+  namespace {
+
+    /// The circumcircle terms of three points, relative to the first one
+    struct CircleTerms {
+      double     u {0.} ;
+      double     v {0.} ;
+      double     cross {0.} ;
+      double     limit {0.} ;
+    };
+
+    /// Branch free circumcircle arithmetic, shared by Circle and Circle::fromTriplets().
+    /// The division is unconditional: the terms of colinear or coincident points are
+    /// meaningless and must be discarded by the caller using isDegenerate()
+    inline CircleTerms circleTerms( double x1, double y1, double x2, double y2, double x3, double y3 ) {
+      const double xDelta_a = x2 - x1 ;
+      const double yDelta_a = y2 - y1 ;
+      const double xDelta_b = x3 - x1 ;
+      const double yDelta_b = y3 - y1 ;
+      const double a2 = xDelta_a*xDelta_a + yDelta_a*yDelta_a ;
+      const double b2 = xDelta_b*xDelta_b + yDelta_b*yDelta_b ;
+      CircleTerms terms ;
+      terms.cross = xDelta_a*yDelta_b - yDelta_a*xDelta_b ;
+      terms.limit = Circle::TOLERANCE*Circle::TOLERANCE*a2*b2 ;
+      const double halfInvCross = 0.5 / terms.cross ;
+      terms.u = (yDelta_b*a2 - yDelta_a*b2) * halfInvCross ;
+      terms.v = (xDelta_a*b2 - xDelta_b*a2) * halfInvCross ;
+      return terms ;
+    }
+
+    /// Colinear or coincident points: the sine of the angle between the chords vanishes
+    inline bool isDegenerate( double cross, double limit ) {
+      return ( cross*cross <= limit ) ;
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  void TripletCircles::resize( std::size_t n ) {
+    radius.resize( n ) ;
+    xCenter.resize( n ) ;
+    yCenter.resize( n ) ;
+    curvatureSign.resize( n ) ;
+    degenerate.resize( n ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  Circle::Circle( const dd4hep::rec::Vector2D &pt1, const dd4hep::rec::Vector2D &pt2, const dd4hep::rec::Vector2D &pt3 ) {
+    const CircleTerms terms = circleTerms( pt1.u(), pt1.v(), pt2.u(), pt2.v(), pt3.u(), pt3.v() ) ;
+    if( isDegenerate( terms.cross, terms.limit ) ) {
+      throw marlin::Exception( "Circle::Circle: Couldn't construct circle from input 2D vectors, the points are colinear" ) ;
     }
-    else if (!this->isPerpendicular(pt2, pt3, pt1) ) {
-      this->calculateCircleProperties(pt2, pt3, pt1) ;	
-  	}
-    else if (!this->isPerpendicular(pt3, pt1, pt2) ) {
-      this->calculateCircleProperties(pt3, pt1, pt2) ;	
-  	}
-    else { 
-      throw marlin::Exception( "Circle::Circle: Couldn't construct circle from input 2D vectors" ) ;
-  	}
+    _center = dd4hep::rec::Vector2D( pt1.u() + terms.u, pt1.v() + terms.v ) ;
+    _radius = std::sqrt( terms.u*terms.u + terms.v*terms.v ) ;
   }
-  
+
   //--------------------------------------------------------------------------
-  
+
   double Circle::radius() const {
     return _radius ;
   }
-  
+
   //--------------------------------------------------------------------------
-  
+
   const dd4hep::rec::Vector2D &Circle::center() const {
     return _center ;
   }
-  
-  //--------------------------------------------------------------------------
 
-  bool Circle::isPerpendicular( const dd4hep::rec::Vector2D &pt1, const dd4hep::rec::Vector2D &pt2, const dd4hep::rec::Vector2D &pt3 ) const {
-  	double yDelta_a = pt2.v() - pt1.v();
-  	double xDelta_a = pt2.u() - pt1.u();
-  	double yDelta_b = pt3.v() - pt2.v();
-  	double xDelta_b = pt3.u() - pt2.u();
-  	if ( fabs(xDelta_a) <= TOLERANCE && fabs(yDelta_b) <= TOLERANCE ) {
-  	  return false;
-  	}
-  	if ( fabs(yDelta_a) <= TOLERANCE ) {
-  		return true;
-  	}
-  	else if ( fabs(yDelta_b) <= TOLERANCE ) {
-  		return true;
-  	}
-  	else if ( fabs(xDelta_a) <= TOLERANCE ) {
-  		return true;
-  	}
-  	else if ( fabs(xDelta_b) <= TOLERANCE ) {
-  		return true;
-  	}
-  	return false ;
-  }
-  
   //--------------------------------------------------------------------------
 
-  void Circle::calculateCircleProperties( const dd4hep::rec::Vector2D &pt1, const dd4hep::rec::Vector2D &pt2, const dd4hep::rec::Vector2D &pt3 ) {
-    double yDelta_a = pt2.v() - pt1.v() ;
-    double xDelta_a = pt2.u() - pt1.u() ;
-    double yDelta_b = pt3.v() - pt2.v() ;
-    double xDelta_b = pt3.u() - pt2.u() ;
-    if ( fabs(xDelta_a) <= TOLERANCE && fabs(yDelta_b) <= TOLERANCE ) {
-      _center = dd4hep::rec::Vector2D( 0.5*(pt2.u() + pt3.u()), 0.5*(pt1.v() + pt2.v()) ) ;
-      _radius = std::sqrt( (pt1.u()-_center.u())*(pt1.u()-_center.u()) + (pt1.v()-_center.v())*(pt1.v()-_center.v()));
-      return ;
+  void Circle::fromTriplets( Span<const double> x, Span<const double> y, Span<const CircleTriplet> triplets, TripletCircles &circles ) {
+    if( x.size() != y.size() ) {
+      throw std::invalid_argument( "Circle::fromTriplets: got " + std::to_string( x.size() ) + " x and " + std::to_string( y.size() ) + " y coordinates" ) ;
+    }
+    const std::size_t nTriplets = triplets.size() ;
+    circles.resize( nTriplets ) ;
+    double *radius = circles.radius.data() ;
+    double *xCenter = circles.xCenter.data() ;
+    double *yCenter = circles.yCenter.data() ;
+    std::int8_t *curvatureSign = circles.curvatureSign.data() ;
+    std::uint8_t *degenerate = circles.degenerate.data() ;
+    // gather the coordinates of a block of triplets in local arrays first, so that
+    // the circle arithmetic runs on contiguous data. The arithmetic loop is kept free
+    // of selects and of sqrt() so that it vectorises with the default floating point
+    // flags (math errno and trapping math): degenerate triplets are sorted out and the
+    // radii are taken in a second, cheap pass over the block
+    constexpr std::size_t blockSize = 64 ;
+    std::array<double, blockSize> x1, y1, x2, y2, x3, y3 ;
+    std::array<double, blockSize> cross, limit, radius2 ;
+    for( std::size_t first=0 ; first<nTriplets ; first+=blockSize ) {
+      const std::size_t nBlock = std::min( blockSize, nTriplets - first ) ;
+      for( std::size_t j=0 ; j<nBlock ; ++j ) {
+        const CircleTriplet &triplet = triplets[first+j] ;
+        x1[j] = x[triplet.first] ;
+        y1[j] = y[triplet.first] ;
+        x2[j] = x[triplet.second] ;
+        y2[j] = y[triplet.second] ;
+        x3[j] = x[triplet.third] ;
+        y3[j] = y[triplet.third] ;
+      }
+      for( std::size_t j=0 ; j<nBlock ; ++j ) {
+        const CircleTerms terms = circleTerms( x1[j], y1[j], x2[j], y2[j], x3[j], y3[j] ) ;
+        cross[j] = terms.cross ;
+        limit[j] = terms.limit ;
+        radius2[j] = terms.u*terms.u + terms.v*terms.v ;
+        xCenter[first+j] = x1[j] + terms.u ;
+        yCenter[first+j] = y1[j] + terms.v ;
+      }
+      for( std::size_t j=0 ; j<nBlock ; ++j ) {
+        if( isDegenerate( cross[j], limit[j] ) ) {
+          radius[first+j] = std::numeric_limits<double>::infinity() ;
+          xCenter[first+j] = 0. ;
+          yCenter[first+j] = 0. ;
+          curvatureSign[first+j] = 0 ;
+          degenerate[first+j] = 1 ;
+        }
+        else {
+          radius[first+j] = std::sqrt( radius2[j] ) ;
+          curvatureSign[first+j] = ( cross[j] > 0. ) ? 1 : -1 ;
+          degenerate[first+j] = 0 ;
+        }
+      }
     }
-    // isPerpendicular() assure that xDelta(s) are not zero
-    double aSlope = yDelta_a / xDelta_a ; 
-    double bSlope = yDelta_b / xDelta_b ;
-    // checking whether the given points are colinear. 	
-    if ( fabs(aSlope-bSlope) <= TOLERANCE ) {
-      throw marlin::Exception( "Circle::calculateCircleProperties: Couldn't calculate properties, the three input 2D points are colinear" ) ;
-  	}
-    const double x = (aSlope*bSlope*(pt1.v() - pt3.v()) + bSlope*(pt1.u() + pt2.u()) - aSlope*(pt2.u()+pt3.u()) )/(2* (bSlope-aSlope) ) ;
-    const double y = -1*(x - (pt1.u()+pt2.u())/2)/aSlope +  (pt1.v()+pt2.v())/2  ;
-    _center =  dd4hep::rec::Vector2D( x, y ) ;
-    _radius = std::sqrt((pt1.u()-_center.u())*(pt1.u()-_center.u()) + (pt1.v()-_center.v())*(pt1.v()-_center.v()));
   }
-    
+
 }
@@ -0,0 +1,157 @@
+#include <MarlinRecoMT/ConcatenatedCollection.h>
+
+// -- lcio headers
+#include <Exceptions.h>
+
+// -- std headers
+#include <algorithm>
+#include <utility>
+
+namespace marlinreco_mt {
+
+  ConcatenatedCollection::ConcatenatedCollection( ParameterBuilder builder ) :
+    _parameterBuilder( std::move( builder ) ) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ConcatenatedCollection::addCollection( const std::string &name, const EVENT::LCCollection *collection ) {
+    if( _collections.empty() ) {
+      _typeName = collection->getTypeName() ;
+      setFlag( collection->getFlag() ) ;
+    }
+    else if( collection->getTypeName() != _typeName ) {
+      throw EVENT::Exception( "ConcatenatedCollection::addCollection: collection '" + name + "' of type "
+        + collection->getTypeName() + " can't be merged with collections of type " + _typeName ) ;
+    }
+    const int start = _ends.empty() ? 0 : _ends.back() ;
+    _collections.push_back( collection ) ;
+    _names.push_back( name ) ;
+    _ends.push_back( start + collection->getNumberOfElements() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned int ConcatenatedCollection::numberOfCollections() const {
+    return _collections.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const EVENT::LCCollection *ConcatenatedCollection::collection( unsigned int i ) const {
+    return _collections.at( i ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string &ConcatenatedCollection::collectionName( unsigned int i ) const {
+    return _names.at( i ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  int ConcatenatedCollection::getNumberOfElements() const {
+    return _ends.empty() ? 0 : _ends.back() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::string & ConcatenatedCollection::getTypeName() const {
+    return _typeName ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  EVENT::LCObject * ConcatenatedCollection::getElementAt( int index ) const {
+    if( index < 0 || index >= getNumberOfElements() ) {
+      return nullptr ;
+    }
+    // a handful of collections at most, find the owning one
+    const auto segment = std::distance( _ends.begin(), std::upper_bound( _ends.begin(), _ends.end(), index ) ) ;
+    const int start = ( 0 == segment ) ? 0 : _ends[ segment-1 ] ;
+    return _collections[ segment ]->getElementAt( index - start ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  int ConcatenatedCollection::getFlag() const {
+    return _flag ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool ConcatenatedCollection::isTransient() const {
+    return _transient ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool ConcatenatedCollection::isDefault() const {
+    return false ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool ConcatenatedCollection::isSubset() const {
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const EVENT::LCParameters & ConcatenatedCollection::getParameters() const {
+    materializeParameters() ;
+    return _parameters ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  EVENT::LCParameters & ConcatenatedCollection::parameters() {
+    materializeParameters() ;
+    return _parameters ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ConcatenatedCollection::setFlag( int flag ) {
+    // the writers decide from the flag whether to store the element pointers only
+    _flag = flag | ( 1 << EVENT::LCCollection::BITSubset ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ConcatenatedCollection::setTransient( bool val ) {
+    _transient = val ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ConcatenatedCollection::setSubset( bool val ) {
+    if( not val ) {
+      throw EVENT::ReadOnlyException( "ConcatenatedCollection::setSubset: a concatenated collection is always a subset collection" ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ConcatenatedCollection::addElement( EVENT::LCObject * ) {
+    throw EVENT::ReadOnlyException( "ConcatenatedCollection::addElement: read-only collection view" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ConcatenatedCollection::removeElementAt( int ) {
+    throw EVENT::ReadOnlyException( "ConcatenatedCollection::removeElementAt: read-only collection view" ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void ConcatenatedCollection::materializeParameters() const {
+    std::call_once( _parametersFlag, [this](){
+      if( _parameterBuilder ) {
+        _parameterBuilder( *this, _parameters ) ;
+      }
+    }) ;
+  }
+
+}
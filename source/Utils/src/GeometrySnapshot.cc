@@ -0,0 +1,813 @@
+#include <MarlinRecoMT/GeometrySnapshot.h>
+
+// -- dd4hep headers
+#include <DD4hep/Detector.h>
+#include <DD4hep/DetElement.h>
+#include <DDRec/Surface.h>
+#include <DDRec/SurfaceManager.h>
+
+// -- root headers
+#include <TGeoBBox.h>
+#include <TGeoTrd1.h>
+#include <TGeoTrd2.h>
+
+// -- lcio headers
+#include <Exceptions.h>
+
+// -- marlin headers
+#include <marlin/Logging.h>
+using namespace marlin::loglevel ;
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <regex>
+#include <set>
+
+// -- posix headers
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+  /// The cache file header
+  struct CacheHeader {
+    char            _magic[8] ;
+    std::uint32_t   _version ;
+    std::uint32_t   _reserved ;
+    std::uint64_t   _hash ;
+  };
+
+  constexpr const char *CacheMagic = "MRMTGEOM" ;
+
+  /// Sequential writer of the cache file sections
+  class CacheWriter {
+  public:
+    CacheWriter( std::ostream &stream ) : _stream( stream ) {}
+
+    template <typename T>
+    void write( const T &value ) {
+      _stream.write( reinterpret_cast<const char*>( &value ), sizeof(T) ) ;
+    }
+
+    void write( const std::string &value ) {
+      write<std::uint64_t>( value.size() ) ;
+      _stream.write( value.data(), value.size() ) ;
+    }
+
+    void write( const dd4hep::rec::Vector3D &value ) {
+      write( value.x() ) ;
+      write( value.y() ) ;
+      write( value.z() ) ;
+    }
+
+  private:
+    std::ostream        &_stream ;
+  };
+
+  /// Sequential reader of the cache file sections. Any failure leaves the stream in error state
+  class CacheReader {
+  public:
+    CacheReader( std::istream &stream ) : _stream( stream ) {}
+
+    template <typename T>
+    T read() {
+      T value {} ;
+      _stream.read( reinterpret_cast<char*>( &value ), sizeof(T) ) ;
+      return value ;
+    }
+
+    std::string readString() {
+      const auto size = readSize() ;
+      std::string value( size, '\0' ) ;
+      _stream.read( &value[0], size ) ;
+      return value ;
+    }
+
+    dd4hep::rec::Vector3D readVector() {
+      const double x = read<double>() ;
+      const double y = read<double>() ;
+      const double z = read<double>() ;
+      return dd4hep::rec::Vector3D( x, y, z ) ;
+    }
+
+    /// Read a size, set the stream in error state for unreasonable values (corrupted file)
+    std::uint64_t readSize() {
+      const auto size = read<std::uint64_t>() ;
+      if( size > MaxSize ) {
+        _stream.setstate( std::ios::failbit ) ;
+        return 0 ;
+      }
+      return size ;
+    }
+
+    bool good() const {
+      return _stream.good() ;
+    }
+
+  private:
+    static constexpr std::uint64_t MaxSize = 1ul << 28 ;
+    std::istream        &_stream ;
+  };
+
+  /// The process wide snapshot and its cache settings
+  struct SnapshotState {
+    std::mutex                                                     _mutex {} ;
+    std::shared_ptr<const marlinreco_mt::GeometrySnapshot>         _snapshot {nullptr} ;
+    bool                                                           _configured {false} ;
+    std::string                                                    _cacheFile {} ;
+    std::string                                                    _compactFile {} ;
+  };
+
+  SnapshotState &snapshotState() {
+    static SnapshotState state ;
+    return state ;
+  }
+
+  /// Resolve the ref attribute of an include element: environment variables are
+  /// expanded and relative paths are relative to the including file, as in DD4hep
+  std::string resolveInclude( const std::string &ref, const std::string &parentFile ) {
+    std::string path ;
+    std::size_t pos = 0 ;
+    while( pos < ref.size() ) {
+      const auto start = ref.find( "${", pos ) ;
+      const auto end = ( std::string::npos != start ) ? ref.find( '}', start ) : std::string::npos ;
+      if( std::string::npos == end ) {
+        path += ref.substr( pos ) ;
+        break ;
+      }
+      path += ref.substr( pos, start - pos ) ;
+      const char *value = std::getenv( ref.substr( start + 2, end - start - 2 ).c_str() ) ;
+      path += ( nullptr != value ) ? value : "" ;
+      pos = end + 1 ;
+    }
+    const auto slash = parentFile.rfind( '/' ) ;
+    if( path.empty() || '/' == path[0] || std::string::npos == slash ) {
+      return path ;
+    }
+    return parentFile.substr( 0, slash + 1 ) + path ;
+  }
+
+  /// Add a compact file and, recursively, the files it includes to a FNV-1a hash
+  void hashCompactFile( const std::string &fileName, std::uint64_t &hash, std::set<std::string> &visited ) {
+    // canonical path, to stop on include cycles
+    char *realPath = ::realpath( fileName.c_str(), nullptr ) ;
+    if( nullptr == realPath ) {
+      throw EVENT::Exception( "GeometrySnapshot::geometryHash: can't read compact file " + fileName ) ;
+    }
+    const bool visitedAlready = not visited.insert( realPath ).second ;
+    std::free( realPath ) ;
+    if( visitedAlready ) {
+      return ;
+    }
+    std::ifstream file( fileName, std::ios::binary ) ;
+    if( not file ) {
+      throw EVENT::Exception( "GeometrySnapshot::geometryHash: can't read compact file " + fileName ) ;
+    }
+    const std::string content( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() ) ;
+    for( const char c : content ) {
+      hash ^= static_cast<unsigned char>( c ) ;
+      hash *= 1099511628211ull ;
+    }
+    // commented out includes are not part of the geometry
+    static const std::regex commentRegex( "<!--[\\s\\S]*?-->" ) ;
+    static const std::regex includeRegex( "<include\\b[^>]*\\bref\\s*=\\s*\"([^\"]*)\"" ) ;
+    const std::string elements = std::regex_replace( content, commentRegex, "" ) ;
+    for( std::sregex_iterator iter( elements.begin(), elements.end(), includeRegex ), end ; end != iter ; ++iter ) {
+      hashCompactFile( resolveInclude( (*iter)[1].str(), fileName ), hash, visited ) ;
+    }
+  }
+
+
+  /// The section of the volume of a planar surface by the surface plane, as a counter-clockwise
+  /// convex polygon in local (u,v) coordinates. Only for box and trapezoid volumes, else empty
+  std::vector<dd4hep::rec::Vector2D> surfaceBounds( const dd4hep::rec::ISurface *surface ) {
+    std::vector<dd4hep::rec::Vector2D> bounds ;
+    auto globalSurface = dynamic_cast<const dd4hep::rec::Surface*>( surface ) ;
+    if( nullptr == globalSurface || not surface->type().isPlane() ) {
+      return bounds ;
+    }
+    // work in the volume frame: the local (u,v) coordinates don't depend on the placement
+    const dd4hep::rec::VolSurface volSurface = globalSurface->volSurface() ;
+    const TGeoShape *shape = volSurface.volume()->GetShape() ;
+    if( nullptr == shape || not ( TGeoBBox::Class() == shape->IsA() || TGeoTrd1::Class() == shape->IsA() || TGeoTrd2::Class() == shape->IsA() ) ) {
+      return bounds ;
+    }
+    // the 8 vertices of these convex shapes
+    double points[8*3] ;
+    shape->SetPoints( points ) ;
+    const dd4hep::rec::Vector3D origin = volSurface.origin() ;
+    const dd4hep::rec::Vector3D u = volSurface.u() ;
+    const dd4hep::rec::Vector3D v = volSurface.v() ;
+    const dd4hep::rec::Vector3D normal = volSurface.normal() ;
+    std::array<dd4hep::rec::Vector3D, 8> vertices ;
+    std::array<double, 8> distances ;
+    for( unsigned int i=0 ; i<8 ; ++i ) {
+      vertices[i] = dd4hep::rec::Vector3D( points[3*i], points[3*i+1], points[3*i+2] ) ;
+      distances[i] = ( vertices[i] - origin ) * normal ;
+    }
+    // the crossings of the plane with all the vertex pairs, their convex hull is the section
+    std::vector<std::pair<double, double>> crossings ;
+    for( unsigned int i=0 ; i<8 ; ++i ) {
+      for( unsigned int j=i ; j<8 ; ++j ) {
+        if( distances[i] * distances[j] > 0. || ( i == j && 0. != distances[i] ) || ( i != j && distances[i] == distances[j] ) ) {
+          continue ;
+        }
+        const double t = ( i == j ) ? 0. : distances[i] / ( distances[i] - distances[j] ) ;
+        const dd4hep::rec::Vector3D delta = vertices[i] + t * ( vertices[j] - vertices[i] ) - origin ;
+        crossings.emplace_back( delta * u, delta * v ) ;
+      }
+    }
+    // Andrew's monotone chain
+    std::sort( crossings.begin(), crossings.end() ) ;
+    crossings.erase( std::unique( crossings.begin(), crossings.end() ), crossings.end() ) ;
+    if( crossings.size() < 3 ) {
+      return bounds ;
+    }
+    auto cross = []( const std::pair<double, double> &o, const std::pair<double, double> &a, const std::pair<double, double> &b ) {
+      return ( a.first - o.first ) * ( b.second - o.second ) - ( a.second - o.second ) * ( b.first - o.first ) ;
+    } ;
+    std::vector<std::pair<double, double>> hull( 2 * crossings.size() ) ;
+    std::size_t k = 0 ;
+    for( std::size_t i=0 ; i<crossings.size() ; ++i ) {
+      while( k >= 2 && cross( hull[k-2], hull[k-1], crossings[i] ) <= 0. ) {
+        --k ;
+      }
+      hull[k++] = crossings[i] ;
+    }
+    for( std::size_t i=crossings.size()-1, lower=k+1 ; i>0 ; --i ) {
+      while( k >= lower && cross( hull[k-2], hull[k-1], crossings[i-1] ) <= 0. ) {
+        --k ;
+      }
+      hull[k++] = crossings[i-1] ;
+    }
+    // the last point is the first one
+    for( std::size_t i=0 ; i+1<k ; ++i ) {
+      bounds.emplace_back( hull[i].first, hull[i].second ) ;
+    }
+    return bounds ;
+  }
+
+}
+
+namespace marlinreco_mt {
+
+  dd4hep::rec::Vector2D SurfaceData::globalToLocal( const dd4hep::rec::Vector3D &point ) const {
+    if( nullptr != _surface ) {
+      return _surface->globalToLocal( point ) ;
+    }
+    if( not _isPlane ) {
+      throw EVENT::Exception( "SurfaceData::globalToLocal: only planar surfaces are supported without DD4hep" ) ;
+    }
+    const dd4hep::rec::Vector3D delta = point - _origin ;
+    return dd4hep::rec::Vector2D( delta * _u, delta * _v ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  dd4hep::rec::Vector3D SurfaceData::localToGlobal( const dd4hep::rec::Vector2D &local ) const {
+    if( nullptr != _surface ) {
+      return _surface->localToGlobal( local ) ;
+    }
+    if( not _isPlane ) {
+      throw EVENT::Exception( "SurfaceData::localToGlobal: only planar surfaces are supported without DD4hep" ) ;
+    }
+    return _origin + local.u() * _u + local.v() * _v ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  double SurfaceData::distance( const dd4hep::rec::Vector3D &point ) const {
+    if( nullptr != _surface ) {
+      return _surface->distance( point ) ;
+    }
+    if( not _isPlane ) {
+      throw EVENT::Exception( "SurfaceData::distance: only planar surfaces are supported without DD4hep" ) ;
+    }
+    return ( point - _origin ) * _normal ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool SurfaceData::insideBounds( const dd4hep::rec::Vector3D &point, double epsilon ) const {
+    if( nullptr != _surface ) {
+      return _surface->insideBounds( point, epsilon ) ;
+    }
+    if( _bounds.empty() ) {
+      throw EVENT::Exception( "SurfaceData::insideBounds: the surface bounds are not available without DD4hep" ) ;
+    }
+    if( std::fabs( distance( point ) ) >= epsilon ) {
+      return false ;
+    }
+    // inside a counter-clockwise convex polygon: on the left of all the edges
+    const auto local = globalToLocal( point ) ;
+    for( std::size_t i=0 ; i<_bounds.size() ; ++i ) {
+      const auto &a = _bounds[i] ;
+      const auto &b = _bounds[ ( i + 1 ) % _bounds.size() ] ;
+      if( ( b.u() - a.u() ) * ( local.v() - a.v() ) - ( b.v() - a.v() ) * ( local.u() - a.u() ) < 0. ) {
+        return false ;
+      }
+    }
+    return true ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool SurfaceData::hasBounds() const {
+    return ( nullptr != _surface ) || ( not _bounds.empty() ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  const SurfaceData *SurfaceTable::find( std::uint64_t cellID ) const {
+    auto iter = std::lower_bound( _cellIDs.begin(), _cellIDs.end(), cellID ) ;
+    if( _cellIDs.end() == iter || *iter != cellID ) {
+      return nullptr ;
+    }
+    return &_surfaces[ std::distance( _cellIDs.begin(), iter ) ] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::size_t SurfaceTable::size() const {
+    return _surfaces.size() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const std::vector<std::uint64_t> &SurfaceTable::cellIDs() const {
+    return _cellIDs ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool SurfaceTable::hasBounds() const {
+    return std::all_of( _surfaces.begin(), _surfaces.end(), []( const SurfaceData &data ){ return data.hasBounds() ; } ) ;
+  }
+
+  //--------------------------------------------------------------------------
+  //--------------------------------------------------------------------------
+
+  void GeometrySnapshot::configure( const std::string &cacheFile, const std::string &compactFile ) {
+    auto &state = snapshotState() ;
+    std::lock_guard<std::mutex> lock( state._mutex ) ;
+    if( not cacheFile.empty() && compactFile.empty() ) {
+      throw EVENT::Exception( "GeometrySnapshot::configure: a compact file is required to validate the geometry cache file " + cacheFile ) ;
+    }
+    if( state._configured ) {
+      if( cacheFile != state._cacheFile || compactFile != state._compactFile ) {
+        throw EVENT::Exception( "GeometrySnapshot::configure: the geometry snapshot is already configured with cache file '" + state._cacheFile + "' and compact file '" + state._compactFile + "', can't use cache file '" + cacheFile + "' and compact file '" + compactFile + "'" ) ;
+      }
+      return ;
+    }
+    if( nullptr != state._snapshot ) {
+      throw EVENT::Exception( "GeometrySnapshot::configure: the geometry snapshot was already created without cache settings. Run the GeometrySnapshot processor before the processors using the geometry" ) ;
+    }
+    state._configured = true ;
+    state._cacheFile = cacheFile ;
+    state._compactFile = compactFile ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<const GeometrySnapshot> GeometrySnapshot::instance() {
+    auto &state = snapshotState() ;
+    std::lock_guard<std::mutex> lock( state._mutex ) ;
+    if( nullptr != state._snapshot ) {
+      return state._snapshot ;
+    }
+    std::uint64_t hash = 0 ;
+    if( not state._cacheFile.empty() ) {
+      hash = geometryHash( state._compactFile ) ;
+      state._snapshot = read( state._cacheFile, hash ) ;
+      if( nullptr != state._snapshot ) {
+        streamlog_out( MESSAGE ) << "Geometry snapshot read from cache file " << state._cacheFile << std::endl ;
+        return state._snapshot ;
+      }
+    }
+    // never keep an empty snapshot: the geometry may be loaded later
+    auto extracted = std::make_shared<const GeometrySnapshot>( dd4hep::Detector::getInstance() ) ;
+    if( extracted->empty() ) {
+      throw EVENT::Exception( "GeometrySnapshot::instance: no geometry loaded in dd4hep::Detector. Load the DD4hep geometry (DD4hepGeometry) or use a valid geometry cache file" ) ;
+    }
+    if( not state._cacheFile.empty() && not extracted->write( state._cacheFile, hash ) ) {
+      streamlog_out( WARNING ) << "*** Couldn't write geometry cache file " << state._cacheFile << std::endl ;
+    }
+    state._snapshot = extracted ;
+    return state._snapshot ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::uint64_t GeometrySnapshot::geometryHash( const std::string &compactFile ) {
+    // 64 bits FNV-1a
+    std::uint64_t hash = 14695981039346656037ull ;
+    std::set<std::string> visited ;
+    hashCompactFile( compactFile, hash, visited ) ;
+    return hash ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::shared_ptr<const GeometrySnapshot> GeometrySnapshot::read( const std::string &fileName, std::uint64_t hash ) {
+    std::ifstream file( fileName, std::ios::binary ) ;
+    if( not file ) {
+      return nullptr ;
+    }
+    CacheHeader header {} ;
+    file.read( reinterpret_cast<char*>( &header ), sizeof(header) ) ;
+    if( not file
+      || 0 != std::memcmp( header._magic, CacheMagic, sizeof(header._magic) )
+      || Version != header._version
+      || hash != header._hash ) {
+      streamlog_out( WARNING ) << "*** Geometry cache file '" << fileName << "' is outdated or invalid, ignoring it" << std::endl ;
+      return nullptr ;
+    }
+    std::shared_ptr<GeometrySnapshot> snapshot( new GeometrySnapshot() ) ;
+    CacheReader reader( file ) ;
+    // surfaces
+    const auto nSurfaceTables = reader.readSize() ;
+    for( std::uint64_t t=0 ; t<nSurfaceTables && reader.good() ; ++t ) {
+      SurfaceTable &table = snapshot->_surfaces[ reader.readString() ] ;
+      const auto nSurfaces = reader.readSize() ;
+      table._cellIDs.resize( nSurfaces ) ;
+      table._surfaces.resize( nSurfaces ) ;
+      for( std::uint64_t i=0 ; i<nSurfaces && reader.good() ; ++i ) {
+        SurfaceData &data = table._surfaces[i] ;
+        table._cellIDs[i] = reader.read<std::uint64_t>() ;
+        data._isPlane = ( 0 != reader.read<std::uint32_t>() ) ;
+        data._origin = reader.readVector() ;
+        data._u = reader.readVector() ;
+        data._v = reader.readVector() ;
+        data._normal = reader.readVector() ;
+        data._uDirection[0] = reader.read<float>() ;
+        data._uDirection[1] = reader.read<float>() ;
+        data._vDirection[0] = reader.read<float>() ;
+        data._vDirection[1] = reader.read<float>() ;
+        data._lengthAlongU = reader.read<double>() ;
+        data._lengthAlongV = reader.read<double>() ;
+        data._bounds.resize( reader.readSize() ) ;
+        for( auto &vertex : data._bounds ) {
+          const double u = reader.read<double>() ;
+          const double v = reader.read<double>() ;
+          vertex = dd4hep::rec::Vector2D( u, v ) ;
+        }
+      }
+    }
+    // calorimeters
+    const auto nCalorimeters = reader.readSize() ;
+    for( std::uint64_t c=0 ; c<nCalorimeters && reader.good() ; ++c ) {
+      CalorimeterGeometry geometry {} ;
+      geometry._name = reader.readString() ;
+      geometry._typeFlag = reader.read<std::uint64_t>() ;
+      for( auto &extent : geometry._extent ) {
+        extent = reader.read<double>() ;
+      }
+      geometry._innerSymmetry = reader.read<std::int32_t>() ;
+      geometry._outerSymmetry = reader.read<std::int32_t>() ;
+      geometry._innerPhi0 = reader.read<double>() ;
+      geometry._outerPhi0 = reader.read<double>() ;
+      geometry._layers.resize( reader.readSize() ) ;
+      for( auto &layer : geometry._layers ) {
+        layer._distance = reader.read<double>() ;
+        layer._phi0 = reader.read<double>() ;
+        layer._absorberThickness = reader.read<double>() ;
+        layer._sensitiveThickness = reader.read<double>() ;
+        layer._cellSize0 = reader.read<double>() ;
+        layer._cellSize1 = reader.read<double>() ;
+      }
+      const std::string name = geometry._name ;
+      snapshot->_calorimeters.emplace( name, std::move( geometry ) ) ;
+    }
+    // disk petals
+    const auto nPetals = reader.readSize() ;
+    for( std::uint64_t p=0 ; p<nPetals && reader.good() ; ++p ) {
+      ZDiskPetalsGeometry geometry {} ;
+      geometry._name = reader.readString() ;
+      geometry._widthStrip = reader.read<double>() ;
+      geometry._lengthStrip = reader.read<double>() ;
+      geometry._pitchStrip = reader.read<double>() ;
+      geometry._angleStrip = reader.read<double>() ;
+      geometry._layers.resize( reader.readSize() ) ;
+      for( auto &layer : geometry._layers ) {
+        layer._zPosition = reader.read<double>() ;
+        layer._phi0 = reader.read<double>() ;
+        layer._petalHalfAngle = reader.read<double>() ;
+        layer._petalNumber = reader.read<std::int32_t>() ;
+        layer._sensorsPerPetal = reader.read<std::int32_t>() ;
+      }
+      const std::string name = geometry._name ;
+      snapshot->_zDiskPetals.emplace( name, std::move( geometry ) ) ;
+    }
+    // TPCs
+    const auto nTPCs = reader.readSize() ;
+    for( std::uint64_t t=0 ; t<nTPCs && reader.good() ; ++t ) {
+      const std::string name = reader.readString() ;
+      dd4hep::rec::FixedPadSizeTPCData tpc {} ;
+      tpc.zHalf = reader.read<double>() ;
+      tpc.rMin = reader.read<double>() ;
+      tpc.rMax = reader.read<double>() ;
+      tpc.driftLength = reader.read<double>() ;
+      tpc.rMinReadout = reader.read<double>() ;
+      tpc.rMaxReadout = reader.read<double>() ;
+      tpc.innerWallThickness = reader.read<double>() ;
+      tpc.outerWallThickness = reader.read<double>() ;
+      tpc.padHeight = reader.read<double>() ;
+      tpc.padWidth = reader.read<double>() ;
+      tpc.maxRow = reader.read<std::int32_t>() ;
+      tpc.padGap = reader.read<double>() ;
+      snapshot->_tpcs.emplace( name, tpc ) ;
+    }
+    // magnetic field
+    snapshot->_magneticField = reader.read<double>() ;
+    // a valid file ends exactly here
+    if( not reader.good() || std::istream::traits_type::eof() != file.peek() ) {
+      streamlog_out( WARNING ) << "*** Geometry cache file '" << fileName << "' is truncated or corrupted, ignoring it" << std::endl ;
+      return nullptr ;
+    }
+    return snapshot ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  //--------------------------------------------------------------------------
+
+  GeometrySnapshot::GeometrySnapshot( const dd4hep::Detector &detector ) {
+    auto surfaceManager = detector.extension<dd4hep::rec::SurfaceManager>( false ) ;
+    for( const auto &entry : detector.detectors() ) {
+      const dd4hep::DetElement element( entry.second ) ;
+      const std::string &name = entry.first ;
+      // surfaces
+      const dd4hep::rec::SurfaceMap *surfaceMap = ( nullptr != surfaceManager ) ? surfaceManager->map( name ) : nullptr ;
+      if( nullptr != surfaceMap ) {
+        // the surface map is ordered by cellID, keep the first surface of a cellID as SurfaceMap::find() does
+        SurfaceTable &table = _surfaces[ name ] ;
+        table._cellIDs.reserve( surfaceMap->size() ) ;
+        table._surfaces.reserve( surfaceMap->size() ) ;
+        for( const auto &surface : *surfaceMap ) {
+          if( not table._cellIDs.empty() && table._cellIDs.back() == surface.first ) {
+            continue ;
+          }
+          SurfaceData data {} ;
+          data._surface = surface.second ;
+          data._isPlane = surface.second->type().isPlane() ;
+          data._origin = surface.second->origin() ;
+          data._u = surface.second->u() ;
+          data._v = surface.second->v() ;
+          data._normal = surface.second->normal() ;
+          data._uDirection = {{ static_cast<float>( data._u.theta() ), static_cast<float>( data._u.phi() ) }} ;
+          data._vDirection = {{ static_cast<float>( data._v.theta() ), static_cast<float>( data._v.phi() ) }} ;
+          data._lengthAlongU = surface.second->length_along_u() ;
+          data._lengthAlongV = surface.second->length_along_v() ;
+          table._cellIDs.push_back( surface.first ) ;
+          table._surfaces.push_back( data ) ;
+        }
+      }
+      // layered calorimeter
+      auto caloData = element.extension<dd4hep::rec::LayeredCalorimeterData>( false ) ;
+      if( nullptr != caloData ) {
+        CalorimeterGeometry geometry {} ;
+        geometry._name = name ;
+        geometry._typeFlag = element.typeFlag() ;
+        std::copy( std::begin( caloData->extent ), std::end( caloData->extent ), geometry._extent.begin() ) ;
+        geometry._innerSymmetry = caloData->inner_symmetry ;
+        geometry._outerSymmetry = caloData->outer_symmetry ;
+        geometry._innerPhi0 = caloData->inner_phi0 ;
+        geometry._outerPhi0 = caloData->outer_phi0 ;
+        geometry._layers.reserve( caloData->layers.size() ) ;
+        for( const auto &layer : caloData->layers ) {
+          CalorimeterLayer calorimeterLayer {} ;
+          calorimeterLayer._distance = layer.distance ;
+          calorimeterLayer._phi0 = layer.phi0 ;
+          calorimeterLayer._absorberThickness = layer.absorberThickness ;
+          calorimeterLayer._sensitiveThickness = layer.sensitive_thickness ;
+          calorimeterLayer._cellSize0 = layer.cellSize0 ;
+          calorimeterLayer._cellSize1 = layer.cellSize1 ;
+          geometry._layers.push_back( calorimeterLayer ) ;
+        }
+        _calorimeters.emplace( name, std::move( geometry ) ) ;
+      }
+      // disk petals
+      auto petalsData = element.extension<dd4hep::rec::ZDiskPetalsData>( false ) ;
+      if( nullptr != petalsData ) {
+        ZDiskPetalsGeometry geometry {} ;
+        geometry._name = name ;
+        geometry._widthStrip = petalsData->widthStrip ;
+        geometry._lengthStrip = petalsData->lengthStrip ;
+        geometry._pitchStrip = petalsData->pitchStrip ;
+        geometry._angleStrip = petalsData->angleStrip ;
+        geometry._layers.reserve( petalsData->layers.size() ) ;
+        for( const auto &layer : petalsData->layers ) {
+          ZDiskPetalsLayer petalsLayer {} ;
+          petalsLayer._zPosition = layer.zPosition ;
+          petalsLayer._phi0 = layer.phi0 ;
+          petalsLayer._petalHalfAngle = layer.petalHalfAngle ;
+          petalsLayer._petalNumber = layer.petalNumber ;
+          petalsLayer._sensorsPerPetal = layer.sensorsPerPetal ;
+          geometry._layers.push_back( petalsLayer ) ;
+        }
+        _zDiskPetals.emplace( name, std::move( geometry ) ) ;
+      }
+      // TPC
+      auto tpcData = element.extension<dd4hep::rec::FixedPadSizeTPCData>( false ) ;
+      if( nullptr != tpcData ) {
+        _tpcs.emplace( name, *tpcData ) ;
+      }
+    }
+    // magnetic field at the origin
+    const double origin[3] = { 0., 0., 0. } ;
+    double field[3] = { 0., 0., 0. } ;
+    detector.field().magneticField( origin, field ) ;
+    _magneticField = field[2] ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const SurfaceTable *GeometrySnapshot::surfaces( const std::string &detector ) const {
+    auto iter = _surfaces.find( detector ) ;
+    return ( _surfaces.end() != iter ) ? &iter->second : nullptr ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const CalorimeterGeometry *GeometrySnapshot::calorimeter( const std::string &detector ) const {
+    auto iter = _calorimeters.find( detector ) ;
+    return ( _calorimeters.end() != iter ) ? &iter->second : nullptr ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  std::vector<const CalorimeterGeometry*> GeometrySnapshot::calorimeters( unsigned long includeFlag, unsigned long excludeFlag ) const {
+    std::vector<const CalorimeterGeometry*> selected ;
+    for( const auto &calorimeter : _calorimeters ) {
+      const unsigned long typeFlag = calorimeter.second._typeFlag ;
+      if( ( typeFlag & includeFlag ) == includeFlag && 0 == ( typeFlag & excludeFlag ) ) {
+        selected.push_back( &calorimeter.second ) ;
+      }
+    }
+    return selected ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const ZDiskPetalsGeometry *GeometrySnapshot::zDiskPetals( const std::string &detector ) const {
+    auto iter = _zDiskPetals.find( detector ) ;
+    return ( _zDiskPetals.end() != iter ) ? &iter->second : nullptr ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  const dd4hep::rec::FixedPadSizeTPCData *GeometrySnapshot::fixedPadSizeTPC( const std::string &detector ) const {
+    auto iter = _tpcs.find( detector ) ;
+    return ( _tpcs.end() != iter ) ? &iter->second : nullptr ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  double GeometrySnapshot::magneticField() const {
+    return _magneticField ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool GeometrySnapshot::empty() const {
+    return _surfaces.empty() && _calorimeters.empty() && _zDiskPetals.empty() && _tpcs.empty() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool GeometrySnapshot::write( const std::string &fileName, std::uint64_t hash ) const {
+    // an empty snapshot would hide the geometry from the next jobs
+    if( empty() ) {
+      return false ;
+    }
+    CacheHeader header {} ;
+    std::memcpy( header._magic, CacheMagic, sizeof(header._magic) ) ;
+    header._version = Version ;
+    header._hash = hash ;
+    // unique temporary file: concurrent jobs may create the same cache file
+    std::string tmpName = fileName + ".XXXXXX" ;
+    const int fd = ::mkstemp( &tmpName[0] ) ;
+    if( fd < 0 ) {
+      return false ;
+    }
+    // mkstemp creates the file readable by the owner only
+    ::fchmod( fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH ) ;
+    ::close( fd ) ;
+    {
+      std::ofstream file( tmpName, std::ios::binary | std::ios::trunc ) ;
+      if( not file ) {
+        std::remove( tmpName.c_str() ) ;
+        return false ;
+      }
+      CacheWriter writer( file ) ;
+      writer.write( header ) ;
+      // surfaces
+      writer.write<std::uint64_t>( _surfaces.size() ) ;
+      for( const auto &table : _surfaces ) {
+        writer.write( table.first ) ;
+        writer.write<std::uint64_t>( table.second._surfaces.size() ) ;
+        for( std::size_t i=0 ; i<table.second._surfaces.size() ; ++i ) {
+          const SurfaceData &data = table.second._surfaces[i] ;
+          writer.write<std::uint64_t>( table.second._cellIDs[i] ) ;
+          writer.write<std::uint32_t>( data._isPlane ? 1 : 0 ) ;
+          writer.write( data._origin ) ;
+          writer.write( data._u ) ;
+          writer.write( data._v ) ;
+          writer.write( data._normal ) ;
+          writer.write( data._uDirection[0] ) ;
+          writer.write( data._uDirection[1] ) ;
+          writer.write( data._vDirection[0] ) ;
+          writer.write( data._vDirection[1] ) ;
+          writer.write( data._lengthAlongU ) ;
+          writer.write( data._lengthAlongV ) ;
+          // the bounds of the DDRec surfaces are only needed in the cache file: compute them here
+          const auto bounds = ( nullptr != data._surface ) ? surfaceBounds( data._surface ) : data._bounds ;
+          writer.write<std::uint64_t>( bounds.size() ) ;
+          for( const auto &vertex : bounds ) {
+            writer.write( vertex.u() ) ;
+            writer.write( vertex.v() ) ;
+          }
+        }
+      }
+      // calorimeters
+      writer.write<std::uint64_t>( _calorimeters.size() ) ;
+      for( const auto &calorimeter : _calorimeters ) {
+        const CalorimeterGeometry &geometry = calorimeter.second ;
+        writer.write( geometry._name ) ;
+        writer.write<std::uint64_t>( geometry._typeFlag ) ;
+        for( const auto extent : geometry._extent ) {
+          writer.write( extent ) ;
+        }
+        writer.write<std::int32_t>( geometry._innerSymmetry ) ;
+        writer.write<std::int32_t>( geometry._outerSymmetry ) ;
+        writer.write( geometry._innerPhi0 ) ;
+        writer.write( geometry._outerPhi0 ) ;
+        writer.write<std::uint64_t>( geometry._layers.size() ) ;
+        for( const auto &layer : geometry._layers ) {
+          writer.write( layer._distance ) ;
+          writer.write( layer._phi0 ) ;
+          writer.write( layer._absorberThickness ) ;
+          writer.write( layer._sensitiveThickness ) ;
+          writer.write( layer._cellSize0 ) ;
+          writer.write( layer._cellSize1 ) ;
+        }
+      }
+      // disk petals
+      writer.write<std::uint64_t>( _zDiskPetals.size() ) ;
+      for( const auto &petals : _zDiskPetals ) {
+        const ZDiskPetalsGeometry &geometry = petals.second ;
+        writer.write( geometry._name ) ;
+        writer.write( geometry._widthStrip ) ;
+        writer.write( geometry._lengthStrip ) ;
+        writer.write( geometry._pitchStrip ) ;
+        writer.write( geometry._angleStrip ) ;
+        writer.write<std::uint64_t>( geometry._layers.size() ) ;
+        for( const auto &layer : geometry._layers ) {
+          writer.write( layer._zPosition ) ;
+          writer.write( layer._phi0 ) ;
+          writer.write( layer._petalHalfAngle ) ;
+          writer.write<std::int32_t>( layer._petalNumber ) ;
+          writer.write<std::int32_t>( layer._sensorsPerPetal ) ;
+        }
+      }
+      // TPCs
+      writer.write<std::uint64_t>( _tpcs.size() ) ;
+      for( const auto &entry : _tpcs ) {
+        const dd4hep::rec::FixedPadSizeTPCData &tpc = entry.second ;
+        writer.write( entry.first ) ;
+        writer.write<double>( tpc.zHalf ) ;
+        writer.write<double>( tpc.rMin ) ;
+        writer.write<double>( tpc.rMax ) ;
+        writer.write<double>( tpc.driftLength ) ;
+        writer.write<double>( tpc.rMinReadout ) ;
+        writer.write<double>( tpc.rMaxReadout ) ;
+        writer.write<double>( tpc.innerWallThickness ) ;
+        writer.write<double>( tpc.outerWallThickness ) ;
+        writer.write<double>( tpc.padHeight ) ;
+        writer.write<double>( tpc.padWidth ) ;
+        writer.write<std::int32_t>( tpc.maxRow ) ;
+        writer.write<double>( tpc.padGap ) ;
+      }
+      // magnetic field
+      writer.write<double>( _magneticField ) ;
+      if( not file ) {
+        std::remove( tmpName.c_str() ) ;
+        return false ;
+      }
+    }
+    if( 0 != std::rename( tmpName.c_str(), fileName.c_str() ) ) {
+      std::remove( tmpName.c_str() ) ;
+      return false ;
+    }
+    return true ;
+  }
+
+}
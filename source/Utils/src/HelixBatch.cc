@@ -0,0 +1,186 @@
+#include <MarlinRecoMT/HelixBatch.h>
+#include <MarlinRecoMT/SimpleHelix.h>
+#include <MarlinRecoMT/HelixCovariance.h>
+
+// -- std headers
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+namespace marlinreco_mt {
+
+  HelixBatch::HelixBatch( double bField ) :
+    _bField( bField ) {
+    /* nop */
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HelixBatch::reserve( std::size_t n ) {
+    _d0.reserve( n ) ;
+    _phi0.reserve( n ) ;
+    _omega.reserve( n ) ;
+    _z0.reserve( n ) ;
+    _tanLambda.reserve( n ) ;
+    _reference.reserve( n ) ;
+    _errors.reserve( n ) ;
+    _xCentre.reserve( n ) ;
+    _yCentre.reserve( n ) ;
+    _zOffset.reserve( n ) ;
+    _absRadius.reserve( n ) ;
+    _varphi0.reserve( n ) ;
+    _sinVarphi0.reserve( n ) ;
+    _cosVarphi0.reserve( n ) ;
+    _w.reserve( n ) ;
+    _sinLambda.reserve( n ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HelixBatch::clear() {
+    _d0.clear() ;
+    _phi0.clear() ;
+    _omega.clear() ;
+    _z0.clear() ;
+    _tanLambda.clear() ;
+    _reference.clear() ;
+    _errors.clear() ;
+    _xCentre.clear() ;
+    _yCentre.clear() ;
+    _zOffset.clear() ;
+    _absRadius.clear() ;
+    _varphi0.clear() ;
+    _sinVarphi0.clear() ;
+    _cosVarphi0.clear() ;
+    _w.clear() ;
+    _sinLambda.clear() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  unsigned int HelixBatch::addHelix( double d0, double phi0, double omega, double z0, double tanLambda,
+                                     const LCVector3D &referencePoint, const LCErrorMatrix<5> *errors ) {
+    _d0.push_back( d0 ) ;
+    _phi0.push_back( phi0 ) ;
+    _omega.push_back( omega ) ;
+    _z0.push_back( z0 ) ;
+    _tanLambda.push_back( tanLambda ) ;
+    _reference.push_back( referencePoint ) ;
+    _errors.push_back( ( nullptr != errors ) ? *errors : LCErrorMatrix<5>() ) ;
+    // same computation as SimpleHelix
+    double sinVarphi0(0.), cosVarphi0(0.), cosLambda(0.) ;
+    const HelixCoefficients helix = computeHelixCoefficients( d0, phi0, omega, z0, tanLambda, referencePoint, sinVarphi0, cosVarphi0, cosLambda ) ;
+    _xCentre.push_back( helix.xCentre ) ;
+    _yCentre.push_back( helix.yCentre ) ;
+    _zOffset.push_back( helix.zOffset ) ;
+    _absRadius.push_back( helix.absRadius ) ;
+    _varphi0.push_back( helix.varphi0 ) ;
+    _sinVarphi0.push_back( sinVarphi0 ) ;
+    _cosVarphi0.push_back( cosVarphi0 ) ;
+    _w.push_back( helix.w ) ;
+    _sinLambda.push_back( helix.sinLambda ) ;
+    return _d0.size() - 1 ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  HelixCoefficients HelixBatch::coefficients( std::size_t index ) const {
+    HelixCoefficients helix ;
+    helix.xCentre = _xCentre[index] ;
+    helix.yCentre = _yCentre[index] ;
+    helix.zOffset = _zOffset[index] ;
+    helix.absRadius = _absRadius[index] ;
+    helix.varphi0 = _varphi0[index] ;
+    helix.w = _w[index] ;
+    helix.sinLambda = _sinLambda[index] ;
+    return helix ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HelixBatch::positionsAt( Span<const double> s, Span<double> x, Span<double> y, Span<double> z ) const {
+    checkSize( s.size() ) ;
+    checkSize( x.size() ) ;
+    checkSize( y.size() ) ;
+    checkSize( z.size() ) ;
+    const std::size_t nHelices = size() ;
+    for( std::size_t i=0 ; i<nHelices ; ++i ) {
+      // the position on the circle has the phase varphi0 - w*s
+      const double ws = _w[i] * s[i] ;
+      const double sinWS = std::sin( ws ) ;
+      const double cosWS = std::cos( ws ) ;
+      x[i] = _xCentre[i] + _absRadius[i] * (_cosVarphi0[i]*cosWS + _sinVarphi0[i]*sinWS) ;
+      y[i] = _yCentre[i] + _absRadius[i] * (_sinVarphi0[i]*cosWS - _cosVarphi0[i]*sinWS) ;
+      z[i] = _zOffset[i] + s[i] * _sinLambda[i] ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HelixBatch::directionsAt( Span<const double> s, Span<double> dx, Span<double> dy, Span<double> dz ) const {
+    checkSize( s.size() ) ;
+    checkSize( dx.size() ) ;
+    checkSize( dy.size() ) ;
+    checkSize( dz.size() ) ;
+    const std::size_t nHelices = size() ;
+    for( std::size_t i=0 ; i<nHelices ; ++i ) {
+      const double ws = _w[i] * s[i] ;
+      const double sinWS = std::sin( ws ) ;
+      const double cosWS = std::cos( ws ) ;
+      const double wR = _w[i] * _absRadius[i] ;
+      dx[i] = wR * (_sinVarphi0[i]*cosWS - _cosVarphi0[i]*sinWS) ;
+      dy[i] = -wR * (_cosVarphi0[i]*cosWS + _sinVarphi0[i]*sinWS) ;
+      dz[i] = _sinLambda[i] ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HelixBatch::intersectionsWithPlane( const LCPlane3D &plane, Span<double> s, Span<HelixIntersectionStatus> status ) const {
+    checkSize( s.size() ) ;
+    checkSize( status.size() ) ;
+    const std::size_t nHelices = size() ;
+    for( std::size_t i=0 ; i<nHelices ; ++i ) {
+      status[i] = intersectHelixWithPlane( coefficients( i ), plane, s[i] ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HelixBatch::intersectionsWithCylinder( const LCCylinder &cylinder, Span<double> s, Span<HelixIntersectionStatus> status ) const {
+    checkSize( s.size() ) ;
+    checkSize( status.size() ) ;
+    const std::size_t nHelices = size() ;
+    if( isAxialCylinder( cylinder ) ) {
+      for( std::size_t i=0 ; i<nHelices ; ++i ) {
+        status[i] = intersectHelixWithAxialCylinder( coefficients( i ), cylinder, s[i] ) ;
+      }
+      return ;
+    }
+    // tilted cylinders are not solved in closed form: use the SimpleHelix stepping
+    for( std::size_t i=0 ; i<nHelices ; ++i ) {
+      SimpleHelix helix( _d0[i], _phi0[i], _omega[i], _z0[i], _tanLambda[i], _reference[i] ) ;
+      status[i] = helix.intersectWithCylinder( cylinder, s[i] ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HelixBatch::covariancesAt( Span<const double> s, Span<LCErrorMatrix<6>> covariances ) const {
+    checkSize( s.size() ) ;
+    checkSize( covariances.size() ) ;
+    const std::size_t nHelices = size() ;
+    for( std::size_t i=0 ; i<nHelices ; ++i ) {
+      covariances[i] = propagateHelixCovariance( _d0[i], _phi0[i], _omega[i], _tanLambda[i], s[i], _bField, _errors[i] ) ;
+    }
+  }
+
+  //--------------------------------------------------------------------------
+
+  void HelixBatch::checkSize( std::size_t spanSize ) const {
+    if( spanSize != size() ) {
+      throw std::invalid_argument( "HelixBatch: expected " + std::to_string( size() ) + " entries, got " + std::to_string( spanSize ) ) ;
+    }
+  }
+
+}
@@ -0,0 +1,77 @@
+#include <MarlinRecoMT/HelixCovariance.h>
+
+// -- std headers
+#include <cmath>
+
+namespace marlinreco_mt {
+
+  namespace {
+
+    /// Transverse momentum (GeV) per unit curvature (1/mm) and magnetic field (T)
+    constexpr double momentumFactor = 2.99792458E-4 ;
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  HelixPositionJacobian helixPositionJacobian( double d0, double phi0, double omega, double tanLambda, double s ) {
+    // with phi = phi0 - omega*cosLambda*s the direction azimuth:
+    //   x = xRef + (1/omega - d0)*sin(phi0) - sin(phi)/omega
+    //   y = yRef - (1/omega - d0)*cos(phi0) + cos(phi)/omega
+    //   z = zRef + z0 + s*tanLambda*cosLambda
+    const double radius = 1. / omega ;
+    const double cosLambda = 1. / std::sqrt( 1. + tanLambda*tanLambda ) ;
+    const double cosLambda3 = cosLambda * cosLambda * cosLambda ;
+    const double phi = phi0 - omega * cosLambda * s ;
+    const double sinPhi = std::sin( phi ) ;
+    const double cosPhi = std::cos( phi ) ;
+    const double sinPhi0 = std::sin( phi0 ) ;
+    const double cosPhi0 = std::cos( phi0 ) ;
+    // derivatives of phi
+    const double dPhiDOmega = -cosLambda * s ;
+    const double dPhiDTanLambda = omega * s * tanLambda * cosLambda3 ;
+    HelixPositionJacobian jacobian ;
+    jacobian( 0, 0 ) = -sinPhi0 ;
+    jacobian( 0, 1 ) = (radius - d0) * cosPhi0 - radius * cosPhi ;
+    jacobian( 0, 2 ) = radius * radius * (sinPhi - sinPhi0) - radius * cosPhi * dPhiDOmega ;
+    jacobian( 0, 4 ) = -radius * cosPhi * dPhiDTanLambda ;
+    jacobian( 1, 0 ) = cosPhi0 ;
+    jacobian( 1, 1 ) = (radius - d0) * sinPhi0 - radius * sinPhi ;
+    jacobian( 1, 2 ) = radius * radius * (cosPhi0 - cosPhi) - radius * sinPhi * dPhiDOmega ;
+    jacobian( 1, 4 ) = -radius * sinPhi * dPhiDTanLambda ;
+    jacobian( 2, 3 ) = 1. ;
+    jacobian( 2, 4 ) = s * cosLambda3 ;
+    return jacobian ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  HelixJacobian helixJacobian( double d0, double phi0, double omega, double tanLambda, double s, double bField ) {
+    // with pT = k*B/|omega|:
+    //   px = pT*cos(phi),  py = pT*sin(phi),  pz = pT*tanLambda
+    const double radius = 1. / omega ;
+    const double pT = momentumFactor * bField * std::fabs( radius ) ;
+    const double cosLambda = 1. / std::sqrt( 1. + tanLambda*tanLambda ) ;
+    const double cosLambda3 = cosLambda * cosLambda * cosLambda ;
+    const double phi = phi0 - omega * cosLambda * s ;
+    const double sinPhi = std::sin( phi ) ;
+    const double cosPhi = std::cos( phi ) ;
+    // derivatives of phi
+    const double dPhiDOmega = -cosLambda * s ;
+    const double dPhiDTanLambda = omega * s * tanLambda * cosLambda3 ;
+    HelixJacobian jacobian ;
+    // position
+    jacobian.Place_at( helixPositionJacobian( d0, phi0, omega, tanLambda, s ), 0, 0 ) ;
+    // momentum
+    jacobian( 3, 1 ) = -pT * sinPhi ;
+    jacobian( 3, 2 ) = -pT * radius * cosPhi - pT * sinPhi * dPhiDOmega ;
+    jacobian( 3, 4 ) = -pT * sinPhi * dPhiDTanLambda ;
+    jacobian( 4, 1 ) = pT * cosPhi ;
+    jacobian( 4, 2 ) = -pT * radius * sinPhi + pT * cosPhi * dPhiDOmega ;
+    jacobian( 4, 4 ) = pT * cosPhi * dPhiDTanLambda ;
+    jacobian( 5, 2 ) = -pT * radius * tanLambda ;
+    jacobian( 5, 4 ) = pT ;
+    return jacobian ;
+  }
+
+}
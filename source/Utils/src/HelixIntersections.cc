@@ -0,0 +1,264 @@
+#include <MarlinRecoMT/HelixIntersections.h>
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <float.h>
+
+namespace marlinreco_mt {
+
+  namespace {
+
+    /// Maximum number of Newton iterations in the helix solvers
+    constexpr unsigned int maxNewtonIterations = 100 ;
+    /// Maximum number of monotonous segments searched for a root
+    constexpr unsigned int maxRootSegments = 100000 ;
+    /// Path length precision of the helix solvers, relative above 1 mm
+    constexpr double pathPrecision = 1e-10 ;
+
+    /** A signed distance along the helix, in the form
+     *  g(s) = offset + slope * s + amplitude * cos( w * (sPhase - s) )
+     *  The distance of the helix to a plane and the distance to a cylinder
+     *  parallel to the helix axis (squared, up to a factor) take this form.
+     */
+    struct PhaseFunction {
+      double offset ;
+      double slope ;
+      double amplitude ;
+      double w ;
+      double sPhase ;
+
+      double value( double s ) const {
+        return offset + slope * s + amplitude * std::cos( w * (sPhase - s) ) ;
+      }
+
+      double derivative( double s ) const {
+        return slope + amplitude * w * std::sin( w * (sPhase - s) ) ;
+      }
+    };
+
+    /// The first value x + n * period >= sMin, n integer
+    inline double firstAfter( double x, double period, double sMin ) {
+      return x + period * std::ceil( (sMin - x) / period ) ;
+    }
+
+    /** Root of g in [sLow, sHigh], g being monotonous on this interval with g(sLow) and
+     *  g(sHigh) of opposite signs. Newton iterations, falling back to bisection when the
+     *  Newton step leaves the bracket
+     */
+    HelixIntersectionStatus bracketedRoot( const PhaseFunction &g, double sLow, double sHigh, double &s ) {
+      const bool increasing = ( g.value( sHigh ) > g.value( sLow ) ) ;
+      s = 0.5 * ( sLow + sHigh ) ;
+      for( unsigned int i=0 ; i<maxNewtonIterations ; ++i ) {
+        const double value = g.value( s ) ;
+        if( (value < 0.) == increasing ) {
+          sLow = s ;
+        }
+        else {
+          sHigh = s ;
+        }
+        const double derivative = g.derivative( s ) ;
+        double sNext = ( 0. != derivative ) ? s - value / derivative : sLow - 1. ;
+        if( sNext <= sLow or sNext >= sHigh ) {
+          sNext = 0.5 * ( sLow + sHigh ) ;
+        }
+        const double step = std::fabs( sNext - s ) ;
+        const double precision = pathPrecision * std::max( 1., std::fabs( sNext ) ) ;
+        s = sNext ;
+        if( step < precision or (sHigh - sLow) < precision ) {
+          return HelixIntersectionStatus::Found ;
+        }
+      }
+      return HelixIntersectionStatus::NotConverged ;
+    }
+
+    /** First root of g in [sMin, sMax]. The amplitude must be positive.
+     *  Without slope, the roots are obtained in closed form. Otherwise the roots lie in
+     *  the band where |offset + slope * s| <= amplitude, which is split at the extrema
+     *  of g into monotonous segments, searched in order
+     */
+    HelixIntersectionStatus firstRoot( const PhaseFunction &g, double sMin, double sMax, double &s ) {
+      s = 0. ;
+      if( sMin > sMax ) {
+        return HelixIntersectionStatus::NoIntersection ;
+      }
+      if( 0. == g.amplitude ) {
+        if( 0. == g.slope ) {
+          if( 0. != g.offset ) {
+            return HelixIntersectionStatus::NoIntersection ;
+          }
+          // the helix lies on the surface
+          s = sMin ;
+          return HelixIntersectionStatus::Found ;
+        }
+        const double root = -g.offset / g.slope ;
+        if( root < sMin or root > sMax ) {
+          return HelixIntersectionStatus::NoIntersection ;
+        }
+        s = root ;
+        return HelixIntersectionStatus::Found ;
+      }
+      const double period = 2. * M_PI / std::fabs( g.w ) ;
+      if( 0. == g.slope ) {
+        // cos( w * (sPhase - s) ) = cosine, two roots per period
+        const double cosine = -g.offset / g.amplitude ;
+        if( std::fabs( cosine ) > 1. ) {
+          return HelixIntersectionStatus::NoIntersection ;
+        }
+        const double dPhase = std::acos( cosine ) / g.w ;
+        const double root = std::min( firstAfter( g.sPhase - dPhase, period, sMin ), firstAfter( g.sPhase + dPhase, period, sMin ) ) ;
+        if( root > sMax ) {
+          return HelixIntersectionStatus::NoIntersection ;
+        }
+        s = root ;
+        return HelixIntersectionStatus::Found ;
+      }
+      // restrict to the band where roots can exist
+      const double band1 = ( -g.offset - g.amplitude ) / g.slope ;
+      const double band2 = ( -g.offset + g.amplitude ) / g.slope ;
+      const double sLow = std::max( sMin, std::min( band1, band2 ) ) ;
+      const double sHigh = std::min( sMax, std::max( band1, band2 ) ) ;
+      if( sLow > sHigh ) {
+        return HelixIntersectionStatus::NoIntersection ;
+      }
+      // the extrema of g: sin( w * (sPhase - s) ) = -slope / (amplitude * w)
+      double extremum1 = sHigh, extremum2 = sHigh ;
+      const double sine = -g.slope / ( g.amplitude * g.w ) ;
+      if( std::fabs( sine ) < 1. ) {
+        const double phase = std::asin( sine ) ;
+        extremum1 = firstAfter( g.sPhase - phase / g.w, period, sLow ) ;
+        extremum2 = firstAfter( g.sPhase - ( M_PI - phase ) / g.w, period, sLow ) ;
+      }
+      // walk the monotonous segments
+      double segmentStart = sLow ;
+      double valueStart = g.value( sLow ) ;
+      for( unsigned int segment=0 ; segment<maxRootSegments ; ++segment ) {
+        if( 0. == valueStart ) {
+          s = segmentStart ;
+          return HelixIntersectionStatus::Found ;
+        }
+        double segmentEnd = std::min( sHigh, std::min( extremum1, extremum2 ) ) ;
+        const double valueEnd = g.value( segmentEnd ) ;
+        if( (valueStart < 0.) != (valueEnd < 0.) or 0. == valueEnd ) {
+          if( 0. == valueEnd ) {
+            s = segmentEnd ;
+            return HelixIntersectionStatus::Found ;
+          }
+          return bracketedRoot( g, segmentStart, segmentEnd, s ) ;
+        }
+        if( segmentEnd >= sHigh ) {
+          return HelixIntersectionStatus::NoIntersection ;
+        }
+        if( extremum1 <= segmentEnd ) {
+          extremum1 += period ;
+        }
+        if( extremum2 <= segmentEnd ) {
+          extremum2 += period ;
+        }
+        segmentStart = segmentEnd ;
+        valueStart = valueEnd ;
+      }
+      return HelixIntersectionStatus::NotConverged ;
+    }
+
+  }
+
+  //--------------------------------------------------------------------------
+
+  HelixCoefficients computeHelixCoefficients( double d0, double phi0, double omega, double z0, double tanLambda,
+                                              const LCVector3D &referencePoint,
+                                              double &sinVarphi0, double &cosVarphi0, double &cosLambda ) {
+    HelixCoefficients helix ;
+    const double radius = 1. / omega ;
+    helix.xCentre = referencePoint.x() + (radius - d0) * std::sin( phi0 ) ;
+    helix.yCentre = referencePoint.y() - (radius - d0) * std::cos( phi0 ) ;
+    helix.zOffset = referencePoint.z() + z0 ;
+    helix.absRadius = std::fabs( radius ) ;
+    helix.varphi0 = phi0 + (omega * M_PI) / (2. * std::fabs( omega )) ;
+    sinVarphi0 = std::sin( helix.varphi0 ) ;
+    cosVarphi0 = std::cos( helix.varphi0 ) ;
+    cosLambda = 1. / std::sqrt( 1. + tanLambda*tanLambda ) ;
+    helix.sinLambda = tanLambda * cosLambda ;
+    helix.w = omega * cosLambda ;
+    return helix ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  HelixIntersectionStatus intersectHelixWithPlane( const HelixCoefficients &helix, const LCPlane3D &plane, double &s ) {
+    // The signed distance to the plane a*x + b*y + c*z + d = 0 along the helix is
+    //   a*xc + b*yc + c*zOffset + d + c*sinLambda*s + R*sqrt(a^2+b^2)*cos( phase - gamma )
+    // with gamma the azimuth of the plane normal
+    const double normalXY = std::sqrt( plane.a()*plane.a() + plane.b()*plane.b() ) ;
+    const double gamma = ( normalXY > 0. ) ? std::atan2( plane.b(), plane.a() ) : 0. ;
+    PhaseFunction distance ;
+    distance.offset = plane.a()*helix.xCentre + plane.b()*helix.yCentre + plane.c()*helix.zOffset + plane.d() ;
+    distance.slope = plane.c() * helix.sinLambda ;
+    distance.amplitude = helix.absRadius * normalXY ;
+    distance.w = helix.w ;
+    distance.sPhase = (helix.varphi0 - gamma) / helix.w ;
+    return firstRoot( distance, 0., DBL_MAX, s ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  bool isAxialCylinder( const LCCylinder &cylinder ) {
+    const LCVector3D axisDirection = cylinder.axisDirection() ;
+    return ( std::fabs( axisDirection.x() ) < 1e-12 and std::fabs( axisDirection.y() ) < 1e-12 ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  HelixIntersectionStatus intersectHelixWithAxialCylinder( const HelixCoefficients &helix, const LCCylinder &cylinder, double &s ) {
+    // the squared distance of the helix to the cylinder axis is D^2 + R^2 + 2*D*R*cos( phase - delta ),
+    // with D and delta the distance and azimuth of the helix centre seen from the cylinder axis
+    s = 0. ;
+    const double zLow = std::min( cylinder.startPoint().z(), cylinder.endPoint().z() ) ;
+    const double zHigh = std::max( cylinder.startPoint().z(), cylinder.endPoint().z() ) ;
+    const double dx = helix.xCentre - cylinder.startPoint().x() ;
+    const double dy = helix.yCentre - cylinder.startPoint().y() ;
+    const double centreDistance = std::sqrt( dx*dx + dy*dy ) ;
+    const double cylinderRadius = cylinder.radius() ;
+    HelixIntersectionStatus status = HelixIntersectionStatus::NoIntersection ;
+    // the tube, between the end planes
+    double sLow = 0., sHigh = DBL_MAX ;
+    if( 0. != helix.sinLambda ) {
+      const double s1 = (zLow - helix.zOffset) / helix.sinLambda ;
+      const double s2 = (zHigh - helix.zOffset) / helix.sinLambda ;
+      sLow = std::max( sLow, std::min( s1, s2 ) ) ;
+      sHigh = std::min( sHigh, std::max( s1, s2 ) ) ;
+    }
+    else if( helix.zOffset < zLow or helix.zOffset > zHigh ) {
+      sHigh = -1. ;
+    }
+    PhaseFunction distance ;
+    distance.offset = centreDistance*centreDistance + helix.absRadius*helix.absRadius - cylinderRadius*cylinderRadius ;
+    distance.slope = 0. ;
+    distance.amplitude = 2. * centreDistance * helix.absRadius ;
+    distance.w = helix.w ;
+    distance.sPhase = (helix.varphi0 - (( centreDistance > 0. ) ? std::atan2( dy, dx ) : 0.)) / helix.w ;
+    double sTube = 0. ;
+    if( HelixIntersectionStatus::Found == firstRoot( distance, sLow, sHigh, sTube ) ) {
+      status = HelixIntersectionStatus::Found ;
+      s = sTube ;
+    }
+    // the end planes
+    if( cylinder.endPlane() and 0. != helix.sinLambda ) {
+      for( const double zPlane : { zLow, zHigh } ) {
+        const double sPlane = (zPlane - helix.zOffset) / helix.sinLambda ;
+        if( sPlane < 0. or ( HelixIntersectionStatus::Found == status and sPlane >= s ) ) {
+          continue ;
+        }
+        const double phase = helix.varphi0 - helix.w * sPlane ;
+        const double px = dx + helix.absRadius * std::cos( phase ) ;
+        const double py = dy + helix.absRadius * std::sin( phase ) ;
+        if( px*px + py*py <= cylinderRadius*cylinderRadius ) {
+          status = HelixIntersectionStatus::Found ;
+          s = sPlane ;
+        }
+      }
+    }
+    return status ;
+  }
+
+}
@@ -1,20 +1,38 @@
 #include <MarlinRecoMT/SimpleHelix.h>
 #include <MarlinRecoMT/LCLine3D.h>
+#include <MarlinRecoMT/HelixCovariance.h>
 
 #include <iostream>
 #include <iomanip>
 #include <cmath>
 #include <float.h>
 #include <exception>
+#include <stdexcept>
+#include <algorithm>
 
 namespace marlinreco_mt {
 
+	namespace {
+
+	  /// Maximum number of Newton iterations in getPathAt()
+	  constexpr unsigned int maxNewtonIterations = 100 ;
+	  /// Path length precision of getPathAt(), relative above 1 mm
+	  constexpr double pathPrecision = 1e-10 ;
+
+	  /// The first value x + n * period >= sMin, n integer
+	  inline double firstAfter( double x, double period, double sMin ) {
+	    return x + period * std::ceil( (sMin - x) / period ) ;
+	  }
+
+	}
+
 	const double SimpleHelix::_a  = 2.99792458E-4;
 	const double SimpleHelix::_pi = M_PI;
 
 	SimpleHelix::SimpleHelix( double d0, double phi0, double omega,
 				  double z0, double tanLambda,
-				  LCVector3D referencePoint, LCErrorMatrix<5>* errors) 
+				  LCVector3D referencePoint, LCErrorMatrix<5>* errors,
+				  double bField) 
 	{
 	  _d0        = d0;
 	  _phi0      = phi0;
@@ -22,298 +40,218 @@ namespace marlinreco_mt {
 	  _z0        = z0;
 	  _tanLambda = tanLambda;
 	  _reference = referencePoint;
+	  _bField    = bField;
 
 	  if( errors != NULL ) {
 	    _errors = *errors;
 	  }
+	  computeCachedParameters() ;
+	}
+
+	void SimpleHelix::computeCachedParameters()
+	{
+	  const HelixCoefficients coefficients = computeHelixCoefficients( _d0, _phi0, _omega, _z0, _tanLambda, _reference,
+	                                                                   _sinVarphi0, _cosVarphi0, _cosLambda ) ;
+	  _xCentre = coefficients.xCentre ;
+	  _yCentre = coefficients.yCentre ;
+	  _zOffset = coefficients.zOffset ;
+	  _absRadius = coefficients.absRadius ;
+	  _varphi0 = coefficients.varphi0 ;
+	  _sinLambda = coefficients.sinLambda ;
+	  _w = coefficients.w ;
+	}
+
+	HelixCoefficients SimpleHelix::getCoefficients() const
+	{
+	  HelixCoefficients coefficients ;
+	  coefficients.xCentre = _xCentre ;
+	  coefficients.yCentre = _yCentre ;
+	  coefficients.zOffset = _zOffset ;
+	  coefficients.absRadius = _absRadius ;
+	  coefficients.varphi0 = _varphi0 ;
+	  coefficients.w = _w ;
+	  coefficients.sinLambda = _sinLambda ;
+	  return coefficients ;
 	}
 
 	double SimpleHelix::getCentreX() const
 	{
-	  return ( _reference.x() + ((1/_omega) - _d0) * sin(_phi0) );
+	  return _xCentre;
 	}
 
 	double SimpleHelix::getCentreY() const
 	{
-	  return ( _reference.y() - ((1/_omega) - _d0) * cos(_phi0) );
+	  return _yCentre;
 	}
 
 	double SimpleHelix::getWindingLength() const
 	{
-	  return 2*_pi*sqrt(1+_tanLambda*_tanLambda)/fabs(_omega);
+	  return 2*_pi/fabs(_w);
 	}
 
-	LCVector3D SimpleHelix::getPosition(double s, LCErrorMatrix<3>* /*errors*/) const
+	LCVector3D SimpleHelix::getPosition(double s, LCErrorMatrix<3>* errors) const
 	{
-	  LCVector3D x;
-
-	  double xc = getCentreX();
-	  double yc = getCentreY();
-
-	  double varphi0 = _phi0 + ((_omega * _pi) / (2*fabs(_omega)));
-	  double w =  _omega / sqrt(1 + _tanLambda*_tanLambda);
-
-	  x.SetX(xc + fabs(1/_omega) * cos( w*s - varphi0 ) );
-	  x.SetY(yc + fabs(1/_omega) * sin( (-w*s) + varphi0) );
-	  x.SetZ(_reference.z() + _z0 + s*_tanLambda/sqrt(1 + _tanLambda*_tanLambda) );
-
-	  return x;
+	  if( errors != NULL ) {
+	    // the position block doesn't depend on the magnetic field
+	    *errors = propagateHelixPositionCovariance( _d0, _phi0, _omega, _tanLambda, s, _errors );
+	  }
+	  // the position on the circle has the phase varphi0 - w*s
+	  const double ws = _w * s ;
+	  const double sinWS = sin(ws) ;
+	  const double cosWS = cos(ws) ;
+	  return LCVector3D( _xCentre + _absRadius * (_cosVarphi0*cosWS + _sinVarphi0*sinWS),
+	                     _yCentre + _absRadius * (_sinVarphi0*cosWS - _cosVarphi0*sinWS),
+	                     _zOffset + s*_sinLambda );
 	}
 
 	LCVector3D SimpleHelix::getDirection(double s,  LCErrorMatrix<3>* /*errors*/) const
 	{
-	  LCVector3D t;
-
-	  double varphi0 = _phi0 + ((_omega * _pi) / (2*fabs(_omega)));
-	  double w =  _omega / sqrt(1 + _tanLambda*_tanLambda);
-
-	  t.SetX(-w*fabs(1/_omega) * sin( (w*s) - varphi0) );
-	  t.SetY(-w*fabs(1/_omega) * cos( (-w*s) + varphi0) );
-	  t.SetZ(_tanLambda/sqrt(1 + _tanLambda*_tanLambda) );
-
-	  return t.unit();
+	  // w * |R| = +-cos(lambda): the direction is a unit vector
+	  const double ws = _w * s ;
+	  const double sinWS = sin(ws) ;
+	  const double cosWS = cos(ws) ;
+	  const double wR = _w * _absRadius ;
+	  return LCVector3D( wR * (_sinVarphi0*cosWS - _cosVarphi0*sinWS),
+	                     -wR * (_cosVarphi0*cosWS + _sinVarphi0*sinWS),
+	                     _sinLambda );
 	}
 
-	LCErrorMatrix<6> SimpleHelix::getCovarianceMatrix( double /*s*/) const
+	LCErrorMatrix<6> SimpleHelix::getCovarianceMatrix( double s) const
 	{
-	  return LCErrorMatrix<6>() ;
+	  if( 0. == _bField ) {
+	    throw std::logic_error( "SimpleHelix::getCovarianceMatrix: the momentum covariance needs the magnetic field, construct the helix with bField" ) ;
+	  }
+	  return propagateHelixCovariance( _d0, _phi0, _omega, _tanLambda, s, _bField, _errors ) ;
 	}
 
 	double SimpleHelix::getPathAt(const LCVector3D position ) const
 	{
-	  double sStart = (position.z() - _reference.z() - _z0)
-	    * sqrt(1 + _tanLambda*_tanLambda) / _tanLambda;
-
-	  if (sStart <= _helixStart) sStart = _helixStart;
-	  if (sStart >= _helixEnd) sStart = _helixEnd;
-
-	  double startRange = sStart - getWindingLength();
-	  double endRange   = sStart + getWindingLength();
-
-	  if (startRange <= _helixStart) startRange = _helixStart;
-	  if (endRange >= _helixEnd) endRange = _helixEnd;
-
-	  ///###  int nSteps = 100;
-	  int nSteps = 10;
-	  double stepWidth = (endRange - startRange)/((double)nSteps);
-
-	  double sOfMin = 0;
-	  double distMinSQ = DBL_MAX;
-	  double s = startRange;
-	  LCVector3D x;
-	  for (int i = 0; i <= nSteps; i++)
-	    {
-	      x = getPosition(s);
-	      double distsq = (x-position).mag2() ;
-	// ###### vector
-	      if (distsq < distMinSQ)
-		{
-		  distMinSQ = distsq;
-		  sOfMin = s;
-		}
-	      s += stepWidth;
+	  // The squared distance to the point is
+	  //   D(s) = R^2 + rho^2 - 2*R*rho*cos( w*(sBeta - s) ) + (zOffset + s*sinLambda - z)^2
+	  // with rho and beta the distance and azimuth of the point seen from the helix centre
+	  // and sBeta the path length where the helix phase is beta. Its minima are close to the
+	  // path lengths sBeta + k*winding length, pulled toward the path length at the point z.
+	  // The two candidates around the point z, brought in the helix range, are refined
+	  // with Newton iterations on D'(s)
+	  const double dx = position.x() - _xCentre ;
+	  const double dy = position.y() - _yCentre ;
+	  const double rho = sqrt( dx*dx + dy*dy ) ;
+	  const double sBeta = (_varphi0 - atan2( dy, dx )) / _w ;
+	  const double sZ = ( 0. != _sinLambda ) ? (position.z() - _zOffset) / _sinLambda : 0. ;
+	  const double windingLength = getWindingLength() ;
+	  // weights of the transverse and longitudinal terms in D''(s)/2
+	  const double transverseWeight = _absRadius * rho * _w * _w ;
+	  const double longitudinalWeight = _sinLambda * _sinLambda ;
+	  const double totalWeight = transverseWeight + longitudinalWeight ;
+	  const double sRange = std::max( _helixStart, std::min( _helixEnd, sZ ) ) ;
+	  const double firstCandidate = firstAfter( sBeta, windingLength, sRange ) - windingLength ;
+
+	  double sOfMin = 0 ;
+	  double distMinSQ = DBL_MAX ;
+	  for( unsigned int c=0 ; c<2 ; ++c ) {
+	    const double sK = firstCandidate + c * windingLength ;
+	    double s = ( totalWeight > 0. ) ? (transverseWeight * sK + longitudinalWeight * sZ) / totalWeight : sK ;
+	    for( unsigned int i=0 ; i<maxNewtonIterations ; ++i ) {
+	      const double phase = _w * (sK - s) ;
+	      const double derivative = -transverseWeight / _w * sin( phase ) + _sinLambda * (_zOffset + s*_sinLambda - position.z()) ;
+	      const double secondDerivative = transverseWeight * cos( phase ) + longitudinalWeight ;
+	      // never move by more than a quarter of turn, in the descent direction
+	      const double maxStep = 0.25 * windingLength ;
+	      double step = ( secondDerivative > 0. ) ? -derivative / secondDerivative : ( derivative > 0. ? -maxStep : maxStep ) ;
+	      step = std::max( -maxStep, std::min( maxStep, step ) ) ;
+	      s += step ;
+	      if( fabs( step ) < pathPrecision * std::max( 1., fabs( s ) ) ) {
+	        break ;
+	      }
 	    }
-
-	  double minStepWidth = 0.000001;
-	  while (stepWidth > minStepWidth)
-	    {
-	      stepWidth /= 10;
-
-	      x = getPosition(sOfMin + stepWidth);
-	      double lp = (x-position).mag2();
-	      x = getPosition(sOfMin - stepWidth);
-	      double lm = (x-position).mag2();
-
-	      double upOrDown = 0;
-	      double lastDistance = 0;
-	      nSteps = 10 ;
-	      if (distMinSQ <= lp && distMinSQ <= lm)
-		{
-		  nSteps = 0 ;
-		  lastDistance = distMinSQ;
-		}
-	      else if (lm<lp)
-		{
-		  upOrDown = -1;
-		  lastDistance = lm;
-		}
-	      else if (lp<lm)
-		{
-		  upOrDown = 1;
-		  lastDistance = lp;
-		}
-	      else
-		{
-		  //	  cout << "Da laeuft was falsch!!! " 
-		  //	       << " distMinSQ " << distMinSQ << " lm " << lm << " lp " << lp << endl;
-		}
-
-	      double step = 0, l = 0, lastStep = sOfMin;
-	      for (int i = 1; i<=nSteps;i++)
-		{
-		  step = sOfMin + (upOrDown*stepWidth*(double)i);
-		  x = getPosition(step);
-		  l = (x-position).mag2();
-		  if (l <= lastDistance) 
-		    {
-		      lastStep = step;
-		      lastDistance = l;
-		    }
-		}
-	      sOfMin = lastStep ;
-	      distMinSQ = lastDistance;
+	    s = std::max( _helixStart, std::min( _helixEnd, s ) ) ;
+	    const double distsq = (getPosition(s) - position).mag2() ;
+	    if( distsq < distMinSQ ) {
+	      distMinSQ = distsq ;
+	      sOfMin = s ;
 	    }
+	  }
 	  return sOfMin;
 	}
 
-	double SimpleHelix::getIntersectionWithPlane( LCPlane3D p, 
+	double SimpleHelix::getIntersectionWithPlane( const LCPlane3D &p,
 						      bool& pointExists) const
 	{
-
-	  // Calculation of the region of s (parameter of Helix), where the helix
-	  // interacts with the plane. This is done by two lines parallel to the 
-	  // axis of the helix (in this parametrisation the z-axis) in the distance 
-	  // of the helix radius. Both lines on opposite sides of the helix. 
-	  // One on the side nearest to the plane, the other exactly on the 
-	  // other side, away from the plane with respect to the Origen.
-
-	  LCVector3D helixCentre( getCentreX(), getCentreY(), 0.);
-	  LCVector3D normalXY = p.normal();
-	  normalXY.SetZ(0.);
-	  // If plane is perpendicular to helix axis, set normalXY to a value
-	  // perpendicular to the helix axis to enable intersection calculation.
-	  if (normalXY.x() == 0. && normalXY.y() == 0. ) normalXY.SetXYZ(1.,0.,0.);
-	  normalXY = ( normalXY.unit() )/_omega;
-	  LCVector3D lineDirection(0.,0.,1.);
-
-	  LCLine3D frontLine( (helixCentre + normalXY) , lineDirection);
-	  LCLine3D backLine( (helixCentre - normalXY) , lineDirection);
-	  bool parallelBack, parallelFront;
-	  double zStart = ( frontLine.position( frontLine.intersectionWithPlane(p,parallelFront) ) ).z();
-	  double zEnd = ( backLine.position( backLine.intersectionWithPlane(p,parallelBack) ) ).z();
-	  if ( !(parallelBack && parallelFront) )
-	    { // plane is parallel to helix axis
-	      if ( fabs( p.distance(helixCentre) ) > (1/_omega) )
-		{ // Helix never hits plane!
-		  pointExists = false ;
-		  return 0;
-		}
-	      else
-		{
-		  pointExists = true ;
-		  zStart = -DBL_MAX ;
-		  zEnd   =  DBL_MAX ;
-		}
-	    }
-
-	  double sStart = ( zStart - _reference.z() - _z0)
-	    * sqrt(1 + _tanLambda*_tanLambda) / _tanLambda;
-	  double sEnd = ( zEnd - _reference.z() - _z0)
-	    * sqrt(1 + _tanLambda*_tanLambda) / _tanLambda;
-
-	  if (sStart > sEnd)
-	    { // rong order for Start and Endpoint
-	      double temp = sEnd;
-	      sEnd = sStart;
-	      sStart = temp;
-	    }
-
-	  // produce an artificial gap between sStart and sEnd
-	  if (sStart > -DBL_MAX && sStart < DBL_MAX ) sStart -= 0.00001;
-	  if (sEnd > -DBL_MAX && sEnd < DBL_MAX ) sEnd += 0.00001;
-
-	  if ( (sStart < 0.) && (sEnd < 0.) )
-	    { // Intersection is in backwards direction
-	      pointExists = false ;
-	      return 0;
-	    }
-	  else if ( (sStart < 0.) && (sEnd > 0.) )
-	    { // intersection region starts in backwards direction
-	      sStart = 0;
-	    }
-
-	  double s = sStart, sOld = -DBL_MAX; 
-	  double epsilon = 0.0000001;
-
-	  while ( (s-sOld) > epsilon )
-	    {
-	      double d = fabs( p.distance( getPosition(s) ) ) ;
-	      sOld = s;
-	      s += d;
-	      if (s > sEnd)
-		{ // Problem! no intersection !
-		  std::cout << "ERROR: No intersection found!!!" << std::endl;
-		  pointExists = false ;
-		  return 0;
-		}
-	    }
-
-	  pointExists = true ;
+	  double s = 0 ;
+	  pointExists = ( IntersectionStatus::Found == intersectWithPlane( p, s ) ) ;
 	  return s ;
 	}
 
 	double SimpleHelix::getIntersectionWithCylinder(const LCCylinder & cylinder,
-							bool & pointExists) const  
+							bool & pointExists) const
+	{
+	  double s = 0 ;
+	  pointExists = ( IntersectionStatus::Found == intersectWithCylinder( cylinder, s ) ) ;
+	  return s ;
+	}
+
+	SimpleHelix::IntersectionStatus SimpleHelix::intersectWithPlane( const LCPlane3D &plane, double &s ) const
 	{
+	  return intersectHelixWithPlane( getCoefficients(), plane, s ) ;
+	}
+
+	SimpleHelix::IntersectionStatus SimpleHelix::intersectWithCylinder( const LCCylinder &cylinder, double &s ) const
+	{
+	  if( isAxialCylinder( cylinder ) ) {
+	    return intersectHelixWithAxialCylinder( getCoefficients(), cylinder, s ) ;
+	  }
+	  s = 0 ;
+	  // arbitrary cylinder orientation: step along the helix by the distance to the
+	  // cylinder, in the path length range where the helix is close to the cylinder
 	  LCVector3D helixCentre( getCentreX(), getCentreY(), 0.);
-	  LCVector3D axisDirection(0.,0.,1.);
-	  LCLine3D axisLine(helixCentre , axisDirection);
+	  LCVector3D axisDirectionZ(0.,0.,1.);
+	  LCLine3D axisLine(helixCentre , axisDirectionZ);
 
 	  LCVector3D middlePoint =
 	    (cylinder.startPoint() + cylinder.endPoint())/2.;
 	  double minDistance = sqrt( 0.25*cylinder.length()*cylinder.length()
-	                             + cylinder.radius()*cylinder.radius() ); 
-	                              
+	                             + cylinder.radius()*cylinder.radius() );
 
-	  if ( axisLine.distance(middlePoint) > (minDistance+getRadius()) )
+	  if ( axisLine.distance(middlePoint) > (minDistance+_absRadius) )
 	    {
-	      pointExists = false ;
-	      return 0 ;
+	      return IntersectionStatus::NoIntersection ;
 	    }
 
 	  double sProject = axisLine.projectPoint(middlePoint);
-	  double sStart = sProject - minDistance ;
-	  double sEnd   = sProject + minDistance ;
-
-	  double sHelixStart = ( (axisLine.position(sStart)).z() - _reference.z() - _z0)
-	    * sqrt(1 + _tanLambda*_tanLambda) / _tanLambda;
-	  double sHelixEnd = ( (axisLine.position(sEnd)).z() - _reference.z() - _z0)
-	    * sqrt(1 + _tanLambda*_tanLambda) / _tanLambda;
+	  double sHelixStart = ( (axisLine.position(sProject - minDistance)).z() - _zOffset) / _sinLambda;
+	  double sHelixEnd = ( (axisLine.position(sProject + minDistance)).z() - _zOffset) / _sinLambda;
 
 	  if (sHelixStart > sHelixEnd)
 	    {
-	      double temp = sHelixStart;
-	      sHelixStart = sHelixEnd;
-	      sHelixEnd = temp;
+	      std::swap( sHelixStart, sHelixEnd ) ;
 	    }
 
 	  if ( (sHelixStart < 0.) && (sHelixEnd < 0.) )
 	    { // Intersection is in backwards direction
-	      pointExists = false ;
-	      return 0;
+	      return IntersectionStatus::NoIntersection ;
 	    }
 	  else if ( (sHelixStart < 0.) && (sHelixEnd > 0.) )
 	    { // intersection region starts in backwards direction
 	      sHelixStart = 0;
 	    }
 
-	  double s = sHelixStart, sOld = -DBL_MAX;
-	  double epsilon = 0.0000001;
-
-	  while ( (s-sOld) > epsilon )
+	  constexpr unsigned int maxSteps = 10000 ;
+	  double sStep = sHelixStart ;
+	  for( unsigned int i=0 ; i<maxSteps ; ++i )
 	    {
-	      double d = fabs( cylinder.distance( getPosition(s) ) ) ;
-	      sOld = s;
-	      if (s > sHelixEnd)
-	        { // Problem! no intersection !
-	          pointExists = false ;
-	          return 0;
+	      if (sStep > sHelixEnd)
+	        { // no intersection
+	          return IntersectionStatus::NoIntersection ;
+	        }
+	      double d = fabs( cylinder.distance( getPosition(sStep) ) ) ;
+	      sStep += d;
+	      if ( d < 0.0000001 )
+	        {
+	          s = sStep ;
+	          return IntersectionStatus::Found ;
 	        }
-	      s += d;
 	    }
-
-	  pointExists = true ;
-	  return s ;
+	  return IntersectionStatus::NotConverged ;
 	}
 
 	double SimpleHelix::getStart() const
@@ -0,0 +1,68 @@
+#ifndef MARLINRECOMT_UNITTEST_h
+#define MARLINRECOMT_UNITTEST_h 1
+
+// -- std headers
+#include <iostream>
+#include <string>
+
+namespace marlinreco_mt {
+
+  namespace test {
+
+    /** Minimal unit test helper: counts the failed checks and provides the exit code
+     *  of the test executable. Example usage: <br>
+     *  <pre>
+     *     int main() {
+     *       UnitTest test( "testSomething" ) ;
+     *       test.check( 1+1 == 2, "addition" ) ;
+     *       return test.status() ;
+     *     }
+     *  </pre>
+     */
+    class UnitTest {
+    public:
+      UnitTest( const UnitTest& ) = delete ;
+      UnitTest& operator=( const UnitTest& ) = delete ;
+
+      /** Constructor
+       *  @param name the test name, printed with the check results
+       */
+      UnitTest( const std::string &name ) :
+        _name( name ) {
+        std::cout << "[" << _name << "] start" << std::endl ;
+      }
+
+      /** Record a check, printing a message if it failed
+       *  @param condition the check result
+       *  @param message the check description
+       */
+      bool check( bool condition, const std::string &message ) {
+        ++_nChecks ;
+        if( not condition ) {
+          ++_nFailed ;
+          std::cout << "[" << _name << "] FAILED: " << message << std::endl ;
+        }
+        return condition ;
+      }
+
+      /** The exit code of the test: 0 if all the checks passed, print a summary
+       */
+      int status() const {
+        std::cout << "[" << _name << "] " << _nChecks - _nFailed << "/" << _nChecks << " checks passed" << std::endl ;
+        return ( 0 == _nFailed ) ? 0 : 1 ;
+      }
+
+    private:
+      /// The test name
+      std::string       _name {} ;
+      /// The number of checks
+      unsigned int      _nChecks {0} ;
+      /// The number of failed checks
+      unsigned int      _nFailed {0} ;
+    };
+
+  }
+
+}
+
+#endif
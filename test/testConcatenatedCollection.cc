@@ -0,0 +1,88 @@
+// -- marlinreco headers
+#include <MarlinRecoMT/ConcatenatedCollection.h>
+
+// -- lcio headers
+#include <EVENT/LCIO.h>
+#include <IMPL/CalorimeterHitImpl.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCEventImpl.h>
+#include <IO/LCReader.h>
+#include <IO/LCWriter.h>
+#include <IOIMPL/LCFactory.h>
+
+// -- std headers
+#include <cstdio>
+#include <memory>
+#include <string>
+
+// -- unit test headers
+#include <UnitTest.h>
+
+using namespace marlinreco_mt ;
+
+namespace {
+
+  /// Create a calorimeter hit collection with n hits of increasing energy
+  IMPL::LCCollectionVec *createHits( int n, float firstEnergy ) {
+    auto collection = new IMPL::LCCollectionVec( EVENT::LCIO::CALORIMETERHIT ) ;
+    for( int i=0 ; i<n ; ++i ) {
+      auto hit = new IMPL::CalorimeterHitImpl() ;
+      hit->setEnergy( firstEnergy + i ) ;
+      collection->addElement( hit ) ;
+    }
+    return collection ;
+  }
+
+}
+
+int main() {
+  test::UnitTest test( "testConcatenatedCollection" ) ;
+  const std::string fileName = "testConcatenatedCollection.slcio" ;
+
+  // write an event with two hit collections and a view on both
+  {
+    IMPL::LCEventImpl event ;
+    event.setRunNumber( 0 ) ;
+    event.setEventNumber( 0 ) ;
+    auto hits1 = createHits( 3, 0.f ) ;
+    auto hits2 = createHits( 4, 100.f ) ;
+    event.addCollection( hits1, "Hits1" ) ;
+    event.addCollection( hits2, "Hits2" ) ;
+    auto view = new ConcatenatedCollection() ;
+    view->addCollection( "Hits1", hits1 ) ;
+    view->addCollection( "Hits2", hits2 ) ;
+    view->setFlag( 0 ) ;
+    event.addCollection( view, "AllHits" ) ;
+    test.check( view->isSubset(), "view is a subset" ) ;
+    test.check( view->getFlag() & ( 1 << EVENT::LCCollection::BITSubset ), "subset bit set in the view flag" ) ;
+    test.check( view->getNumberOfElements() == 7, "view element count" ) ;
+    test.check( view->getElementAt( 3 ) == hits2->getElementAt( 0 ), "view element from the second collection" ) ;
+    std::unique_ptr<IO::LCWriter> writer( IOIMPL::LCFactory::getInstance()->createLCWriter() ) ;
+    writer->open( fileName, EVENT::LCIO::WRITE_NEW ) ;
+    writer->writeEvent( &event ) ;
+    writer->close() ;
+  }
+
+  // read it back: the view must come back as a subset of the read hits, not as new hits
+  {
+    std::unique_ptr<IO::LCReader> reader( IOIMPL::LCFactory::getInstance()->createLCReader() ) ;
+    reader->open( fileName ) ;
+    EVENT::LCEvent *event = reader->readNextEvent() ;
+    if( test.check( nullptr != event, "event read back" ) ) {
+      const EVENT::LCCollection *hits1 = event->getCollection( "Hits1" ) ;
+      const EVENT::LCCollection *hits2 = event->getCollection( "Hits2" ) ;
+      const EVENT::LCCollection *allHits = event->getCollection( "AllHits" ) ;
+      test.check( allHits->isSubset(), "read view is a subset" ) ;
+      test.check( allHits->getTypeName() == EVENT::LCIO::CALORIMETERHIT, "read view type" ) ;
+      if( test.check( allHits->getNumberOfElements() == 7, "read view element count" ) ) {
+        for( int i=0 ; i<7 ; ++i ) {
+          const EVENT::LCObject *expected = ( i < 3 ) ? hits1->getElementAt( i ) : hits2->getElementAt( i-3 ) ;
+          test.check( allHits->getElementAt( i ) == expected, "read view element " + std::to_string( i ) + " points to the read hit" ) ;
+        }
+      }
+    }
+    reader->close() ;
+  }
+  std::remove( fileName.c_str() ) ;
+  return test.status() ;
+}
@@ -0,0 +1,55 @@
+// -- marlinreco headers
+#include <MarlinRecoMT/EventArena.h>
+
+// -- lcio headers
+#include <EVENT/LCIO.h>
+#include <IMPL/CalorimeterHitImpl.h>
+#include <IMPL/LCCollectionVec.h>
+#include <IMPL/LCRelationImpl.h>
+
+// -- std headers
+#include <memory>
+#include <string>
+#include <thread>
+
+// -- unit test headers
+#include <UnitTest.h>
+
+using namespace marlinreco_mt ;
+
+int main() {
+  test::UnitTest test( "testEventArena" ) ;
+  const int nHits = 1000 ;
+
+  for( const std::size_t capacity : { std::size_t(0), std::size_t(100), std::size_t(nHits) } ) {
+    const std::string id = "capacity " + std::to_string( capacity ) + ": " ;
+    auto hits = std::make_unique<IMPL::LCCollectionVec>( EVENT::LCIO::CALORIMETERHIT ) ;
+    auto relations = std::make_unique<IMPL::LCCollectionVec>( EVENT::LCIO::LCRELATION ) ;
+    // the arena is local to the event processing, the objects outlive it
+    {
+      EventArena<IMPL::CalorimeterHitImpl> hitArena( capacity ) ;
+      EventArena<IMPL::LCRelationImpl> relationArena( capacity ) ;
+      for( int i=0 ; i<nHits ; ++i ) {
+        auto hit = hitArena.create() ;
+        hit->setEnergy( i ) ;
+        hit->setCellID0( i ) ;
+        hits->addElement( hit ) ;
+        relations->addElement( relationArena.create( hit, nullptr, 0.5f ) ) ;
+      }
+    }
+    bool valid = true ;
+    for( int i=0 ; i<nHits ; ++i ) {
+      auto hit = static_cast<const EVENT::CalorimeterHit*>( hits->getElementAt( i ) ) ;
+      auto relation = static_cast<const EVENT::LCRelation*>( relations->getElementAt( i ) ) ;
+      valid = valid && hit->getEnergy() == i && hit->getCellID0() == i && relation->getFrom() == hit && relation->getWeight() == 0.5f ;
+    }
+    test.check( valid, id + "objects created in the arena" ) ;
+    // the event may be deleted by another thread, with the buffers shared by both collections
+    std::thread hitThread( [&hits](){ hits.reset() ; } ) ;
+    std::thread relationThread( [&relations](){ relations.reset() ; } ) ;
+    hitThread.join() ;
+    relationThread.join() ;
+    test.check( nullptr == hits && nullptr == relations, id + "collections deleted by other threads" ) ;
+  }
+  return test.status() ;
+}
@@ -0,0 +1,211 @@
+// -- marlinreco headers
+#include <MarlinRecoMT/FixedPadSizeDiskLayout.h>
+
+// -- dd4hep headers
+#include <DD4hep/DD4hepUnits.h>
+#include <DDRec/DetectorData.h>
+
+// -- std headers
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// -- unit test headers
+#include <UnitTest.h>
+
+using namespace marlinreco_mt ;
+
+namespace {
+
+  /** The original full circle FixedPadSizeDiskLayout: pad tables built per row in
+   *  nested vectors and pads located with the wrapping loops and floor() calls
+   */
+  class ReferenceLayout {
+  public:
+    struct Row {
+      int NPad {} ;
+      double RCenter {} ;
+      double PhiPad {} ;
+    };
+
+    ReferenceLayout( const dd4hep::rec::FixedPadSizeTPCData &tpc ) :
+      _rMin( tpc.rMinReadout/dd4hep::mm ),
+      _rMax( tpc.rMaxReadout/dd4hep::mm ),
+      _padWidth( tpc.padWidth/dd4hep::mm ),
+      _padHeight( tpc.padHeight/dd4hep::mm ),
+      _padGap( tpc.padGap/dd4hep::mm ),
+      _nRow( tpc.maxRow ) {
+      int nr = ( ( _rMax + 0.01  - _rMin ) /  _padHeight ) ;
+      _nRow = ( _nRow > 0 ) ? _nRow : nr ;
+      if( _nRow > nr ) {
+        _nRow = nr ;
+      }
+      _rowHeight = ( _rMax - _rMin ) / _nRow ;
+      for( int i = 0 ; i < _nRow ; i++ ) {
+        Row row ;
+        row.RCenter = _rMin + ( i * _rowHeight ) + .5 * _rowHeight ;
+        double u = row.RCenter * _phiMax ;
+        row.NPad = static_cast<int>( std::floor( u / ( _padWidth + _padGap ) ) ) ;
+        row.PhiPad = _phiMax / row.NPad ;
+        _rows.push_back( row ) ;
+      }
+      _padIndices.resize( _nRow ) ;
+      for( int i = 0 ; i < _nRow ; i++ ) {
+        for( int j = 0 ; j < _rows[i].NPad ; j++ ) {
+          _padIndices[i].push_back( ( i << 16 ) | ( 0x0000ffff & j ) ) ;
+        }
+      }
+    }
+
+    int getNearestPad( double r, double phi ) const {
+      if( std::fabs( r ) < 1e-6 ) {
+        throw std::runtime_error( "ReferenceLayout::getNearestPad: r can't be zero !" ) ;
+      }
+      while( phi < 0       ) {  phi += 2. * M_PI  ; }
+      while( phi > 2.*M_PI ) {  phi -= 2. * M_PI  ; }
+      int rowNum = 0 ;
+      int padNum = 0 ;
+      if ( r > 0. && phi >= 0. && phi <= _phiMax ) {
+        rowNum = r < _rMin ? 0 : (int) std::floor( ( r - _rMin ) / _rowHeight  ) ;
+        if( rowNum >= _nRow  )
+          rowNum = _nRow -1 ;
+        padNum = (int) std::floor( phi / _rows[ rowNum ].PhiPad ) ;
+        if( padNum >=  _rows[ rowNum ].NPad  )
+          padNum = _rows[ rowNum ].NPad  - 1 ;
+      }
+      return ( rowNum << 16 ) | ( 0x0000ffff & padNum ) ;
+    }
+
+    double _rMin {} ;
+    double _rMax {} ;
+    double _phiMax { 2.*M_PI } ;
+    double _rowHeight {} ;
+    double _padWidth {} ;
+    double _padHeight {} ;
+    double _padGap {} ;
+    int _nRow {} ;
+    std::vector<Row> _rows {} ;
+    std::vector<std::vector<int>> _padIndices {} ;
+  };
+
+  //--------------------------------------------------------------------------
+
+  /// The test points: a grid crossing all the row and pad boundaries, the exact
+  /// boundaries, multiples of 2pi and random points up to ten turns away
+  void testPoints( const ReferenceLayout &reference, std::vector<double> &rs, std::vector<double> &phis ) {
+    std::vector<double> radii ;
+    for( double r = reference._rMin - 20. ; r < reference._rMax + 20. ; r += 0.37 ) {
+      radii.push_back( r ) ;
+    }
+    for( int i = 0 ; i <= reference._nRow ; i++ ) {
+      radii.push_back( reference._rMin + i * reference._rowHeight ) ;
+    }
+    radii.push_back( -10. ) ;
+    radii.push_back( 1.e-3 ) ;
+    std::vector<double> angles ;
+    for( int k = -12 ; k <= 12 ; k++ ) {
+      angles.push_back( k * M_PI ) ;
+      angles.push_back( std::nextafter( k * M_PI, 0. ) ) ;
+    }
+    for( double phi = -2.*M_PI ; phi < 4.*M_PI ; phi += 0.0123 ) {
+      angles.push_back( phi ) ;
+    }
+    for( const double r : radii ) {
+      for( const double phi : angles ) {
+        rs.push_back( r ) ;
+        phis.push_back( phi ) ;
+      }
+    }
+    // the pad boundaries of every row
+    for( const auto &row : reference._rows ) {
+      for( int j = 0 ; j <= row.NPad ; j++ ) {
+        rs.push_back( row.RCenter ) ;
+        phis.push_back( j * row.PhiPad ) ;
+      }
+    }
+    std::mt19937 generator( 4321 ) ;
+    std::uniform_real_distribution<double> uniform( 0., 1. ) ;
+    for( int i = 0 ; i < 100000 ; i++ ) {
+      rs.push_back( reference._rMin - 10. + ( reference._rMax - reference._rMin + 20. ) * uniform( generator ) ) ;
+      phis.push_back( 20. * M_PI * ( uniform( generator ) - 0.5 ) ) ;
+    }
+  }
+
+}
+
+int main() {
+  test::UnitTest test( "testFixedPadSizeDiskLayout" ) ;
+
+  // the ILD TPC and a layout with a pad gap and a limited number of rows
+  std::vector<dd4hep::rec::FixedPadSizeTPCData> tpcs( 2 ) ;
+  tpcs[0].rMinReadout = 351.*dd4hep::mm ;
+  tpcs[0].rMaxReadout = 1764.*dd4hep::mm ;
+  tpcs[0].padHeight = 6.*dd4hep::mm ;
+  tpcs[0].padWidth = 1.*dd4hep::mm ;
+  tpcs[0].padGap = 0. ;
+  tpcs[0].maxRow = 220 ;
+  tpcs[1].rMinReadout = 100.*dd4hep::mm ;
+  tpcs[1].rMaxReadout = 500.*dd4hep::mm ;
+  tpcs[1].padHeight = 7.3*dd4hep::mm ;
+  tpcs[1].padWidth = 2.1*dd4hep::mm ;
+  tpcs[1].padGap = 0.2*dd4hep::mm ;
+  tpcs[1].maxRow = 40 ;
+
+  for( std::size_t t = 0 ; t < tpcs.size() ; t++ ) {
+    const std::string id = "layout " + std::to_string( t ) + ": " ;
+    const FixedPadSizeDiskLayout layout( &tpcs[t] ) ;
+    const ReferenceLayout reference( tpcs[t] ) ;
+    if( not test.check( layout.getNRows() == reference._nRow, id + "number of rows" ) ) {
+      continue ;
+    }
+
+    // the contiguous pad index table against the nested vectors, pad by pad
+    bool sameRows = true ;
+    int nPads = 0 ;
+    for( int i = 0 ; i < reference._nRow ; i++ ) {
+      const auto pads = layout.getPadsInRow( i ) ;
+      const auto &expected = reference._padIndices[i] ;
+      sameRows = sameRows && pads.size() == expected.size() ;
+      for( std::size_t j = 0 ; sameRows && j < expected.size() ; j++ ) {
+        sameRows = pads[j] == expected[j] && layout.getPadIndex( i, j ) == expected[j]
+          && layout.getRowNumber( pads[j] ) == i && layout.getPadNumber( pads[j] ) == int(j) ;
+      }
+      nPads += expected.size() ;
+    }
+    test.check( sameRows, id + "pads in rows" ) ;
+    test.check( layout.getNPads() == nPads, id + "number of pads" ) ;
+    test.check( layout.getPadsInRow( -1 ).empty() && layout.getPadsInRow( reference._nRow ).empty(), id + "no pads outside the rows" ) ;
+
+    // the nearest pads against the original scalar implementation
+    std::vector<double> rs, phis ;
+    testPoints( reference, rs, phis ) ;
+    std::vector<int> padIndices( rs.size() ) ;
+    layout.getNearestPads( rs, phis, padIndices ) ;
+    int nScalarDiffs = 0 ;
+    int nBatchDiffs = 0 ;
+    for( std::size_t i = 0 ; i < rs.size() ; i++ ) {
+      const int expected = reference.getNearestPad( rs[i], phis[i] ) ;
+      if( layout.getNearestPad( rs[i], phis[i] ) != expected ) {
+        if( 0 == nScalarDiffs++ ) {
+          test.check( false, id + "getNearestPad( " + std::to_string( rs[i] ) + ", " + std::to_string( phis[i] ) + " )" ) ;
+        }
+      }
+      if( padIndices[i] != expected ) {
+        if( 0 == nBatchDiffs++ ) {
+          test.check( false, id + "getNearestPads( " + std::to_string( rs[i] ) + ", " + std::to_string( phis[i] ) + " )" ) ;
+        }
+      }
+    }
+    test.check( 0 == nScalarDiffs, id + "getNearestPad() as the original, " + std::to_string( nScalarDiffs ) + " differences in " + std::to_string( rs.size() ) + " points" ) ;
+    test.check( 0 == nBatchDiffs, id + "getNearestPads() as the original, " + std::to_string( nBatchDiffs ) + " differences in " + std::to_string( rs.size() ) + " points" ) ;
+
+    // the positive multiples of 2pi stay in the last pad, as with the original loops
+    const double rowCenter = reference._rows[0].RCenter ;
+    const int lastPad = layout.getPadIndex( 0, reference._rows[0].NPad - 1 ) ;
+    test.check( layout.getNearestPad( rowCenter, 2.*M_PI ) == lastPad && layout.getNearestPad( rowCenter, 6.*M_PI ) == lastPad, id + "2pi multiples in the last pad" ) ;
+    test.check( layout.getNearestPad( rowCenter, -6.*M_PI ) == layout.getPadIndex( 0, 0 ), id + "negative 2pi multiples in the first pad" ) ;
+  }
+  return test.status() ;
+}
@@ -0,0 +1,230 @@
+// -- marlinreco headers
+#include <MarlinRecoMT/GeometrySnapshot.h>
+
+// -- dd4hep headers
+#include <DD4hep/DD4hepUnits.h>
+#include <DD4hep/DetType.h>
+#include <DD4hep/Detector.h>
+#include <DDRec/DetectorData.h>
+#include <DDRec/Surface.h>
+#include <DDRec/SurfaceManager.h>
+
+// -- std headers
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <memory>
+#include <string>
+
+// -- unit test headers
+#include <UnitTest.h>
+
+using namespace marlinreco_mt ;
+
+namespace {
+
+  /// Whether two vectors are identical. The cache file stores the raw doubles
+  bool sameVector( const dd4hep::rec::Vector3D &lhs, const dd4hep::rec::Vector3D &rhs ) {
+    return lhs.x() == rhs.x() && lhs.y() == rhs.y() && lhs.z() == rhs.z() ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  /// Attach the DDRec surfaces and data of the test geometry, as the detector drivers would
+  void addTestData( dd4hep::Detector &detector ) {
+    // one sensitive plane in the middle of the tracker box
+    dd4hep::DetElement tracker = detector.detector( "TestTracker" ) ;
+    dd4hep::rec::VolPlane plane( tracker.volume(), dd4hep::rec::SurfaceType( dd4hep::rec::SurfaceType::Sensitive ),
+      0.15*dd4hep::mm, 0.15*dd4hep::mm,
+      dd4hep::rec::Vector3D( 1., 0., 0. ), dd4hep::rec::Vector3D( 0., 1., 0. ), dd4hep::rec::Vector3D( 0., 0., 1. ) ) ;
+    dd4hep::rec::volSurfaceList( tracker )->push_back( plane ) ;
+    detector.addExtension<dd4hep::rec::SurfaceManager>( new dd4hep::rec::SurfaceManager( detector ) ) ;
+    // disk petals and TPC data on the tracker, layered calorimeter data on the calorimeter
+    auto petals = new dd4hep::rec::ZDiskPetalsData() ;
+    petals->widthStrip = 0.01*dd4hep::mm ;
+    petals->lengthStrip = 50.*dd4hep::mm ;
+    petals->pitchStrip = 0.05*dd4hep::mm ;
+    petals->angleStrip = 0.1 ;
+    for( int l=0 ; l<3 ; ++l ) {
+      dd4hep::rec::ZDiskPetalsData::LayerLayout layer ;
+      layer.zPosition = ( 200. + 100.*l )*dd4hep::mm ;
+      layer.phi0 = 0.1*l ;
+      layer.petalHalfAngle = 0.15 ;
+      layer.petalNumber = 16 ;
+      layer.sensorsPerPetal = 2 + 2*l ;
+      petals->layers.push_back( layer ) ;
+    }
+    tracker.addExtension<dd4hep::rec::ZDiskPetalsData>( petals ) ;
+    auto tpc = new dd4hep::rec::FixedPadSizeTPCData() ;
+    tpc->zHalf = 2350.*dd4hep::mm ;
+    tpc->rMin = 329.*dd4hep::mm ;
+    tpc->rMax = 1808.*dd4hep::mm ;
+    tpc->driftLength = 2225.*dd4hep::mm ;
+    tpc->rMinReadout = 350.*dd4hep::mm ;
+    tpc->rMaxReadout = 1790.*dd4hep::mm ;
+    tpc->padHeight = 6.*dd4hep::mm ;
+    tpc->padWidth = 1.*dd4hep::mm ;
+    tpc->maxRow = 220 ;
+    tpc->padGap = 0. ;
+    tracker.addExtension<dd4hep::rec::FixedPadSizeTPCData>( tpc ) ;
+    dd4hep::DetElement calorimeter = detector.detector( "TestCalorimeter" ) ;
+    calorimeter.setTypeFlag( dd4hep::DetType::CALORIMETER | dd4hep::DetType::ELECTROMAGNETIC | dd4hep::DetType::ENDCAP ) ;
+    auto caloData = new dd4hep::rec::LayeredCalorimeterData() ;
+    caloData->layoutType = dd4hep::rec::LayeredCalorimeterData::EndcapLayout ;
+    const double extent[6] = { 10.*dd4hep::mm, 100.*dd4hep::mm, 250.*dd4hep::mm, 350.*dd4hep::mm, 0., 0. } ;
+    std::copy( std::begin( extent ), std::end( extent ), std::begin( caloData->extent ) ) ;
+    caloData->inner_symmetry = 4 ;
+    caloData->outer_symmetry = 8 ;
+    caloData->inner_phi0 = 0.25 ;
+    caloData->outer_phi0 = 0.5 ;
+    for( int l=0 ; l<5 ; ++l ) {
+      dd4hep::rec::LayeredCalorimeterData::Layer layer ;
+      layer.distance = ( 250. + 20.*l )*dd4hep::mm ;
+      layer.phi0 = 0.01*l ;
+      layer.absorberThickness = 2.1*dd4hep::mm ;
+      layer.sensitive_thickness = 0.5*dd4hep::mm ;
+      layer.cellSize0 = 5.1*dd4hep::mm ;
+      layer.cellSize1 = 5.2*dd4hep::mm ;
+      caloData->layers.push_back( layer ) ;
+    }
+    calorimeter.addExtension<dd4hep::rec::LayeredCalorimeterData>( caloData ) ;
+  }
+
+  //--------------------------------------------------------------------------
+
+  /// Compare the surfaces of a detector, including the bounds on a grid of points
+  /// around the 100x40 mm tracker plane, inside and off the plane
+  void compareSurfaces( test::UnitTest &test, const SurfaceTable &extracted, const SurfaceTable &read ) {
+    if( not test.check( extracted.cellIDs() == read.cellIDs(), "surface cellIDs" ) ) {
+      return ;
+    }
+    for( const auto cellID : extracted.cellIDs() ) {
+      const SurfaceData *lhs = extracted.find( cellID ) ;
+      const SurfaceData *rhs = read.find( cellID ) ;
+      const std::string id = "surface " + std::to_string( cellID ) + ": " ;
+      test.check( nullptr == rhs->_surface, id + "no DDRec surface after reading" ) ;
+      test.check( lhs->_isPlane == rhs->_isPlane, id + "isPlane" ) ;
+      test.check( sameVector( lhs->_origin, rhs->_origin ), id + "origin" ) ;
+      test.check( sameVector( lhs->_u, rhs->_u ), id + "u" ) ;
+      test.check( sameVector( lhs->_v, rhs->_v ), id + "v" ) ;
+      test.check( sameVector( lhs->_normal, rhs->_normal ), id + "normal" ) ;
+      test.check( lhs->_uDirection == rhs->_uDirection, id + "u direction" ) ;
+      test.check( lhs->_vDirection == rhs->_vDirection, id + "v direction" ) ;
+      test.check( lhs->_lengthAlongU == rhs->_lengthAlongU, id + "length along u" ) ;
+      test.check( lhs->_lengthAlongV == rhs->_lengthAlongV, id + "length along v" ) ;
+      if( not test.check( rhs->hasBounds(), id + "bounds written for a box volume" ) ) {
+        continue ;
+      }
+      // the grid avoids the box edges at u = +-50 mm and v = +-20 mm
+      for( int i=0 ; i<18 ; ++i ) {
+        for( int j=0 ; j<16 ; ++j ) {
+          const double u = ( -61. + 7.*i )*dd4hep::mm ;
+          const double v = ( -26. + 3.5*j )*dd4hep::mm ;
+          const bool expected = std::fabs( u ) < 50.*dd4hep::mm && std::fabs( v ) < 20.*dd4hep::mm ;
+          const auto onPlane = lhs->localToGlobal( dd4hep::rec::Vector2D( u, v ) ) ;
+          const auto offPlane = onPlane + 1.*dd4hep::mm * lhs->_normal ;
+          const std::string point = id + "point (" + std::to_string( u ) + "," + std::to_string( v ) + ") " ;
+          test.check( lhs->insideBounds( onPlane ) == expected, point + "DDRec bounds" ) ;
+          test.check( rhs->insideBounds( onPlane ) == expected, point + "cached bounds" ) ;
+          test.check( not rhs->insideBounds( offPlane ), point + "cached bounds off the plane" ) ;
+        }
+      }
+    }
+  }
+
+}
+
+int main( int argc, char **argv ) {
+  test::UnitTest test( "testGeometrySnapshot" ) ;
+  if( not test.check( argc > 1, "usage: testGeometrySnapshot <compact file>" ) ) {
+    return test.status() ;
+  }
+  const std::string compactFile = argv[1] ;
+  const std::string cacheFile = "testGeometrySnapshot.cache" ;
+
+  // extract
+  dd4hep::Detector &detector = dd4hep::Detector::getInstance() ;
+  detector.fromCompact( compactFile ) ;
+  addTestData( detector ) ;
+  const GeometrySnapshot extracted( detector ) ;
+  const SurfaceTable *extractedSurfaces = extracted.surfaces( "TestTracker" ) ;
+  if( not test.check( nullptr != extractedSurfaces && 1 == extractedSurfaces->size(), "one tracker surface extracted" )
+    || not test.check( nullptr != extracted.calorimeter( "TestCalorimeter" ), "calorimeter extracted" )
+    || not test.check( nullptr != extracted.zDiskPetals( "TestTracker" ), "petals extracted" )
+    || not test.check( nullptr != extracted.fixedPadSizeTPC( "TestTracker" ), "TPC extracted" ) ) {
+    return test.status() ;
+  }
+
+  // write, read
+  const auto hash = GeometrySnapshot::geometryHash( compactFile ) ;
+  test.check( extracted.write( cacheFile, hash ), "cache file written" ) ;
+  test.check( nullptr == GeometrySnapshot::read( cacheFile, hash + 1 ), "cache file with another hash ignored" ) ;
+  {
+    std::ifstream file( cacheFile, std::ios::binary ) ;
+    const std::string content( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() ) ;
+    std::ofstream truncated( cacheFile + ".truncated", std::ios::binary ) ;
+    truncated.write( content.data(), content.size() - 8 ) ;
+  }
+  test.check( nullptr == GeometrySnapshot::read( cacheFile + ".truncated", hash ), "truncated cache file ignored" ) ;
+  const auto read = GeometrySnapshot::read( cacheFile, hash ) ;
+  std::remove( cacheFile.c_str() ) ;
+  std::remove( ( cacheFile + ".truncated" ).c_str() ) ;
+  if( not test.check( nullptr != read, "cache file read back" ) ) {
+    return test.status() ;
+  }
+
+  // compare
+  const SurfaceTable *readSurfaces = read->surfaces( "TestTracker" ) ;
+  if( test.check( nullptr != readSurfaces, "tracker surfaces read" ) ) {
+    compareSurfaces( test, *extractedSurfaces, *readSurfaces ) ;
+  }
+  test.check( nullptr == read->surfaces( "TestCalorimeter" ), "no surfaces for the calorimeter" ) ;
+  const CalorimeterGeometry *lhsCalo = extracted.calorimeter( "TestCalorimeter" ) ;
+  const CalorimeterGeometry *rhsCalo = read->calorimeter( "TestCalorimeter" ) ;
+  if( test.check( nullptr != rhsCalo, "calorimeter read" ) ) {
+    test.check( lhsCalo->_name == rhsCalo->_name, "calorimeter name" ) ;
+    test.check( lhsCalo->_typeFlag == rhsCalo->_typeFlag, "calorimeter type flag" ) ;
+    test.check( lhsCalo->_extent == rhsCalo->_extent, "calorimeter extent" ) ;
+    test.check( lhsCalo->_innerSymmetry == rhsCalo->_innerSymmetry && lhsCalo->_outerSymmetry == rhsCalo->_outerSymmetry, "calorimeter symmetries" ) ;
+    test.check( lhsCalo->_innerPhi0 == rhsCalo->_innerPhi0 && lhsCalo->_outerPhi0 == rhsCalo->_outerPhi0, "calorimeter phi0" ) ;
+    if( test.check( lhsCalo->_layers.size() == rhsCalo->_layers.size(), "calorimeter layer count" ) ) {
+      for( std::size_t l=0 ; l<lhsCalo->_layers.size() ; ++l ) {
+        const auto &lhs = lhsCalo->_layers[l] ;
+        const auto &rhs = rhsCalo->_layers[l] ;
+        test.check( lhs._distance == rhs._distance && lhs._phi0 == rhs._phi0
+          && lhs._absorberThickness == rhs._absorberThickness && lhs._sensitiveThickness == rhs._sensitiveThickness
+          && lhs._cellSize0 == rhs._cellSize0 && lhs._cellSize1 == rhs._cellSize1, "calorimeter layer " + std::to_string( l ) ) ;
+      }
+    }
+  }
+  test.check( 1 == read->calorimeters( dd4hep::DetType::CALORIMETER | dd4hep::DetType::ENDCAP ).size(), "calorimeter selection by type" ) ;
+  test.check( read->calorimeters( dd4hep::DetType::CALORIMETER, dd4hep::DetType::ENDCAP ).empty(), "calorimeter exclusion by type" ) ;
+  const ZDiskPetalsGeometry *lhsPetals = extracted.zDiskPetals( "TestTracker" ) ;
+  const ZDiskPetalsGeometry *rhsPetals = read->zDiskPetals( "TestTracker" ) ;
+  if( test.check( nullptr != rhsPetals, "petals read" ) ) {
+    test.check( lhsPetals->_widthStrip == rhsPetals->_widthStrip && lhsPetals->_lengthStrip == rhsPetals->_lengthStrip
+      && lhsPetals->_pitchStrip == rhsPetals->_pitchStrip && lhsPetals->_angleStrip == rhsPetals->_angleStrip, "petal strips" ) ;
+    if( test.check( lhsPetals->_layers.size() == rhsPetals->_layers.size(), "petal layer count" ) ) {
+      for( std::size_t l=0 ; l<lhsPetals->_layers.size() ; ++l ) {
+        const auto &lhs = lhsPetals->_layers[l] ;
+        const auto &rhs = rhsPetals->_layers[l] ;
+        test.check( lhs._zPosition == rhs._zPosition && lhs._phi0 == rhs._phi0 && lhs._petalHalfAngle == rhs._petalHalfAngle
+          && lhs._petalNumber == rhs._petalNumber && lhs._sensorsPerPetal == rhs._sensorsPerPetal, "petal layer " + std::to_string( l ) ) ;
+      }
+    }
+  }
+  const dd4hep::rec::FixedPadSizeTPCData *lhsTPC = extracted.fixedPadSizeTPC( "TestTracker" ) ;
+  const dd4hep::rec::FixedPadSizeTPCData *rhsTPC = read->fixedPadSizeTPC( "TestTracker" ) ;
+  if( test.check( nullptr != rhsTPC, "TPC read" ) ) {
+    test.check( lhsTPC->zHalf == rhsTPC->zHalf && lhsTPC->rMin == rhsTPC->rMin && lhsTPC->rMax == rhsTPC->rMax
+      && lhsTPC->driftLength == rhsTPC->driftLength && lhsTPC->rMinReadout == rhsTPC->rMinReadout
+      && lhsTPC->rMaxReadout == rhsTPC->rMaxReadout, "TPC dimensions" ) ;
+    test.check( lhsTPC->padHeight == rhsTPC->padHeight && lhsTPC->padWidth == rhsTPC->padWidth
+      && lhsTPC->maxRow == rhsTPC->maxRow && lhsTPC->padGap == rhsTPC->padGap, "TPC pads" ) ;
+  }
+  test.check( std::fabs( extracted.magneticField() - 3.5*dd4hep::tesla ) < 1.e-9*dd4hep::tesla, "magnetic field extracted" ) ;
+  test.check( extracted.magneticField() == read->magneticField(), "magnetic field" ) ;
+  return test.status() ;
+}
@@ -0,0 +1,143 @@
+// -- marlinreco headers
+#include <MarlinRecoMT/HelixBatch.h>
+#include <MarlinRecoMT/SimpleHelix.h>
+
+// -- std headers
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+// -- unit test headers
+#include <UnitTest.h>
+
+using namespace marlinreco_mt ;
+
+namespace {
+
+  /// The number of intersections found, with the end planes for the cylinders
+  struct IntersectionCounts {
+    unsigned int nFound {0} ;
+    unsigned int nEndPlane {0} ;
+    unsigned int nFlat {0} ;
+  };
+
+  //--------------------------------------------------------------------------
+
+  /// Compare the batch intersections with the SimpleHelix ones, helix by helix:
+  /// same status, same path length, and the found points on the surface
+  template <typename Surface, typename Intersect>
+  bool sameIntersections( const std::vector<SimpleHelix> &helices, const std::vector<double> &tanLambdas,
+                          const Surface &surface, const std::vector<double> &s, const std::vector<HelixIntersectionStatus> &status,
+                          Intersect intersect, IntersectionCounts &counts, test::UnitTest &test, const std::string &id ) {
+    bool same = true ;
+    for( std::size_t i=0 ; i<helices.size() ; ++i ) {
+      double expectedS = 0. ;
+      const HelixIntersectionStatus expectedStatus = intersect( helices[i], surface, expectedS ) ;
+      if( expectedStatus != status[i] || expectedS != s[i] ) {
+        test.check( false, id + ", helix " + std::to_string( i ) + ": s = " + std::to_string( s[i] ) + " instead of " + std::to_string( expectedS ) ) ;
+        same = false ;
+        continue ;
+      }
+      if( HelixIntersectionStatus::Found != status[i] ) {
+        continue ;
+      }
+      const LCVector3D position = helices[i].getPosition( s[i] ) ;
+      if( std::fabs( surface.distance( position ) ) > 1.e-6 * ( 1. + s[i] ) ) {
+        test.check( false, id + ", helix " + std::to_string( i ) + ": intersection " + std::to_string( surface.distance( position ) ) + " mm away from the surface" ) ;
+        same = false ;
+      }
+      ++counts.nFound ;
+      counts.nFlat += ( 0. == tanLambdas[i] ) ? 1 : 0 ;
+    }
+    return same ;
+  }
+
+}
+
+int main() {
+  test::UnitTest test( "testHelixBatch" ) ;
+  std::mt19937 generator( 2468 ) ;
+  std::uniform_real_distribution<double> uniform( 0., 1. ) ;
+  auto random = [&]( double min, double max ) { return min + ( max - min ) * uniform( generator ) ; } ;
+  const double bField = 3.5 ;
+
+  // radius from 100 mm to 5 m, both charges, tanLambda = 0 included
+  const unsigned int nHelices = 2000 ;
+  HelixBatch batch( bField ) ;
+  batch.reserve( nHelices ) ;
+  std::vector<SimpleHelix> helices ;
+  std::vector<double> tanLambdas ;
+  bool sameIndices = true ;
+  for( unsigned int h=0 ; h<nHelices ; ++h ) {
+    const double omega = ( ( uniform( generator ) < 0.5 ) ? -1. : 1. ) / random( 100., 5000. ) ;
+    const double d0 = random( -1., 1. ) ;
+    const double phi0 = random( -M_PI, M_PI ) ;
+    const double z0 = random( -5., 5. ) ;
+    const double tanLambda = ( 0 == h % 10 ) ? 0. : random( -3., 3. ) ;
+    const LCVector3D reference( random( -50., 50. ), random( -50., 50. ), random( -50., 50. ) ) ;
+    sameIndices = sameIndices && h == batch.addHelix( d0, phi0, omega, z0, tanLambda, reference ) ;
+    helices.emplace_back( d0, phi0, omega, z0, tanLambda, reference ) ;
+    tanLambdas.push_back( tanLambda ) ;
+  }
+  test.check( sameIndices && nHelices == batch.size(), "helix indices and number of helices" ) ;
+
+  // positions and directions
+  std::vector<double> s( nHelices ), x( nHelices ), y( nHelices ), z( nHelices ), dx( nHelices ), dy( nHelices ), dz( nHelices ) ;
+  for( auto &length : s ) {
+    length = random( -1000., 4000. ) ;
+  }
+  batch.positionsAt( s, x, y, z ) ;
+  batch.directionsAt( s, dx, dy, dz ) ;
+  bool samePositions = true ;
+  bool sameDirections = true ;
+  for( unsigned int i=0 ; i<nHelices ; ++i ) {
+    const LCVector3D position = helices[i].getPosition( s[i] ) ;
+    const LCVector3D direction = helices[i].getDirection( s[i] ) ;
+    samePositions = samePositions && ( position - LCVector3D( x[i], y[i], z[i] ) ).r() <= 1.e-9 * ( std::fabs( s[i] ) + position.r() ) ;
+    sameDirections = sameDirections && ( direction - LCVector3D( dx[i], dy[i], dz[i] ) ).r() <= 1.e-12 ;
+  }
+  test.check( samePositions, "positions as SimpleHelix" ) ;
+  test.check( sameDirections, "directions as SimpleHelix" ) ;
+
+  // planes: perpendicular and parallel to the helix axis, and tilted
+  std::vector<HelixIntersectionStatus> status( nHelices ) ;
+  IntersectionCounts planeCounts ;
+  auto intersectPlane = []( const SimpleHelix &helix, const LCPlane3D &plane, double &length ) {
+    return helix.intersectWithPlane( plane, length ) ;
+  } ;
+  for( unsigned int p=0 ; p<30 ; ++p ) {
+    const double nx = ( 0 == p % 3 ) ? 0. : random( -1., 1. ) ;
+    const double ny = ( 0 == p % 3 ) ? 0. : random( -1., 1. ) ;
+    const double nz = ( 1 == p % 3 ) ? 0. : random( -1., 1. ) ;
+    const LCVector3D normal( nx, ny, ( 0 == p % 3 ) ? std::copysign( 1., nz ) : nz ) ;
+    const LCPlane3D plane( normal.unit(), random( -2000., 2000. ) ) ;
+    batch.intersectionsWithPlane( plane, s, status ) ;
+    test.check( sameIntersections( helices, tanLambdas, plane, s, status, intersectPlane, planeCounts, test, "plane " + std::to_string( p ) ), "plane " + std::to_string( p ) + ": intersections as SimpleHelix" ) ;
+  }
+  test.check( planeCounts.nFound > 0 && planeCounts.nFlat > 0, "planes crossed, also by the helices with tanLambda = 0" ) ;
+
+  // cylinders: closed and open along the helix axis, off axis and tilted
+  IntersectionCounts cylinderCounts ;
+  auto intersectCylinder = [&cylinderCounts]( const SimpleHelix &helix, const LCCylinder &cylinder, double &length ) {
+    const HelixIntersectionStatus result = helix.intersectWithCylinder( cylinder, length ) ;
+    if( HelixIntersectionStatus::Found == result && cylinder.endPlane() ) {
+      int code = 0 ;
+      cylinder.projectPoint( helix.getPosition( length ), code ) ;
+      cylinderCounts.nEndPlane += ( 1 == code || 2 == code ) ? 1 : 0 ;
+    }
+    return result ;
+  } ;
+  for( unsigned int c=0 ; c<30 ; ++c ) {
+    const LCVector3D centre( random( -100., 100. ), random( -100., 100. ), random( -200., 200. ) ) ;
+    const double tilt = ( 2 == c % 3 ) ? 500. : 0. ;
+    const LCVector3D axis( random( -tilt, tilt ), random( -tilt, tilt ), random( 300., 3000. ) ) ;
+    const LCCylinder cylinder( random( 200., 2000. ), centre, axis, 1 != c % 3 ) ;
+    batch.intersectionsWithCylinder( cylinder, s, status ) ;
+    test.check( sameIntersections( helices, tanLambdas, cylinder, s, status, intersectCylinder, cylinderCounts, test, "cylinder " + std::to_string( c ) ), "cylinder " + std::to_string( c ) + ": intersections as SimpleHelix" ) ;
+  }
+  test.check( cylinderCounts.nFound > 0 && cylinderCounts.nFlat > 0, "cylinders crossed, also by the helices with tanLambda = 0" ) ;
+  test.check( cylinderCounts.nEndPlane > 0 && cylinderCounts.nEndPlane < cylinderCounts.nFound, "cylinders crossed on the tube and on the end planes" ) ;
+
+  return test.status() ;
+}
@@ -0,0 +1,97 @@
+// -- marlinreco headers
+#include <MarlinRecoMT/HelixCovariance.h>
+#include <MarlinRecoMT/SimpleHelix.h>
+
+// -- std headers
+#include <array>
+#include <cmath>
+#include <random>
+#include <string>
+
+// -- unit test headers
+#include <UnitTest.h>
+
+using namespace marlinreco_mt ;
+
+namespace {
+
+  /// Transverse momentum (GeV) per unit curvature (1/mm) and magnetic field (T)
+  constexpr double momentumFactor = 2.99792458E-4 ;
+
+  /// The position and momentum at path length s, computed by SimpleHelix
+  std::array<double, 6> positionMomentum( const std::array<double, 5> &parameters, const LCVector3D &reference, double s, double bField ) {
+    const SimpleHelix helix( parameters[0], parameters[1], parameters[2], parameters[3], parameters[4], reference ) ;
+    const LCVector3D position = helix.getPosition( s ) ;
+    // the direction is a unit vector, |p| = pT / cosLambda
+    const double p = momentumFactor * bField / std::fabs( parameters[2] ) * std::sqrt( 1. + parameters[4]*parameters[4] ) ;
+    const LCVector3D momentum = p * helix.getDirection( s ) ;
+    return {{ position.x(), position.y(), position.z(), momentum.x(), momentum.y(), momentum.z() }} ;
+  }
+
+}
+
+int main() {
+  test::UnitTest test( "testHelixCovariance" ) ;
+  std::mt19937 generator( 12345 ) ;
+  std::uniform_real_distribution<double> uniform( 0., 1. ) ;
+  const double bField = 3.5 ;
+
+  for( unsigned int h=0 ; h<200 ; ++h ) {
+    // radius from 100 mm to 5 m, both charges, tanLambda = 0 included
+    const double radius = 100. + 4900. * uniform( generator ) ;
+    const double omega = ( ( uniform( generator ) < 0.5 ) ? -1. : 1. ) / radius ;
+    const double d0 = 2. * ( uniform( generator ) - 0.5 ) ;
+    const double phi0 = 2. * M_PI * ( uniform( generator ) - 0.5 ) ;
+    const double z0 = 10. * ( uniform( generator ) - 0.5 ) ;
+    const double tanLambda = ( 0 == h % 10 ) ? 0. : 6. * ( uniform( generator ) - 0.5 ) ;
+    const LCVector3D reference( 100. * ( uniform( generator ) - 0.5 ), 100. * ( uniform( generator ) - 0.5 ), 100. * ( uniform( generator ) - 0.5 ) ) ;
+    const double s = 3000. * ( uniform( generator ) - 0.3 ) ;
+    const std::array<double, 5> parameters {{ d0, phi0, omega, z0, tanLambda }} ;
+    const HelixJacobian jacobian = helixJacobian( d0, phi0, omega, tanLambda, s, bField ) ;
+
+    // central differences, steps relative to the parameter scales
+    const std::array<double, 5> steps {{ 1.e-4, 1.e-6, 1.e-6 * std::fabs( omega ), 1.e-4, 1.e-6 }} ;
+    bool matching = true ;
+    for( unsigned int j=0 ; j<5 ; ++j ) {
+      auto plus = parameters ;
+      auto minus = parameters ;
+      plus[j] += steps[j] ;
+      minus[j] -= steps[j] ;
+      const auto valuesPlus = positionMomentum( plus, reference, s, bField ) ;
+      const auto valuesMinus = positionMomentum( minus, reference, s, bField ) ;
+      for( unsigned int i=0 ; i<6 ; ++i ) {
+        const double numerical = ( valuesPlus[i] - valuesMinus[i] ) / ( 2. * steps[j] ) ;
+        // the truncation and rounding errors of the differences, in units of the output
+        const double scale = ( i < 3 ) ? std::fabs( s ) + radius : momentumFactor * bField * radius * ( 1. + std::fabs( tanLambda ) ) ;
+        const double tolerance = 1.e-5 * scale * ( ( 2 == j ) ? radius : 1. ) + 1.e-6 ;
+        if( std::fabs( jacobian( i, j ) - numerical ) > tolerance ) {
+          matching = false ;
+          test.check( false, "helix " + std::to_string( h ) + ": d(" + std::to_string( i ) + ")/d(" + std::to_string( j ) + ") analytic "
+            + std::to_string( jacobian( i, j ) ) + " numerical " + std::to_string( numerical ) ) ;
+        }
+      }
+    }
+    test.check( matching, "helix " + std::to_string( h ) + ": analytic Jacobian matches the numerical derivatives" ) ;
+
+    // the position covariance is the position block of the full covariance
+    LCErrorMatrix<5> errors ;
+    for( unsigned int i=0 ; i<5 ; ++i ) {
+      errors( i, i ) = ( 1. + uniform( generator ) ) * steps[i] * steps[i] * 1.e6 ;
+      for( unsigned int j=0 ; j<i ; ++j ) {
+        errors( i, j ) = 0.1 * ( uniform( generator ) - 0.5 ) * steps[i] * steps[j] * 1.e6 ;
+      }
+    }
+    const SimpleHelix helix( d0, phi0, omega, z0, tanLambda, reference, &errors, bField ) ;
+    LCErrorMatrix<3> positionErrors ;
+    helix.getPosition( s, &positionErrors ) ;
+    const LCErrorMatrix<6> fullErrors = helix.getCovarianceMatrix( s ) ;
+    bool sameBlock = true ;
+    for( unsigned int i=0 ; i<3 ; ++i ) {
+      for( unsigned int j=0 ; j<3 ; ++j ) {
+        sameBlock = sameBlock && std::fabs( positionErrors( i, j ) - fullErrors( i, j ) ) <= 1.e-12 * ( std::fabs( fullErrors( i, j ) ) + 1. ) ;
+      }
+    }
+    test.check( sameBlock, "helix " + std::to_string( h ) + ": position covariance is the position block of the full covariance" ) ;
+  }
+  return test.status() ;
+}